@@ -0,0 +1,823 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Convert binary to base64 and vice versa.
+ *
+ * These functions encode binary data in base64 and decode base64 strings
+ * back to binary as defined in RFC 4648. Two alphabets are supported:
+ *
+ * \li base64 -- the standard alphabet using '+' and '/' with '='
+ *     padding;
+ * \li base64url -- the URL and filename safe alphabet using '-' and '_'
+ *     without padding.
+ *
+ * The decoders accept input with or without padding. Any other character
+ * (including spaces and new lines) is an error. The unused bits of the
+ * last character must be zero so each binary buffer has exactly one
+ * valid encoding (i.e. "QR==" is an error, "QQ==" is the canonical
+ * encoding of "A").
+ *
+ * The API mirrors the one of hexadecimal_string.h: std::string and
+ * std::span versions which return a new string and versions which write
+ * to a caller buffer. The exact size of the output can be computed ahead
+ * of time with base64_encoded_size() and base64_decoded_size(). For very
+ * large inputs, the base64_encoder and base64_decoder classes convert
+ * the data one chunk at a time.
+ *
+ * When SSSE3 is available, 12 bytes are encoded at a time. When SSE2 is
+ * available, 16 characters are decoded at a time. The scalar versions
+ * are table driven.
+ */
+
+// libexcept
+//
+#include    "libexcept/exception.h"
+
+
+// C++
+//
+#include    <array>
+#include    <cstdint>
+#include    <cstring>
+#include    <span>
+#include    <string>
+#include    <string_view>
+
+
+// C
+//
+#if defined(__SSE2__)
+#include    <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include    <tmmintrin.h>
+#endif
+
+
+
+namespace snapdev
+{
+
+
+
+DECLARE_MAIN_EXCEPTION(base64_exception);
+
+DECLARE_EXCEPTION(base64_exception, base64_invalid_parameter);
+
+
+
+namespace detail
+{
+
+
+/** \brief Define one base64 alphabet.
+ *
+ * The alphabets only differ by the last two digits and whether the
+ * encoder adds padding.
+ */
+struct base64_alphabet
+{
+    char const                      f_digits[65];
+    bool const                      f_padding;
+};
+
+
+inline constexpr base64_alphabet const g_base64_standard =
+{
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+    true,
+};
+
+
+inline constexpr base64_alphabet const g_base64_url =
+{
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+    false,
+};
+
+
+/** \brief Create the table used to decode a base64 alphabet.
+ *
+ * Characters which are not part of the alphabet are set to 0xFF.
+ *
+ * \param[in] alphabet  The alphabet to convert.
+ *
+ * \return The table of values, one per character.
+ */
+constexpr std::array<std::uint8_t, 256> base64_values(base64_alphabet const & alphabet)
+{
+    std::array<std::uint8_t, 256> values{};
+    for(int c(0); c < 256; ++c)
+    {
+        values[c] = 0xFF;
+    }
+    for(int idx(0); idx < 64; ++idx)
+    {
+        values[static_cast<std::uint8_t>(alphabet.f_digits[idx])] = idx;
+    }
+    return values;
+}
+
+
+inline constexpr std::array<std::uint8_t, 256> const g_base64_standard_values = base64_values(g_base64_standard);
+inline constexpr std::array<std::uint8_t, 256> const g_base64_url_values = base64_values(g_base64_url);
+
+
+/** \brief Generate the exception for an invalid character.
+ *
+ * \param[in] c  The invalid character.
+ */
+[[noreturn]] inline void base64_invalid_character(char c)
+{
+    if(static_cast<std::uint8_t>(c) >= 0x20
+    && static_cast<std::uint8_t>(c) < 0x7F)
+    {
+        throw base64_invalid_parameter(
+                  std::string("input character '")
+                + c
+                + "' is not a base64 digit.");
+    }
+    throw base64_invalid_parameter("input character is not a base64 digit.");
+}
+
+
+/** \brief Encode \p size bytes from \p in to \p out.
+ *
+ * The function writes exactly base64_encoded_size() characters.
+ *
+ * \param[in] in  The input bytes.
+ * \param[in] size  The number of input bytes.
+ * \param[out] out  The output buffer.
+ * \param[in] alphabet  The alphabet to use.
+ *
+ * \return A pointer just after the last character written.
+ */
+inline char * base64_encode(
+      std::uint8_t const * in
+    , std::size_t size
+    , char * out
+    , base64_alphabet const & alphabet)
+{
+    char const * digits(alphabet.f_digits);
+
+#if defined(__SSSE3__)
+    // gather 4 x 3 bytes in 4 x 32 bit lanes, split each lane in 4
+    // indexes of 6 bits, and convert the indexes to ASCII by adding an
+    // offset selected by range
+    //
+    // the load reads 16 bytes, only the first 12 are used
+    //
+    __m128i const gather(_mm_setr_epi8(
+              2, 1, 0, -1
+            , 5, 4, 3, -1
+            , 8, 7, 6, -1
+            , 11, 10, 9, -1));
+    __m128i const mask(_mm_set1_epi32(0x3F));
+    for(; size >= 16; size -= 12, in += 12, out += 16)
+    {
+        __m128i const lanes(_mm_shuffle_epi8(
+                  _mm_loadu_si128(reinterpret_cast<__m128i const *>(in))
+                , gather));
+        __m128i const indexes(_mm_or_si128(
+                  _mm_or_si128(
+                          _mm_and_si128(_mm_srli_epi32(lanes, 18), mask)
+                        , _mm_and_si128(_mm_srli_epi32(lanes, 4), _mm_slli_epi32(mask, 8)))
+                , _mm_or_si128(
+                          _mm_and_si128(_mm_slli_epi32(lanes, 10), _mm_slli_epi32(mask, 16))
+                        , _mm_and_si128(_mm_slli_epi32(lanes, 24), _mm_slli_epi32(mask, 24)))));
+
+        __m128i offset(_mm_set1_epi8('A'));
+        offset = _mm_add_epi8(offset, _mm_and_si128(
+                      _mm_cmpgt_epi8(indexes, _mm_set1_epi8(25))
+                    , _mm_set1_epi8('a' - 26 - 'A')));
+        offset = _mm_add_epi8(offset, _mm_and_si128(
+                      _mm_cmpgt_epi8(indexes, _mm_set1_epi8(51))
+                    , _mm_set1_epi8(('0' - 52) - ('a' - 26))));
+        offset = _mm_add_epi8(offset, _mm_and_si128(
+                      _mm_cmpgt_epi8(indexes, _mm_set1_epi8(61))
+                    , _mm_set1_epi8(static_cast<char>((digits[62] - 62) - ('0' - 52)))));
+        offset = _mm_add_epi8(offset, _mm_and_si128(
+                      _mm_cmpgt_epi8(indexes, _mm_set1_epi8(62))
+                    , _mm_set1_epi8(static_cast<char>((digits[63] - 63) - (digits[62] - 62)))));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_add_epi8(indexes, offset));
+    }
+#endif
+
+    for(; size >= 3; size -= 3, in += 3, out += 4)
+    {
+        std::uint32_t const v((in[0] << 16) | (in[1] << 8) | in[2]);
+        out[0] = digits[v >> 18];
+        out[1] = digits[(v >> 12) & 0x3F];
+        out[2] = digits[(v >> 6) & 0x3F];
+        out[3] = digits[v & 0x3F];
+    }
+
+    if(size == 1)
+    {
+        out[0] = digits[in[0] >> 2];
+        out[1] = digits[(in[0] & 0x03) << 4];
+        out += 2;
+        if(alphabet.f_padding)
+        {
+            out[0] = '=';
+            out[1] = '=';
+            out += 2;
+        }
+    }
+    else if(size == 2)
+    {
+        out[0] = digits[in[0] >> 2];
+        out[1] = digits[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+        out[2] = digits[(in[1] & 0x0F) << 2];
+        out += 3;
+        if(alphabet.f_padding)
+        {
+            *out = '=';
+            ++out;
+        }
+    }
+
+    return out;
+}
+
+
+#if defined(__SSE2__)
+/** \brief Check whether each byte is within [lo, hi].
+ *
+ * Bytes 0x80 and more are viewed as negative and never match since
+ * \p lo and \p hi are ASCII characters.
+ */
+inline __m128i base64_in_range(__m128i v, char lo, char hi)
+{
+    return _mm_and_si128(
+              _mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1))
+            , _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+#endif
+
+
+/** \brief Decode a base64 string to \p out.
+ *
+ * The function writes exactly base64_decoded_size() bytes.
+ *
+ * \exception base64_invalid_parameter
+ * The input includes an invalid character, misplaced padding, or its
+ * length is not valid.
+ *
+ * \param[in] base64  The input characters.
+ * \param[out] out  The output buffer.
+ * \param[in] alphabet  The alphabet to use.
+ * \param[in] values  The decoding table of that alphabet.
+ *
+ * \return A pointer just after the last byte written.
+ */
+inline std::uint8_t * base64_decode(
+      std::string_view const & base64
+    , std::uint8_t * out
+    , base64_alphabet const & alphabet
+    , std::array<std::uint8_t, 256> const & values)
+{
+    char const * in(base64.data());
+    std::size_t size(base64.length());
+
+    // remove padding
+    //
+    if((size & 3) == 0 && size >= 4)
+    {
+        if(in[size - 1] == '=')
+        {
+            --size;
+            if(in[size - 1] == '=')
+            {
+                --size;
+            }
+        }
+    }
+    if((size & 3) == 1)
+    {
+        throw base64_invalid_parameter("the base64 parameter does not have a valid length.");
+    }
+
+#if defined(__SSE2__)
+    char const c62(alphabet.f_digits[62]);
+    char const c63(alphabet.f_digits[63]);
+    for(; size >= 16; size -= 16, in += 16, out += 12)
+    {
+        __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(in)));
+        __m128i const is_upper(base64_in_range(v, 'A', 'Z'));
+        __m128i const is_lower(base64_in_range(v, 'a', 'z'));
+        __m128i const is_digit(base64_in_range(v, '0', '9'));
+        __m128i const is_62(_mm_cmpeq_epi8(v, _mm_set1_epi8(c62)));
+        __m128i const is_63(_mm_cmpeq_epi8(v, _mm_set1_epi8(c63)));
+        __m128i const valid(_mm_or_si128(
+                  _mm_or_si128(is_upper, is_lower)
+                , _mm_or_si128(is_digit, _mm_or_si128(is_62, is_63))));
+        if(_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            // let the scalar loop find the invalid character
+            //
+            break;
+        }
+        __m128i const offset(_mm_or_si128(
+                  _mm_or_si128(
+                          _mm_and_si128(is_upper, _mm_set1_epi8(-'A'))
+                        , _mm_and_si128(is_lower, _mm_set1_epi8(26 - 'a')))
+                , _mm_or_si128(
+                          _mm_and_si128(is_digit, _mm_set1_epi8(52 - '0'))
+                        , _mm_or_si128(
+                                  _mm_and_si128(is_62, _mm_set1_epi8(static_cast<char>(62 - c62)))
+                                , _mm_and_si128(is_63, _mm_set1_epi8(static_cast<char>(63 - c63)))))));
+        __m128i const sextets(_mm_add_epi8(v, offset));
+
+        // each 16 bit lane becomes (a << 6) | b, then each 32 bit lane
+        // becomes (ab << 12) | cd, which is the 24 bits of output
+        //
+        __m128i const pairs(_mm_or_si128(
+                  _mm_slli_epi16(_mm_and_si128(sextets, _mm_set1_epi16(0x00FF)), 6)
+                , _mm_srli_epi16(sextets, 8)));
+        __m128i const triplets(_mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000)));
+
+        std::uint32_t t[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(t), triplets);
+        for(int idx(0); idx < 4; ++idx)
+        {
+            out[idx * 3 + 0] = t[idx] >> 16;
+            out[idx * 3 + 1] = t[idx] >> 8;
+            out[idx * 3 + 2] = t[idx];
+        }
+    }
+#else
+    static_cast<void>(alphabet);
+#endif
+
+    auto value = [&values](char c)
+    {
+        std::uint8_t const v(values[static_cast<std::uint8_t>(c)]);
+        if(v == 0xFF)
+        {
+            base64_invalid_character(c);
+        }
+        return v;
+    };
+
+    for(; size >= 4; size -= 4, in += 4, out += 3)
+    {
+        std::uint32_t const v(
+                  (value(in[0]) << 18)
+                | (value(in[1]) << 12)
+                | (value(in[2]) << 6)
+                | value(in[3]));
+        out[0] = v >> 16;
+        out[1] = v >> 8;
+        out[2] = v;
+    }
+
+    if(size >= 2)
+    {
+        std::uint32_t v((value(in[0]) << 18) | (value(in[1]) << 12));
+        if(size == 3)
+        {
+            v |= value(in[2]) << 6;
+        }
+        if((v & (size == 2 ? 0x00FFFF : 0x0000FF)) != 0)
+        {
+            throw base64_invalid_parameter("the last base64 digit has unused bits which are not zero.");
+        }
+        out[0] = v >> 16;
+        ++out;
+        if(size == 3)
+        {
+            out[0] = v >> 8;
+            ++out;
+        }
+    }
+
+    return out;
+}
+
+
+} // namespace detail
+
+
+
+/** \brief Compute the exact size of a base64 encoded buffer.
+ *
+ * \param[in] size  The number of bytes to encode.
+ * \param[in] padding  Whether the output includes '=' padding (base64)
+ * or not (base64url).
+ *
+ * \return The number of characters the encoder outputs.
+ */
+constexpr std::size_t base64_encoded_size(std::size_t size, bool padding = true)
+{
+    return padding
+        ? (size + 2) / 3 * 4
+        : size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1);
+}
+
+
+/** \brief Compute the exact size of a decoded base64 string.
+ *
+ * This function takes the padding in account, if present. It does not
+ * verify the characters.
+ *
+ * \exception base64_invalid_parameter
+ * The length of the input is not valid (i.e. `4n + 1` characters without
+ * padding).
+ *
+ * \param[in] base64  The base64 string.
+ *
+ * \return The number of bytes the decoder outputs.
+ */
+inline std::size_t base64_decoded_size(std::string_view const & base64)
+{
+    std::size_t size(base64.length());
+    if((size & 3) == 0 && size >= 4)
+    {
+        if(base64[size - 1] == '=')
+        {
+            --size;
+            if(base64[size - 1] == '=')
+            {
+                --size;
+            }
+        }
+    }
+    if((size & 3) == 1)
+    {
+        throw base64_invalid_parameter("the base64 parameter does not have a valid length.");
+    }
+    return size / 4 * 3 + (size % 4 == 0 ? 0 : size % 4 - 1);
+}
+
+
+/** \brief Encode binary data in base64 to a caller buffer.
+ *
+ * The output buffer must be at least `base64_encoded_size(binary.size())`
+ * characters. No '\0' is added.
+ *
+ * \param[in] binary  The bytes to encode.
+ * \param[out] out  The output buffer.
+ *
+ * \return A pointer just after the last character written.
+ */
+inline char * base64_encode(std::span<std::uint8_t const> binary, char * out)
+{
+    return detail::base64_encode(binary.data(), binary.size(), out, detail::g_base64_standard);
+}
+
+
+/** \brief Encode binary data in base64.
+ *
+ * \param[in] binary  The bytes to encode.
+ *
+ * \return The base64 string, with padding.
+ */
+inline std::string base64_encode(std::span<std::uint8_t const> binary)
+{
+    std::string result(base64_encoded_size(binary.size()), '\0');
+    base64_encode(binary, result.data());
+    return result;
+}
+
+
+/** \brief Encode a binary string in base64.
+ *
+ * \param[in] binary  The binary string to encode.
+ *
+ * \return The base64 string, with padding.
+ */
+inline std::string base64_encode(std::string const & binary)
+{
+    return base64_encode(std::span<std::uint8_t const>(
+                  reinterpret_cast<std::uint8_t const *>(binary.data())
+                , binary.length()));
+}
+
+
+/** \brief Encode binary data in base64url to a caller buffer.
+ *
+ * The output buffer must be at least
+ * `base64_encoded_size(binary.size(), false)` characters. No '\0' is
+ * added.
+ *
+ * \param[in] binary  The bytes to encode.
+ * \param[out] out  The output buffer.
+ *
+ * \return A pointer just after the last character written.
+ */
+inline char * base64url_encode(std::span<std::uint8_t const> binary, char * out)
+{
+    return detail::base64_encode(binary.data(), binary.size(), out, detail::g_base64_url);
+}
+
+
+/** \brief Encode binary data in base64url.
+ *
+ * \param[in] binary  The bytes to encode.
+ *
+ * \return The base64url string, without padding.
+ */
+inline std::string base64url_encode(std::span<std::uint8_t const> binary)
+{
+    std::string result(base64_encoded_size(binary.size(), false), '\0');
+    base64url_encode(binary, result.data());
+    return result;
+}
+
+
+/** \brief Encode a binary string in base64url.
+ *
+ * \param[in] binary  The binary string to encode.
+ *
+ * \return The base64url string, without padding.
+ */
+inline std::string base64url_encode(std::string const & binary)
+{
+    return base64url_encode(std::span<std::uint8_t const>(
+                  reinterpret_cast<std::uint8_t const *>(binary.data())
+                , binary.length()));
+}
+
+
+/** \brief Decode a base64 string to a caller buffer.
+ *
+ * The output buffer must be at least `base64_decoded_size(base64)` bytes.
+ *
+ * \exception base64_invalid_parameter
+ * The input is not valid base64.
+ *
+ * \param[in] base64  The base64 string, with or without padding.
+ * \param[out] out  The output buffer.
+ *
+ * \return A pointer just after the last byte written.
+ */
+inline std::uint8_t * base64_decode(std::string_view const & base64, std::uint8_t * out)
+{
+    return detail::base64_decode(base64, out, detail::g_base64_standard, detail::g_base64_standard_values);
+}
+
+
+/** \brief Decode a base64 string.
+ *
+ * \exception base64_invalid_parameter
+ * The input is not valid base64.
+ *
+ * \param[in] base64  The base64 string, with or without padding.
+ *
+ * \return The decoded binary string.
+ */
+inline std::string base64_decode(std::string_view const & base64)
+{
+    std::string result(base64_decoded_size(base64), '\0');
+    base64_decode(base64, reinterpret_cast<std::uint8_t *>(result.data()));
+    return result;
+}
+
+
+/** \brief Decode a base64url string to a caller buffer.
+ *
+ * The output buffer must be at least `base64_decoded_size(base64)` bytes.
+ *
+ * \exception base64_invalid_parameter
+ * The input is not valid base64url.
+ *
+ * \param[in] base64  The base64url string, with or without padding.
+ * \param[out] out  The output buffer.
+ *
+ * \return A pointer just after the last byte written.
+ */
+inline std::uint8_t * base64url_decode(std::string_view const & base64, std::uint8_t * out)
+{
+    return detail::base64_decode(base64, out, detail::g_base64_url, detail::g_base64_url_values);
+}
+
+
+/** \brief Decode a base64url string.
+ *
+ * \exception base64_invalid_parameter
+ * The input is not valid base64url.
+ *
+ * \param[in] base64  The base64url string, with or without padding.
+ *
+ * \return The decoded binary string.
+ */
+inline std::string base64url_decode(std::string_view const & base64)
+{
+    std::string result(base64_decoded_size(base64), '\0');
+    base64url_decode(base64, reinterpret_cast<std::uint8_t *>(result.data()));
+    return result;
+}
+
+
+/** \brief Encode a large input one chunk at a time.
+ *
+ * This class keeps the 0 to 2 bytes which do not make a complete group
+ * of 3 bytes between calls so the chunks can be of any size. The
+ * result is the same as encoding the whole input at once.
+ *
+ * \code
+ *     snapdev::base64_encoder encoder;
+ *     std::string out;
+ *     while(read_chunk(buf))
+ *     {
+ *         encoder.encode(buf, out);
+ *         write(fd, out.data(), out.length());
+ *         out.clear();
+ *     }
+ *     encoder.finish(out);
+ *     write(fd, out.data(), out.length());
+ * \endcode
+ */
+class base64_encoder
+{
+public:
+    /** \brief Initialize the encoder.
+     *
+     * \param[in] url  Use the base64url alphabet (no padding) if true.
+     */
+    base64_encoder(bool url = false)
+        : f_alphabet(url ? &detail::g_base64_url : &detail::g_base64_standard)
+    {
+    }
+
+    /** \brief Encode one chunk of data.
+     *
+     * The base64 characters are appended to \p out.
+     *
+     * \param[in] binary  The next chunk of bytes.
+     * \param[in,out] out  The string receiving the characters.
+     */
+    void encode(std::span<std::uint8_t const> binary, std::string & out)
+    {
+        std::uint8_t const * in(binary.data());
+        std::size_t size(binary.size());
+        if(f_pending_size > 0)
+        {
+            while(f_pending_size < 3 && size > 0)
+            {
+                f_pending[f_pending_size] = *in;
+                ++f_pending_size;
+                ++in;
+                --size;
+            }
+            if(f_pending_size < 3)
+            {
+                return;
+            }
+            append(f_pending, 3, out);
+            f_pending_size = 0;
+        }
+        std::size_t const complete(size / 3 * 3);
+        append(in, complete, out);
+        f_pending_size = size - complete;
+        std::memcpy(f_pending, in + complete, f_pending_size);
+    }
+
+    /** \brief Encode the last bytes.
+     *
+     * This function encodes the remaining bytes and adds the padding
+     * if required. The encoder can then be reused for another input.
+     *
+     * \param[in,out] out  The string receiving the characters.
+     */
+    void finish(std::string & out)
+    {
+        append(f_pending, f_pending_size, out);
+        f_pending_size = 0;
+    }
+
+private:
+    void append(std::uint8_t const * in, std::size_t size, std::string & out)
+    {
+        std::size_t const pos(out.length());
+        out.resize(pos + base64_encoded_size(size, f_alphabet->f_padding));
+        detail::base64_encode(in, size, out.data() + pos, *f_alphabet);
+    }
+
+    detail::base64_alphabet const * f_alphabet = nullptr;
+    std::uint8_t                    f_pending[3] = {};
+    std::size_t                     f_pending_size = 0;
+};
+
+
+/** \brief Decode a large input one chunk at a time.
+ *
+ * This class keeps the 0 to 3 characters which do not make a complete
+ * group of 4 characters between calls so the chunks can be of any size.
+ * The padding, if any, must appear in the last chunk.
+ */
+class base64_decoder
+{
+public:
+    /** \brief Initialize the decoder.
+     *
+     * \param[in] url  Use the base64url alphabet if true.
+     */
+    base64_decoder(bool url = false)
+        : f_url(url)
+    {
+    }
+
+    /** \brief Decode one chunk of characters.
+     *
+     * The decoded bytes are appended to \p out.
+     *
+     * \exception base64_invalid_parameter
+     * The input is not valid base64.
+     *
+     * \param[in] base64  The next chunk of characters.
+     * \param[in,out] out  The string receiving the bytes.
+     */
+    void decode(std::string_view base64, std::string & out)
+    {
+        if(f_pending.length() > 0)
+        {
+            std::size_t const missing(std::min<std::size_t>(4 - f_pending.length(), base64.length()));
+            f_pending.append(base64.data(), missing);
+            base64.remove_prefix(missing);
+            if(f_pending.length() < 4)
+            {
+                return;
+            }
+            if(base64.empty())
+            {
+                // this may be the last group which can include padding
+                //
+                return;
+            }
+            append(f_pending, out, false);
+            f_pending.clear();
+        }
+
+        // always keep the last group since it may include padding
+        //
+        std::size_t const complete(base64.length() == 0 ? 0 : (base64.length() - 1) / 4 * 4);
+        append(base64.substr(0, complete), out, false);
+        f_pending = base64.substr(complete);
+    }
+
+    /** \brief Decode the last characters.
+     *
+     * The decoder can then be reused for another input.
+     *
+     * \exception base64_invalid_parameter
+     * The input is not valid base64.
+     *
+     * \param[in,out] out  The string receiving the bytes.
+     */
+    void finish(std::string & out)
+    {
+        std::string const last(std::move(f_pending));
+        f_pending.clear();
+        append(last, out, true);
+    }
+
+private:
+    void append(std::string_view const & base64, std::string & out, bool last)
+    {
+        if(!last
+        && !base64.empty()
+        && base64.back() == '=')
+        {
+            throw base64_invalid_parameter("found base64 padding before the end of the input.");
+        }
+
+        std::size_t const pos(out.length());
+        out.resize(pos + base64_decoded_size(base64));
+        std::uint8_t * ptr(reinterpret_cast<std::uint8_t *>(out.data() + pos));
+        if(f_url)
+        {
+            base64url_decode(base64, ptr);
+        }
+        else
+        {
+            base64_decode(base64, ptr);
+        }
+    }
+
+    std::string                     f_pending = std::string();
+    bool                            f_url = false;
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
@@ -27,27 +27,383 @@
  *
  * This implementation allows you to generate an event and safely add or
  * remove listeners from the list while the event is being processed.
+ *
+ * The callbacks are saved in an immutable vector shared between the
+ * manager and the call() functions currently running. Adding or removing
+ * a callback creates a new vector (copy-on-write) so a call() only needs
+ * to increment a reference counter and walk contiguous memory.
+ *
+ * The concurrent_callback_manager variant can be used by many threads
+ * at once. The functions modifying the list of callbacks are serialized
+ * with a mutex and atomically replace the vector, like a read-copy-update.
+ * A call() does not lock anything nor modify a reference counter: it
+ * records the current epoch in a per-thread record, loads a plain
+ * pointer to the vector, and walks it. A replaced vector is freed as
+ * soon as no call() which started before the replacement is still
+ * running, so removed callbacks get destroyed promptly.
+ *
+ * The call_async() functions run the callbacks on a callback_dispatcher
+ * worker thread instead of the emitting thread and return a future to
+ * the combined result.
+ *
+ * To find out which callback makes an event slow, turn on the profiling
+ * of a manager with set_profiling(). Each call then records the number
+ * of invocations, the total and maximum durations, and the number of
+ * times the callback returned false. Use get_statistics() to retrieve
+ * those numbers.
  */
 
 // self
 //
 #include    <snapdev/is_smart_pointer.h>
 #include    <snapdev/has_member_function.h>
+#include    <snapdev/timespec_ex.h>
 
 
 // C++
 //
 #include    <algorithm>
+#include    <any>
+#include    <atomic>
+#include    <condition_variable>
 #include    <cstdint>
+#include    <deque>
 #include    <functional>
+#include    <future>
 #include    <iostream>
+#include    <iterator>
+#include    <limits>
 #include    <list>
+#include    <memory>
+#include    <mutex>
+#include    <thread>
+#include    <tuple>
+#include    <vector>
 
 
 
 namespace snapdev
 {
 
+
+namespace detail
+{
+
+
+/** \brief Check whether the first type is a member function pointer.
+ *
+ * \tparam ARGS  The list of types to check.
+ */
+template<typename ... ARGS>
+struct first_is_member_function_pointer
+    : std::false_type
+{
+};
+
+template<typename F, typename ... ARGS>
+struct first_is_member_function_pointer<F, ARGS...>
+    : std::is_member_function_pointer<std::decay_t<F>>
+{
+};
+
+
+/** \brief Reclaim the vectors replaced in concurrent callback managers.
+ *
+ * The call() functions of a concurrent_callback_manager walk the vector
+ * of callbacks through a plain pointer. A vector replaced by a writer
+ * can't be freed while a call() may still be walking it, so it gets
+ * retired here instead.
+ *
+ * This is an epoch based reclamation. Each thread registers one reader
+ * record. On entry, a call() saves the current global epoch in the
+ * record of its thread; on exit, it clears it. These writes only touch
+ * the record of the thread, so they do not bounce a cache line between
+ * threads. A writer retires the old vector tagged with the epoch at the
+ * time it was replaced and increments the global epoch. A retired vector
+ * gets freed once no reader entered at or before that epoch is still
+ * running. This happens immediately in the writer when no call() is
+ * running, otherwise when the last reader concerned leaves.
+ *
+ * All the concurrent managers share the same instance, so a nested
+ * call() on another manager keeps the epoch of the outermost call().
+ */
+class snapshot_epochs
+{
+public:
+    static snapshot_epochs & instance()
+    {
+        static snapshot_epochs epochs;
+        return epochs;
+    }
+
+    /** \brief Mark the calling thread as using a vector.
+     *
+     * Calls can be nested; only the outermost call saves the epoch.
+     */
+    void enter()
+    {
+        reader_t & reader(local_reader());
+        if(reader.f_depth++ == 0)
+        {
+            reader.f_epoch.store(f_epoch.load());
+        }
+    }
+
+    /** \brief Mark the calling thread as done with its vectors.
+     *
+     * When the outermost call returns and vectors are waiting to be
+     * freed, the function tries to free them.
+     */
+    void leave()
+    {
+        reader_t & reader(local_reader());
+        if(--reader.f_depth == 0)
+        {
+            reader.f_epoch.store(0, std::memory_order_release);
+            if(f_retired_count.load(std::memory_order_relaxed) != 0)
+            {
+                reclaim();
+            }
+        }
+    }
+
+    /** \brief Retire a vector which was replaced.
+     *
+     * The vector must already be unreachable by new readers.
+     *
+     * \param[in] vector  The vector to free once no reader uses it.
+     */
+    void retire(std::shared_ptr<void const> vector)
+    {
+        if(vector == nullptr)
+        {
+            return;
+        }
+        std::uint64_t const epoch(f_epoch.fetch_add(1));
+        {
+            std::lock_guard lock(f_mutex);
+            f_retired.push_back({ epoch, std::move(vector) });
+            f_retired_count.store(f_retired.size(), std::memory_order_relaxed);
+        }
+        reclaim();
+    }
+
+    /** \brief Free the retired vectors which are not in use anymore.
+     *
+     * The vectors are released after the mutex is unlocked since the
+     * destructors of the callbacks may call a manager.
+     */
+    void reclaim()
+    {
+        std::vector<retired_t> freed;
+        {
+            std::lock_guard lock(f_mutex);
+            std::uint64_t oldest(std::numeric_limits<std::uint64_t>::max());
+            for(auto const * r : f_readers)
+            {
+                std::uint64_t const e(r->f_epoch.load());
+                if(e != 0 && e < oldest)
+                {
+                    oldest = e;
+                }
+            }
+            auto const keep(std::stable_partition(
+                  f_retired.begin()
+                , f_retired.end()
+                , [oldest](retired_t const & v)
+                  {
+                      return v.f_epoch >= oldest;
+                  }));
+            std::move(keep, f_retired.end(), std::back_inserter(freed));
+            f_retired.erase(keep, f_retired.end());
+            f_retired_count.store(f_retired.size(), std::memory_order_relaxed);
+        }
+    }
+
+private:
+    /** \brief The record of one thread.
+     *
+     * The record is aligned on a cache line so the writes of a thread
+     * do not interfere with the records of other threads.
+     */
+    struct alignas(64) reader_t
+    {
+        std::atomic<std::uint64_t>      f_epoch = 0;
+        std::size_t                     f_depth = 0;
+    };
+
+    struct retired_t
+    {
+        std::uint64_t                   f_epoch = 0;
+        std::shared_ptr<void const>     f_vector = std::shared_ptr<void const>();
+    };
+
+    /** \brief Register the reader of a thread for its lifetime.
+     */
+    struct registration_t
+    {
+        registration_t(snapshot_epochs & epochs)
+            : f_epochs(epochs)
+        {
+            std::lock_guard lock(f_epochs.f_mutex);
+            f_epochs.f_readers.push_back(&f_reader);
+        }
+
+        registration_t(registration_t const &) = delete;
+
+        ~registration_t()
+        {
+            std::lock_guard lock(f_epochs.f_mutex);
+            f_epochs.f_readers.erase(std::find(f_epochs.f_readers.begin(), f_epochs.f_readers.end(), &f_reader));
+        }
+
+        registration_t & operator = (registration_t const &) = delete;
+
+        snapshot_epochs &               f_epochs;
+        reader_t                        f_reader = reader_t();
+    };
+
+    snapshot_epochs() = default;
+
+    reader_t & local_reader()
+    {
+        static thread_local registration_t registration(*this);
+        return registration.f_reader;
+    }
+
+    std::mutex                          f_mutex = std::mutex();
+    std::atomic<std::uint64_t>          f_epoch = 1;
+    std::vector<reader_t *>             f_readers = std::vector<reader_t *>();
+    std::vector<retired_t>              f_retired = std::vector<retired_t>();
+    std::atomic<std::size_t>            f_retired_count = 0;
+};
+
+
+} // namespace detail
+
+
+
+/** \brief A pool of worker threads running callbacks.
+ *
+ * The callback_manager::call_async() functions post their invocations
+ * to a dispatcher. The tasks are started in the order they are posted.
+ * With a single thread (the default), they also complete in that order.
+ * With more threads, the tasks run in parallel.
+ *
+ * A dispatcher can be shared by any number of callback managers. On
+ * destruction, the tasks still in the queue are run before the threads
+ * are joined.
+ *
+ * A task may destroy the last reference to the dispatcher (i.e. a
+ * callback destroys its manager). In that case, the worker running the
+ * task can't join itself so it gets detached instead. The state shared
+ * with the workers is reference counted so that thread can finish the
+ * tasks still in the queue and exit once the dispatcher is gone.
+ */
+class callback_dispatcher
+{
+public:
+    typedef std::shared_ptr<callback_dispatcher>    pointer_t;
+    typedef std::function<void()>                   task_t;
+
+    callback_dispatcher(std::size_t thread_count = 1)
+    {
+        if(thread_count == 0)
+        {
+            thread_count = 1;
+        }
+        f_threads.reserve(thread_count);
+        for(std::size_t idx(0); idx < thread_count; ++idx)
+        {
+            f_threads.emplace_back(&callback_dispatcher::run, f_state);
+        }
+    }
+
+    callback_dispatcher(callback_dispatcher const &) = delete;
+    callback_dispatcher & operator = (callback_dispatcher const &) = delete;
+
+    ~callback_dispatcher()
+    {
+        {
+            std::lock_guard lock(f_state->f_mutex);
+            f_state->f_stop = true;
+        }
+        f_state->f_condition.notify_all();
+        for(auto & t : f_threads)
+        {
+            if(t.get_id() == std::this_thread::get_id())
+            {
+                t.detach();
+            }
+            else
+            {
+                t.join();
+            }
+        }
+    }
+
+    /** \brief Add a task to the queue.
+     *
+     * \param[in] task  The task to run on one of the worker threads.
+     */
+    void post(task_t task)
+    {
+        {
+            std::lock_guard lock(f_state->f_mutex);
+            f_state->f_tasks.push_back(std::move(task));
+        }
+        f_state->f_condition.notify_one();
+    }
+
+    std::size_t thread_count() const
+    {
+        return f_threads.size();
+    }
+
+private:
+    /** \brief The data shared with the worker threads.
+     *
+     * Each worker holds a reference so a detached worker can still use
+     * it after the dispatcher was destroyed.
+     */
+    struct state_t
+    {
+        std::mutex                  f_mutex = std::mutex();
+        std::condition_variable     f_condition = std::condition_variable();
+        std::deque<task_t>          f_tasks = std::deque<task_t>();
+        bool                        f_stop = false;
+    };
+
+    typedef std::shared_ptr<state_t>                state_pointer_t;
+
+    static void run(state_pointer_t state)
+    {
+        for(;;)
+        {
+            task_t task;
+            {
+                std::unique_lock lock(state->f_mutex);
+                state->f_condition.wait(lock, [&state]()
+                    {
+                        return state->f_stop || !state->f_tasks.empty();
+                    });
+                if(state->f_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(state->f_tasks.front());
+                state->f_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    state_pointer_t             f_state = std::make_shared<state_t>();
+    std::vector<std::thread>    f_threads = std::vector<std::thread>();
+};
+
+
+
 /** \brief Manage a set of callbacks.
  *
  * This class is capable of handling a container of objects, either direct
@@ -117,13 +473,27 @@ namespace snapdev
  * Of course, you may use the clear() function as well. However, that is not
  * always what you want.
  *
+ * The arguments of the call() functions are taken by reference and
+ * passed as is to each callback so they do not get copied once per
+ * callback. Since they are given to several callbacks, they are never
+ * moved. To also avoid allocating memory to save the callbacks, use an
+ * snapdev::inplace_function as the callback type (see inplace_function.h)
+ * instead of an std::function.
+ *
+ * When \p CONCURRENT is true, the manager can be used by multiple threads
+ * without an external mutex (see concurrent_callback_manager). Any number
+ * of threads can call() at the same time while other threads add or
+ * remove callbacks. A call() sees the callbacks as they were when it
+ * started. Note that the callbacks themselves must be thread safe.
+ *
  * \tparam T  The type of function or object to manage.
+ * \tparam CONCURRENT  Whether the manager is shared between threads.
  */
-template<class T>
+template<class T, bool CONCURRENT = false>
 class callback_manager
 {
 public:
-    typedef std::shared_ptr<callback_manager<T>>    pointer_t;
+    typedef std::shared_ptr<callback_manager<T, CONCURRENT>> pointer_t;
     typedef T                                       value_type;
     typedef std::uint32_t                           callback_id_t;
     typedef std::int32_t                            priority_t;
@@ -131,26 +501,315 @@ public:
     static constexpr callback_id_t const            NULL_CALLBACK_ID = 0;
     static constexpr priority_t const               DEFAULT_PRIORITY = 0;
 
+    /** \brief The profiling statistics of one callback.
+     *
+     * See set_profiling() and get_statistics().
+     */
+    struct statistics_t
+    {
+        callback_id_t   f_id = NULL_CALLBACK_ID;
+        std::uint64_t   f_calls = 0;
+        std::uint64_t   f_stopped = 0;
+        timespec_ex     f_total_duration = timespec_ex();
+        timespec_ex     f_max_duration = timespec_ex();
+    };
+
 private:
+    /** \brief The counters of one callback.
+     *
+     * The counters are shared by all the copies of an item so they
+     * survive the copy-on-write of the vector of callbacks. They are
+     * atomic since several threads may call the same callback.
+     *
+     * The counters only get allocated once the profiling is turned on
+     * so adding a callback to a manager which never profiles does not
+     * allocate them.
+     */
+    struct counters_t
+    {
+        void record(std::int64_t duration, bool result)
+        {
+            f_calls.fetch_add(1, std::memory_order_relaxed);
+            if(!result)
+            {
+                f_stopped.fetch_add(1, std::memory_order_relaxed);
+            }
+            f_total_nsec.fetch_add(duration, std::memory_order_relaxed);
+            std::int64_t max(f_max_nsec.load(std::memory_order_relaxed));
+            while(duration > max
+               && !f_max_nsec.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void reset()
+        {
+            f_calls = 0;
+            f_stopped = 0;
+            f_total_nsec = 0;
+            f_max_nsec = 0;
+        }
+
+        std::atomic<std::uint64_t>  f_calls = 0;
+        std::atomic<std::uint64_t>  f_stopped = 0;
+        std::atomic<std::int64_t>   f_total_nsec = 0;
+        std::atomic<std::int64_t>   f_max_nsec = 0;
+    };
+
     struct item_t
     {
         item_t(
                   callback_id_t id
-                , value_type callback
-                , priority_t priority)
+                , value_type && callback
+                , priority_t priority
+                , bool profile)
             : f_id(id)
-            , f_callback(callback)
+            , f_callback(std::move(callback))
             , f_priority(priority)
         {
+            if(profile)
+            {
+                f_counters = std::make_shared<counters_t>();
+            }
+        }
+
+        statistics_t statistics() const
+        {
+            statistics_t result;
+            result.f_id = f_id;
+            if(f_counters == nullptr)
+            {
+                return result;
+            }
+            result.f_calls = f_counters->f_calls.load(std::memory_order_relaxed);
+            result.f_stopped = f_counters->f_stopped.load(std::memory_order_relaxed);
+            result.f_total_duration = timespec_ex(static_cast<std::int64_t>(f_counters->f_total_nsec.load(std::memory_order_relaxed)));
+            result.f_max_duration = timespec_ex(static_cast<std::int64_t>(f_counters->f_max_nsec.load(std::memory_order_relaxed)));
+            return result;
         }
 
         callback_id_t   f_id = NULL_CALLBACK_ID;
         value_type      f_callback = value_type();
         priority_t      f_priority = DEFAULT_PRIORITY;
+        std::shared_ptr<counters_t> f_counters = std::shared_ptr<counters_t>();
+    };
+
+
+    /** \brief The vector of callbacks.
+     *
+     * Once a vector is saved in f_callbacks, it is never modified again.
+     * The add_callback() and remove_callback() functions create a new
+     * vector and replace the pointer. This way a call() in progress keeps
+     * its own snapshot of the callbacks alive without copying them.
+     */
+    typedef std::vector<item_t>                     callbacks_t;
+    typedef std::shared_ptr<callbacks_t>            callbacks_pointer_t;
+
+
+    /** \brief A mutex which does nothing.
+     *
+     * The writers of a non-concurrent callback_manager use this mutex
+     * so the class remains copyable and does not pay for a lock.
+     */
+    struct no_mutex_t
+    {
+        void lock()
+        {
+        }
+
+        void unlock()
+        {
+        }
     };
 
 
-    typedef std::list<item_t>                       callbacks_t;
+    typedef std::conditional_t<CONCURRENT
+                , std::atomic<callbacks_pointer_t>
+                , callbacks_pointer_t>              callbacks_holder_t;
+    typedef std::conditional_t<CONCURRENT
+                , std::mutex
+                , no_mutex_t>                       mutex_t;
+    typedef std::conditional_t<CONCURRENT
+                , std::atomic<bool>
+                , bool>                             flag_t;
+    typedef std::conditional_t<CONCURRENT
+                , std::atomic<callbacks_t *>
+                , callbacks_t *>                    current_t;
+
+
+    /** \brief Retrieve the current vector of callbacks.
+     *
+     * In the concurrent version, the pointer is atomically loaded so the
+     * vector remains valid until the returned pointer gets released even
+     * if another thread replaces it in the meantime.
+     *
+     * \return The current vector of callbacks, may be a null pointer.
+     */
+    callbacks_pointer_t snapshot() const
+    {
+        if constexpr(CONCURRENT)
+        {
+            return f_callbacks.load(std::memory_order_acquire);
+        }
+        else
+        {
+            return f_callbacks;
+        }
+    }
+
+
+    /** \brief Replace the vector of callbacks.
+     *
+     * The caller must hold f_mutex.
+     *
+     * In the concurrent version, the old vector may still be walked by
+     * a call() so it is retired instead of released (see
+     * detail::snapshot_epochs).
+     *
+     * \param[in] callbacks  The new vector of callbacks.
+     */
+    void publish(callbacks_pointer_t callbacks)
+    {
+        if constexpr(CONCURRENT)
+        {
+            f_current.store(callbacks.get());
+            detail::snapshot_epochs::instance().retire(f_callbacks.exchange(std::move(callbacks)));
+        }
+        else
+        {
+            f_callbacks = std::move(callbacks);
+        }
+    }
+
+
+    /** \brief Run a function with the current vector of callbacks.
+     *
+     * In the concurrent version, the vector is accessed through a plain
+     * pointer while the thread is registered in the current epoch, which
+     * prevents the vector from being freed. No reference counter shared
+     * between threads gets modified.
+     *
+     * \tparam F  The type of the function to run.
+     * \param[in] f  The function to run with the vector of callbacks.
+     *
+     * \return The value returned by \p f.
+     */
+    template<typename F>
+    bool with_snapshot(F && f) const
+    {
+        if constexpr(CONCURRENT)
+        {
+            struct epoch_guard_t
+            {
+                epoch_guard_t()
+                {
+                    detail::snapshot_epochs::instance().enter();
+                }
+
+                epoch_guard_t(epoch_guard_t const &) = delete;
+
+                ~epoch_guard_t()
+                {
+                    detail::snapshot_epochs::instance().leave();
+                }
+
+                epoch_guard_t & operator = (epoch_guard_t const &) = delete;
+            };
+            epoch_guard_t guard;
+            return f(f_current.load());
+        }
+        else
+        {
+            // keep the vector alive in case a callback modifies the list
+            //
+            callbacks_pointer_t const callbacks(f_callbacks);
+            return f(callbacks.get());
+        }
+    }
+
+
+    /** \brief One invocation posted by call_async().
+     *
+     * The arguments are saved in an std::any so call_async_coalesced()
+     * can compare pending invocations with different argument types.
+     */
+    struct async_call_t
+    {
+        callbacks_pointer_t         f_callbacks = callbacks_pointer_t();
+        bool                        f_profile = false;
+        std::any                    f_args = std::any();
+        std::promise<bool>          f_promise = std::promise<bool>();
+        std::shared_future<bool>    f_result = std::shared_future<bool>();
+    };
+
+    typedef std::shared_ptr<async_call_t>           async_call_pointer_t;
+
+
+    /** \brief The invocations which were not started yet.
+     *
+     * This list is only used by call_async_coalesced(). The worker
+     * removes an invocation from the list just before running it so
+     * an event emitted while the callbacks run is queued again.
+     */
+    struct pending_calls_t
+    {
+        std::mutex                      f_mutex = std::mutex();
+        std::list<async_call_pointer_t> f_calls = std::list<async_call_pointer_t>();
+    };
+
+    typedef std::shared_ptr<pending_calls_t>        pending_calls_pointer_t;
+
+
+    /** \brief Call each callback of a snapshot.
+     *
+     * This function calls \p invoke with each callback until one returns
+     * false. When \p profile is true, each call is timed and the counters
+     * of the callback updated. When false, the loop does nothing more
+     * than calling the callbacks.
+     *
+     * \tparam C  The type of the function calling one callback.
+     * \param[in] callbacks  The snapshot of the callbacks to call.
+     * \param[in] profile  Whether to record the statistics.
+     * \param[in] invoke  The function calling one callback.
+     *
+     * \return true if all the callbacks returned true.
+     */
+    template<typename C>
+    static bool run_callbacks(callbacks_t * callbacks, bool profile, C && invoke)
+    {
+        if(callbacks == nullptr)
+        {
+            return true;
+        }
+        if(!profile)
+        {
+            for(auto & c : *callbacks)
+            {
+                if(!invoke(c))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        for(auto & c : *callbacks)
+        {
+            timespec_ex const start(timespec_ex::gettime(CLOCK_MONOTONIC));
+            bool const result(invoke(c));
+            // the counters may be missing if the profiling was turned on
+            // after this call() loaded its vector
+            //
+            if(c.f_counters != nullptr)
+            {
+                c.f_counters->record((timespec_ex::gettime(CLOCK_MONOTONIC) - start).to_nsec(), result);
+            }
+            if(!result)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 
 
     /** \brief Function used when the "callbacks" are objects.
@@ -169,23 +828,20 @@ private:
      *
      * \tparam F  The type of the member function to call.
      * \tparam ARGS  The types of the list of arguments.
+     * \param[in] callbacks  The snapshot of the callbacks to call.
+     * \param[in] profile  Whether to record the statistics.
      * \param[in] func  The member function that gets called.
      * \param[in] args  The arguments to pass to the member function.
      *
      * \return true if all the callbacks returned true, false otherwise.
      */
     template<typename F, typename ... ARGS>
-    bool call_member_pointer(F func, ARGS ... args)
+    static bool call_member_pointer(callbacks_t * callbacks, bool profile, F func, ARGS && ... args)
     {
-        auto callbacks(f_callbacks);
-        for(auto & c : callbacks)
-        {
-            if(!(c.f_callback.get()->*func)(args...))
+        return run_callbacks(callbacks, profile, [&](item_t & c)
             {
-                return false;
-            }
-        }
-        return true;
+                return (c.f_callback.get()->*func)(args...);
+            });
     }
 
 
@@ -205,23 +861,20 @@ private:
      *
      * \tparam F  The type of the member function to call.
      * \tparam ARGS  The types of the list of arguments.
+     * \param[in] callbacks  The snapshot of the callbacks to call.
+     * \param[in] profile  Whether to record the statistics.
      * \param[in] func  The member function that gets called.
      * \param[in] args  The arguments to pass to the member function.
      *
      * \return true if all the callbacks returned true, false otherwise.
      */
     template<typename F, typename ... ARGS>
-    bool call_member(F func, ARGS ... args)
+    static bool call_member(callbacks_t * callbacks, bool profile, F func, ARGS && ... args)
     {
-        auto callbacks(f_callbacks);
-        for(auto & c : callbacks)
-        {
-            if(!(c.f_callback.*func)(args...))
+        return run_callbacks(callbacks, profile, [&](item_t & c)
             {
-                return false;
-            }
-        }
-        return true;
+                return (c.f_callback.*func)(args...);
+            });
     }
 
 
@@ -237,22 +890,150 @@ private:
      * call_function() returns `true`.
      *
      * \tparam ARGS  The types of the arguments to pass to the callbacks.
+     * \param[in] callbacks  The snapshot of the callbacks to call.
+     * \param[in] profile  Whether to record the statistics.
      * \param[in] args  The arguments to pass to the callbacks.
      *
      * \return true if all the callbacks return true.
      */
     template<typename ... ARGS>
-    bool call_function(ARGS ... args)
+    static bool call_function(callbacks_t * callbacks, bool profile, ARGS && ... args)
+    {
+        return run_callbacks(callbacks, profile, [&](item_t & c)
+            {
+                return std::invoke(c.f_callback, args...);
+            });
+    }
+
+
+    /** \brief Call the callbacks of a snapshot.
+     *
+     * This function selects the call_member_pointer(), call_member(), or
+     * call_function() function the same way the call() functions do.
+     * It is used to run the invocations of call_async().
+     *
+     * \tparam ARGS  The types of the arguments, starting with the member
+     * function pointer if any.
+     * \param[in] callbacks  The snapshot of the callbacks to call.
+     * \param[in] profile  Whether to record the statistics.
+     * \param[in] args  The arguments of the call.
+     *
+     * \return true if all the callbacks returned true.
+     */
+    template<typename ... ARGS>
+    static bool dispatch(callbacks_pointer_t const & callbacks, bool profile, ARGS & ... args)
     {
-        auto callbacks(f_callbacks);
-        for(auto & c : callbacks)
+        if constexpr(detail::first_is_member_function_pointer<ARGS...>::value)
         {
-            if(!std::invoke(c.f_callback, args...))
+            if constexpr(is_shared_ptr<T>::value)
             {
-                return false;
+                return call_member_pointer(callbacks.get(), profile, args...);
+            }
+            else
+            {
+                return call_member(callbacks.get(), profile, args...);
             }
         }
-        return true;
+        else
+        {
+            return call_function(callbacks.get(), profile, args...);
+        }
+    }
+
+
+    /** \brief Post an invocation to the dispatcher.
+     *
+     * \tparam COALESCE  Whether to merge this invocation with an equal
+     * pending invocation.
+     * \tparam ARGS  The types of the arguments.
+     * \param[in] args  The arguments of the call.
+     *
+     * \return The future result of the invocation.
+     */
+    template<bool COALESCE, typename ... ARGS>
+    std::shared_future<bool> post(ARGS && ... args)
+    {
+        typedef std::tuple<std::decay_t<ARGS>...> args_t;
+
+        callbacks_pointer_t callbacks(snapshot());
+        if(callbacks == nullptr)
+        {
+            std::promise<bool> nothing_to_do;
+            nothing_to_do.set_value(true);
+            return nothing_to_do.get_future().share();
+        }
+
+        callback_dispatcher::pointer_t dispatcher;
+        pending_calls_pointer_t pending;
+        {
+            std::lock_guard lock(f_mutex);
+            if(f_dispatcher == nullptr)
+            {
+                f_dispatcher = std::make_shared<callback_dispatcher>();
+            }
+            dispatcher = f_dispatcher;
+            if constexpr(COALESCE)
+            {
+                if(f_pending == nullptr)
+                {
+                    f_pending = std::make_shared<pending_calls_t>();
+                }
+                pending = f_pending;
+            }
+        }
+
+        async_call_pointer_t call(std::make_shared<async_call_t>());
+        call->f_callbacks = std::move(callbacks);
+        call->f_profile = is_profiling();
+        call->f_result = call->f_promise.get_future().share();
+
+        if constexpr(COALESCE)
+        {
+            std::lock_guard lock(pending->f_mutex);
+            for(auto const & p : pending->f_calls)
+            {
+                args_t const * a(std::any_cast<args_t>(&p->f_args));
+                if(a != nullptr
+                && p->f_callbacks == call->f_callbacks
+                && *a == std::forward_as_tuple(args...))
+                {
+                    return p->f_result;
+                }
+            }
+            call->f_args = args_t(std::forward<ARGS>(args)...);
+            pending->f_calls.push_back(call);
+        }
+        else
+        {
+            call->f_args = args_t(std::forward<ARGS>(args)...);
+        }
+
+        // the task does not reference this manager so it can safely
+        // run after the manager was destroyed
+        //
+        dispatcher->post([call, pending]()
+            {
+                if(pending != nullptr)
+                {
+                    std::lock_guard lock(pending->f_mutex);
+                    pending->f_calls.remove(call);
+                }
+                try
+                {
+                    call->f_promise.set_value(std::apply(
+                          [&call](auto & ... a)
+                          {
+                              return dispatch(call->f_callbacks, call->f_profile, a...);
+                          }
+                        , *std::any_cast<args_t>(&call->f_args)));
+                }
+                catch(...)
+                {
+                    call->f_promise.set_exception(std::current_exception());
+                }
+            });
+
+        return call->f_result;
     }
 
 
@@ -300,28 +1081,40 @@ public:
      */
     callback_id_t add_callback(value_type callback, priority_t priority = DEFAULT_PRIORITY)
     {
+        std::lock_guard lock(f_mutex);
+
         ++f_next_id;
         if(f_next_id == NULL_CALLBACK_ID)
         {
             ++f_next_id;  // LCOV_EXCL_LINE
         }
 
-        auto it(std::find_if(
-              f_callbacks.begin()
-            , f_callbacks.end()
-            , [priority](auto const & c)
+        // the new vector is built with push_back() only since some
+        // callbacks, such as std::bind() objects, cannot be assigned
+        //
+        callbacks_pointer_t const current(snapshot());
+        callbacks_pointer_t callbacks(std::make_shared<callbacks_t>());
+        callbacks->reserve((current == nullptr ? 0 : current->size()) + 1);
+        bool inserted(false);
+        if(current != nullptr)
+        {
+            for(auto const & c : *current)
+            {
+                // assuming f_next_id doesn't wrap, this is sufficient
+                //
+                if(!inserted && c.f_priority < priority)
                 {
-                    // assuming f_next_id doesn't wrap, this is sufficient
-                    //
-                    return c.f_priority < priority;
-                }));
-
-        f_callbacks.emplace(
-                      it
-                    , f_next_id
-                    , callback
-                    , priority
-                );
+                    callbacks->emplace_back(f_next_id, std::move(callback), priority, is_profiling());
+                    inserted = true;
+                }
+                callbacks->push_back(c);
+            }
+        }
+        if(!inserted)
+        {
+            callbacks->emplace_back(f_next_id, std::move(callback), priority, is_profiling());
+        }
+        publish(callbacks);
 
         return f_next_id;
     }
@@ -354,19 +1147,42 @@ public:
      */
     bool remove_callback(callback_id_t callback_id)
     {
+        std::lock_guard lock(f_mutex);
+
+        callbacks_pointer_t const current(snapshot());
+        if(current == nullptr)
+        {
+            return false;
+        }
+
         auto it(std::find_if(
-              f_callbacks.begin()
-            , f_callbacks.end()
+              current->begin()
+            , current->end()
             , [callback_id](auto const & c)
                 {
                     return c.f_id == callback_id;
                 }));
-        if(it == f_callbacks.end())
+        if(it == current->end())
         {
             return false;
         }
 
-        f_callbacks.erase(it);
+        if(current->size() == 1)
+        {
+            publish(callbacks_pointer_t());
+            return true;
+        }
+
+        callbacks_pointer_t callbacks(std::make_shared<callbacks_t>());
+        callbacks->reserve(current->size() - 1);
+        for(auto c(current->cbegin()); c != current->cend(); ++c)
+        {
+            if(c != it)
+            {
+                callbacks->push_back(*c);
+            }
+        }
+        publish(callbacks);
 
         return true;
     }
@@ -382,12 +1198,14 @@ public:
      */
     bool clear()
     {
-        if(f_callbacks.empty())
+        std::lock_guard lock(f_mutex);
+
+        if(snapshot() == nullptr)
         {
             return false;
         }
 
-        f_callbacks.clear();
+        publish(callbacks_pointer_t());
         return true;
     }
 
@@ -406,7 +1224,8 @@ public:
      */
     std::size_t size() const
     {
-        return f_callbacks.size();
+        callbacks_pointer_t const callbacks(snapshot());
+        return callbacks == nullptr ? 0 : callbacks->size();
     }
 
 
@@ -420,7 +1239,7 @@ public:
      */
     bool empty() const
     {
-        return f_callbacks.empty();
+        return snapshot() == nullptr;
     }
 
 
@@ -455,9 +1274,12 @@ public:
                 && std::is_member_function_pointer<F>::value
                 && is_shared_ptr<U>::value
             , bool>::type
-    call(F func, ARGS ... args)
+    call(F func, ARGS && ... args)
     {
-        return call_member_pointer(func, args...);
+        return with_snapshot([&](callbacks_t * callbacks)
+            {
+                return call_member_pointer(callbacks, is_profiling(), func, std::forward<ARGS>(args)...);
+            });
     }
 
 
@@ -492,9 +1314,12 @@ public:
                 && std::is_member_function_pointer<F>::value
                 && !is_shared_ptr<U>::value
             , bool>::type
-    call(F func, ARGS ... args)
+    call(F func, ARGS && ... args)
     {
-        return call_member(func, args...);
+        return with_snapshot([&](callbacks_t * callbacks)
+            {
+                return call_member(callbacks, is_profiling(), func, std::forward<ARGS>(args)...);
+            });
     }
 
 
@@ -518,9 +1343,214 @@ public:
     template<typename ... ARGS, typename U = T>
     typename std::enable_if<std::is_same<U, T>::value
             && !is_shared_ptr<U>::value, bool>::type
-    call(ARGS ... args)
+    call(ARGS && ... args)
+    {
+        return with_snapshot([&](callbacks_t * callbacks)
+            {
+                return call_function(callbacks, is_profiling(), std::forward<ARGS>(args)...);
+            });
+    }
+
+
+    /** \brief Call the managed callbacks from a worker thread.
+     *
+     * This function accepts the same parameters as the call() functions.
+     * The arguments are copied and the callbacks get called from one of
+     * the threads of the dispatcher (see set_dispatcher()). The
+     * callbacks are called in the usual priority order and the loop
+     * still stops on the first callback returning false.
+     *
+     * The callbacks called are the ones present at the time
+     * call_async() is called.
+     *
+     * If a callback throws, the exception is saved in the future.
+     *
+     * \tparam ARGS  The types of the arguments.
+     * \param[in] args  The arguments, starting with the member function
+     * pointer when the callbacks are objects.
+     *
+     * \return A future to the combined result of the callbacks.
+     */
+    template<typename ... ARGS>
+    std::shared_future<bool> call_async(ARGS && ... args)
     {
-        return call_function(args...);
+        return post<false>(std::forward<ARGS>(args)...);
+    }
+
+
+    /** \brief Call the callbacks asynchronously, merging equal events.
+     *
+     * This function works like call_async() except that if an invocation
+     * with the same arguments and the same callbacks is still waiting
+     * in the queue, no new invocation is added. Instead, the future of
+     * the pending invocation is returned. This is useful to collapse
+     * bursts of identical events (i.e. "configuration changed") in one
+     * call of the callbacks.
+     *
+     * The arguments must be comparable with operator ==.
+     *
+     * \tparam ARGS  The types of the arguments.
+     * \param[in] args  The arguments, starting with the member function
+     * pointer when the callbacks are objects.
+     *
+     * \return A future to the combined result of the callbacks.
+     */
+    template<typename ... ARGS>
+    std::shared_future<bool> call_async_coalesced(ARGS && ... args)
+    {
+        return post<true>(std::forward<ARGS>(args)...);
+    }
+
+
+    /** \brief Change the dispatcher used by the call_async() functions.
+     *
+     * By default, the manager creates a dispatcher with one thread the
+     * first time one of the call_async() functions gets called. Use this
+     * function to share a dispatcher between managers or to use more
+     * threads.
+     *
+     * \param[in] dispatcher  The dispatcher to use from now on.
+     */
+    void set_dispatcher(callback_dispatcher::pointer_t dispatcher)
+    {
+        std::lock_guard lock(f_mutex);
+        f_dispatcher = std::move(dispatcher);
+    }
+
+
+    /** \brief Turn the profiling of the callbacks on or off.
+     *
+     * When the profiling is on, the call() functions time each callback
+     * and update its statistics. When off (the default), the call()
+     * functions only check this flag once per call.
+     *
+     * The statistics are kept when the profiling is turned off. Use
+     * reset_statistics() to clear them.
+     *
+     * The counters of the callbacks are allocated the first time the
+     * profiling gets turned on, which replaces the vector of callbacks
+     * like add_callback() does.
+     *
+     * \param[in] profile  Whether to profile the callbacks.
+     *
+     * \sa get_statistics()
+     */
+    void set_profiling(bool profile)
+    {
+        std::lock_guard lock(f_mutex);
+
+        if(profile)
+        {
+            callbacks_pointer_t const current(snapshot());
+            if(current != nullptr
+            && std::any_of(
+                      current->begin()
+                    , current->end()
+                    , [](item_t const & c)
+                      {
+                          return c.f_counters == nullptr;
+                      }))
+            {
+                callbacks_pointer_t callbacks(std::make_shared<callbacks_t>());
+                callbacks->reserve(current->size());
+                for(auto const & c : *current)
+                {
+                    callbacks->push_back(c);
+                    if(callbacks->back().f_counters == nullptr)
+                    {
+                        callbacks->back().f_counters = std::make_shared<counters_t>();
+                    }
+                }
+                publish(callbacks);
+            }
+        }
+
+        f_profiling = profile;
+    }
+
+
+    /** \brief Check whether the profiling is on.
+     *
+     * \return true if set_profiling() was called with true.
+     */
+    bool is_profiling() const
+    {
+        if constexpr(CONCURRENT)
+        {
+            return f_profiling.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            return f_profiling;
+        }
+    }
+
+
+    /** \brief Retrieve the statistics of one callback.
+     *
+     * The statistics include the number of times the callback was called,
+     * the number of times it returned false (which stops the loop), and
+     * the total and maximum durations of the calls. The numbers only
+     * increase while the profiling is on.
+     *
+     * \param[in] callback_id  The identifier returned by add_callback().
+     *
+     * \return The statistics of the callback. If the callback does not
+     * exist, the f_id field is set to NULL_CALLBACK_ID.
+     */
+    statistics_t get_statistics(callback_id_t callback_id) const
+    {
+        callbacks_pointer_t const callbacks(snapshot());
+        if(callbacks != nullptr)
+        {
+            for(auto const & c : *callbacks)
+            {
+                if(c.f_id == callback_id)
+                {
+                    return c.statistics();
+                }
+            }
+        }
+        return statistics_t();
+    }
+
+
+    /** \brief Retrieve the statistics of all the callbacks.
+     *
+     * \return The statistics of each callback, in the order they get
+     * called.
+     */
+    std::vector<statistics_t> get_statistics() const
+    {
+        std::vector<statistics_t> result;
+        callbacks_pointer_t const callbacks(snapshot());
+        if(callbacks != nullptr)
+        {
+            result.reserve(callbacks->size());
+            for(auto const & c : *callbacks)
+            {
+                result.push_back(c.statistics());
+            }
+        }
+        return result;
+    }
+
+
+    /** \brief Reset the statistics of all the callbacks to zero.
+     */
+    void reset_statistics()
+    {
+        callbacks_pointer_t const callbacks(snapshot());
+        if(callbacks != nullptr)
+        {
+            for(auto const & c : *callbacks)
+            {
+                if(c.f_counters != nullptr)
+                {
+                    c.f_counters->reset();
+                }
+            }
+        }
     }
 
 
@@ -528,11 +1558,49 @@ private:
     /** \brief The list of callbacks.
      *
      * This variable holds the list of callbacks added by the add_callback()
-     * function. By default it is empty, meaning that the call() function
-     * does nothing. The list can be shrunk using the remove_callback()
-     * or the clear() functions.
+     * function. By default it is a null pointer, meaning that the call()
+     * function does nothing. The list can be shrunk using the
+     * remove_callback() or the clear() functions. When the last callback
+     * is removed, the pointer is reset to null.
+     *
+     * In the concurrent version, this is an atomic shared pointer. Use
+     * snapshot() and publish() to access it.
      */
-    callbacks_t     f_callbacks = callbacks_t();
+    callbacks_holder_t f_callbacks = callbacks_holder_t();
+
+
+    /** \brief The vector of callbacks used by the call() functions.
+     *
+     * Only used by the concurrent version. It points to the vector
+     * owned by f_callbacks.
+     */
+    current_t       f_current = nullptr;
+
+
+    /** \brief Serialize the functions modifying the list of callbacks.
+     *
+     * The call() functions never lock this mutex. In the non-concurrent
+     * version, this mutex does nothing.
+     */
+    mutex_t         f_mutex = mutex_t();
+
+
+    /** \brief The dispatcher used by the call_async() functions.
+     *
+     * This pointer is null until set_dispatcher() or one of the
+     * call_async() functions gets called.
+     */
+    callback_dispatcher::pointer_t f_dispatcher = callback_dispatcher::pointer_t();
+
+
+    /** \brief Whether the call() functions record statistics.
+     */
+    flag_t          f_profiling = false;
+
+
+    /** \brief The call_async_coalesced() invocations not yet started.
+     */
+    pending_calls_pointer_t f_pending = pending_calls_pointer_t();
 
 
     /** \brief The next idenfitier.
@@ -547,6 +1615,14 @@ private:
 };
 
 
+/** \brief A callback_manager which can be shared between threads.
+ *
+ * \tparam T  The type of function or object to manage.
+ */
+template<class T>
+using concurrent_callback_manager = callback_manager<T, true>;
+
+
 
 } // namespace snapdev
 // vim: ts=4 sw=4 et
@@ -28,18 +28,36 @@
  * a time, which means it is not compatible with certain languages where
  * multiple characters may be affected when computer uppercase or lowercase
  * characters.
+ *
+ * For `char` strings, the compare() function has a fast path which
+ * compares 16 (SSE2) or 8 (SWAR) bytes at a time when all the bytes are
+ * ASCII. Blocks including bytes 0x80 or more go through toupper().
+ * The fast path folds ASCII letters as the "C" locale does (a-z become
+ * A-Z, nothing else changes).
+ *
+ * The case_insensitive_hash and case_insensitive_equal functors can be
+ * used to create unordered containers with case insensitive keys. They
+ * work with case_insensitive_string, std::string, and std::string_view
+ * keys (heterogeneous lookup is supported).
  */
 
 // C++
 //
 #include    <algorithm>
+#include    <cstdint>
+#include    <cstring>
 #include    <cwctype>
 #include    <string>
+#include    <string_view>
+#include    <type_traits>
 
 
 // C
 //
 #include    <string.h>
+#if defined(__SSE2__)
+#include    <emmintrin.h>
+#endif
 
 
 
@@ -47,6 +65,43 @@ namespace snapdev
 {
 
 
+namespace detail
+{
+
+
+/** \brief Transform the ASCII letters of 8 bytes to uppercase.
+ *
+ * This function transforms 8 bytes at once. The bytes are expected to
+ * all be ASCII (0x00 to 0x7F). Only the letters 'a' to 'z' are modified.
+ *
+ * \param[in] w  The 8 bytes to transform.
+ *
+ * \return The 8 bytes with lowercase letters transformed to uppercase.
+ */
+inline std::uint64_t ascii_toupper_word(std::uint64_t w)
+{
+    std::uint64_t const ge_a(w + 0x0101010101010101ULL * (0x80 - 'a'));
+    std::uint64_t const gt_z(w + 0x0101010101010101ULL * (0x7F - 'z'));
+    return w & ~(((ge_a & ~gt_z) & 0x8080808080808080ULL) >> 2);
+}
+
+
+/** \brief Check whether 8 bytes are all ASCII.
+ *
+ * \param[in] w  The 8 bytes to check.
+ *
+ * \return true if none of the bytes has bit 7 set.
+ */
+inline bool is_ascii_word(std::uint64_t w)
+{
+    return (w & 0x8080808080808080ULL) == 0;
+}
+
+
+} // namespace detail
+
+
+
 /** \brief Trait to compare characters in lowercase (Case insensitively).
  *
  * This function is used to compare two characters together to allow for
@@ -84,21 +139,55 @@ public:
 
     static int compare(char_t const * s1, char_t const * s2, size_t n)
     {
-        for(; n != 0; --n)
+        if constexpr(std::is_same_v<char_t, char>)
         {
-            if(lt(*s1, *s2))
+#if defined(__SSE2__)
+            while(n >= 16)
             {
-                return -1;
+                __m128i const a(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s1)));
+                __m128i const b(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s2)));
+                if(_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+                {
+                    break;
+                }
+                if(_mm_movemask_epi8(_mm_cmpeq_epi8(ascii_toupper(a), ascii_toupper(b))) != 0xFFFF)
+                {
+                    break;
+                }
+                s1 += 16;
+                s2 += 16;
+                n -= 16;
             }
-            if(lt(*s2, *s1))
+#endif
+            while(n >= 8)
             {
-                return 1;
+                std::uint64_t a;
+                std::uint64_t b;
+                std::memcpy(&a, s1, sizeof(a));
+                std::memcpy(&b, s2, sizeof(b));
+                if(detail::is_ascii_word(a | b)
+                && detail::ascii_toupper_word(a) == detail::ascii_toupper_word(b))
+                {
+                    s1 += 8;
+                    s2 += 8;
+                    n -= 8;
+                    continue;
+                }
+
+                // there is a difference or non-ASCII characters
+                //
+                int const r(compare_characters(s1, s2, 8));
+                if(r != 0)
+                {
+                    return r;
+                }
+                s1 += 8;
+                s2 += 8;
+                n -= 8;
             }
-            ++s1;
-            ++s2;
         }
 
-        return 0;
+        return compare_characters(s1, s2, n);
     }
 
     static char_t const * find(char_t const * s, int n, char_t a)
@@ -106,6 +195,33 @@ public:
         for(; n > 0 && ne(*s, a); --n, ++s);
         return s;
     }
+
+private:
+    static int compare_characters(char_t const * s1, char_t const * s2, size_t n)
+    {
+        for(; n != 0; --n)
+        {
+            auto const c1(toupper(*s1));
+            auto const c2(toupper(*s2));
+            if(c1 != c2)
+            {
+                return c1 < c2 ? -1 : 1;
+            }
+            ++s1;
+            ++s2;
+        }
+
+        return 0;
+    }
+
+#if defined(__SSE2__)
+    static __m128i ascii_toupper(__m128i v)
+    {
+        __m128i const shifted(_mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - 'a'))));
+        __m128i const is_letter(_mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26))));
+        return _mm_andnot_si128(_mm_and_si128(is_letter, _mm_set1_epi8(0x20)), v);
+    }
+#endif
 };
 
 typedef std::basic_string<char,     case_insensitive_traits<char>>      case_insensitive_string;
@@ -125,5 +241,114 @@ std::basic_string<_CharT> to_string(std::basic_string<_CharT, case_insensitive_t
     return std::basic_string<_CharT>(input.c_str(), input.length());
 }
 
+
+/** \brief Hash a string case insensitively.
+ *
+ * This functor computes a hash of a string after transforming its
+ * characters to uppercase the same way as the case_insensitive_traits
+ * do. Two strings that compare equal with the case_insensitive_traits
+ * get the same hash.
+ *
+ * For `char` strings, 8 bytes are hashed at a time when they are all
+ * ASCII.
+ *
+ * The functor is transparent so an unordered container can be searched
+ * with an std::string_view without creating a key object.
+ *
+ * \code
+ *     std::unordered_map<
+ *               std::string
+ *             , int
+ *             , snapdev::case_insensitive_hash
+ *             , snapdev::case_insensitive_equal> headers;
+ * \endcode
+ */
+struct case_insensitive_hash
+{
+    typedef void is_transparent;
+
+    template<typename StringT>
+    std::size_t operator () (StringT const & str) const
+    {
+        return hash(std::data(str), std::size(str));
+    }
+
+    template<typename CharT>
+    static std::size_t hash(CharT const * s, std::size_t n)
+    {
+        std::uint64_t h(0xCBF29CE484222325ULL ^ n);
+        if constexpr(std::is_same_v<CharT, char>)
+        {
+            for(; n >= 8; n -= 8, s += 8)
+            {
+                std::uint64_t w;
+                std::memcpy(&w, s, sizeof(w));
+                if(detail::is_ascii_word(w))
+                {
+                    w = detail::ascii_toupper_word(w);
+                }
+                else
+                {
+                    char upper[8];
+                    for(int idx(0); idx < 8; ++idx)
+                    {
+                        upper[idx] = static_cast<char>(toupper(s[idx]));
+                    }
+                    std::memcpy(&w, upper, sizeof(w));
+                }
+                h = mix(h ^ w);
+            }
+        }
+        for(; n > 0; --n, ++s)
+        {
+            h = mix(h ^ static_cast<std::uint64_t>(toupper(*s)));
+        }
+        return static_cast<std::size_t>(h);
+    }
+
+private:
+    static std::uint64_t mix(std::uint64_t h)
+    {
+        h *= 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 29);
+    }
+};
+
+
+/** \brief Compare two strings case insensitively.
+ *
+ * This functor is the equality counterpart of case_insensitive_hash.
+ * It accepts any combination of std::string, std::string_view, and
+ * case_insensitive_string.
+ */
+struct case_insensitive_equal
+{
+    typedef void is_transparent;
+
+    template<typename LhsT, typename RhsT>
+    bool operator () (LhsT const & lhs, RhsT const & rhs) const
+    {
+        typedef std::remove_cv_t<std::remove_reference_t<decltype(*std::data(lhs))>> char_t;
+        return std::size(lhs) == std::size(rhs)
+            && case_insensitive_traits<char_t>::compare(std::data(lhs), std::data(rhs), std::size(lhs)) == 0;
+    }
+};
+
+
 } // namespace snapdev
+
+
+/** \brief Hash a case_insensitive_string.
+ *
+ * This specialization allows for case_insensitive_string to be used as
+ * the key of std::unordered_map and std::unordered_set.
+ */
+template<>
+struct std::hash<snapdev::case_insensitive_string>
+{
+    std::size_t operator () (snapdev::case_insensitive_string const & str) const
+    {
+        return snapdev::case_insensitive_hash::hash(str.data(), str.length());
+    }
+};
 // vim: ts=4 sw=4 et
@@ -0,0 +1,279 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Concatenate strings, numbers, and timestamps at runtime.
+ *
+ * A chain of `operator + ()` creates one temporary string per `+` and
+ * each one of those may reallocate its buffer. The templates found here
+ * first convert each piece to a view (strings) or to a small stack buffer
+ * (numbers), then compute the exact size of the result, reserve that
+ * size, and finally copy the pieces. The result is built with a single
+ * allocation.
+ *
+ * \code
+ *     std::string const msg(snapdev::concat_to_string(
+ *               "could not open \""
+ *             , filename
+ *             , "\" (errno: "
+ *             , errno
+ *             , ")."));
+ * \endcode
+ */
+
+// C++
+//
+#include    <charconv>
+#include    <cstdint>
+#include    <string>
+#include    <string_view>
+#include    <type_traits>
+
+
+// C
+//
+#include    <time.h>
+
+
+
+namespace snapdev
+{
+
+namespace detail
+{
+
+
+/** \brief A piece of a concatenation held in a small buffer.
+ *
+ * Numbers get converted in this buffer. The buffer is large enough to
+ * hold any one number of the supported types so the conversion never
+ * needs to allocate anything.
+ *
+ * \tparam N  The size of the buffer in bytes.
+ */
+template<std::size_t N>
+struct concat_buffer
+{
+    char const * data() const
+    {
+        return f_buffer + f_start;
+    }
+
+    std::size_t size() const
+    {
+        return f_end - f_start;
+    }
+
+    char                f_buffer[N] = {};
+    std::size_t         f_start = 0;
+    std::size_t         f_end = 0;
+};
+
+
+/** \brief Write an unsigned integer at the end of a concat_buffer.
+ *
+ * This function writes the digits of \p value at the end of the buffer
+ * moving f_start backward. It is used with `unsigned __int128` which
+ * std::to_chars() does not support in strict C++ mode.
+ *
+ * \tparam T  The type of unsigned integer.
+ * \tparam N  The size of the buffer.
+ * \param[in,out] buffer  The buffer receiving the digits.
+ * \param[in] value  The value to convert.
+ */
+template<typename T, std::size_t N>
+void concat_unsigned_integer(concat_buffer<N> & buffer, T value)
+{
+    buffer.f_end = N;
+    buffer.f_start = N;
+    do
+    {
+        --buffer.f_start;
+        buffer.f_buffer[buffer.f_start] = static_cast<char>(value % 10 + '0');
+        value /= 10;
+    }
+    while(value != 0);
+}
+
+
+/** \brief Convert one concat_to_string() argument to a piece.
+ *
+ * The returned object has a data() and a size() function. Strings are
+ * returned as an std::string_view so no copy happens at this point.
+ * Numbers are converted to a concat_buffer.
+ *
+ * \li `char` -- added as is (like `std::string::operator += (char)`);
+ * \li `bool` -- added as "true" or "false";
+ * \li integers, including `__int128`, -- added in decimal;
+ * \li floating points -- added with the shortest representation which
+ *     round trips (see std::to_chars());
+ * \li `timespec` and `timespec_ex` -- added as `<seconds>.<nanoseconds>`,
+ *     the same as `timespec_ex::to_timestamp()`;
+ * \li anything that can be converted to an `std::string_view`.
+ *
+ * \tparam T  The type of the argument.
+ * \param[in] value  The value to convert.
+ *
+ * \return An object with the data() and size() of this piece.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+template<typename T>
+auto concat_piece(T const & value)
+{
+    if constexpr(std::is_same_v<T, char>)
+    {
+        concat_buffer<1> buffer;
+        buffer.f_buffer[0] = value;
+        buffer.f_end = 1;
+        return buffer;
+    }
+    else if constexpr(std::is_same_v<T, bool>)
+    {
+        return std::string_view(value ? "true" : "false");
+    }
+    else if constexpr(std::is_same_v<T, unsigned __int128>)
+    {
+        concat_buffer<40> buffer;
+        concat_unsigned_integer(buffer, value);
+        return buffer;
+    }
+    else if constexpr(std::is_same_v<T, __int128>)
+    {
+        concat_buffer<41> buffer;
+        concat_unsigned_integer(buffer, value < 0
+                ? -static_cast<unsigned __int128>(value)
+                : static_cast<unsigned __int128>(value));
+        if(value < 0)
+        {
+            --buffer.f_start;
+            buffer.f_buffer[buffer.f_start] = '-';
+        }
+        return buffer;
+    }
+    else if constexpr(std::is_integral_v<T>)
+    {
+        concat_buffer<24> buffer;
+        buffer.f_end = std::to_chars(buffer.f_buffer, buffer.f_buffer + sizeof(buffer.f_buffer), value).ptr
+                     - buffer.f_buffer;
+        return buffer;
+    }
+    else if constexpr(std::is_floating_point_v<T>)
+    {
+        concat_buffer<64> buffer;
+        buffer.f_end = std::to_chars(buffer.f_buffer, buffer.f_buffer + sizeof(buffer.f_buffer), value).ptr
+                     - buffer.f_buffer;
+        return buffer;
+    }
+    else if constexpr(std::is_base_of_v<timespec, T>)
+    {
+        concat_buffer<32> buffer;
+        char * ptr(std::to_chars(buffer.f_buffer, buffer.f_buffer + 21, value.tv_sec).ptr);
+        *ptr = '.';
+        ++ptr;
+        long nsec(value.tv_nsec);
+        for(int idx(8); idx >= 0; --idx)
+        {
+            ptr[idx] = static_cast<char>(nsec % 10 + '0');
+            nsec /= 10;
+        }
+        buffer.f_end = ptr + 9 - buffer.f_buffer;
+        return buffer;
+    }
+    else
+    {
+        static_assert(std::is_convertible_v<T const &, std::string_view>
+                    , "concat_to_string() does not support this type of parameter");
+        return std::string_view(value);
+    }
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Append all the pieces to the output string.
+ *
+ * This function computes the total size of the pieces, reserves the
+ * necessary space in \p str and then appends each piece.
+ *
+ * \tparam StringT  The type of the output string.
+ * \tparam PIECES  The types of the pieces.
+ * \param[in,out] str  The string receiving the pieces.
+ * \param[in] pieces  The pieces to append.
+ */
+template<class StringT, typename ...PIECES>
+void append_pieces(StringT & str, PIECES const & ... pieces)
+{
+    str.reserve(str.length() + (pieces.size() + ... + 0));
+    (str.append(pieces.data(), pieces.size()), ...);
+}
+
+
+} // namespace detail
+
+
+
+/** \brief Append any number of strings and numbers to a string.
+ *
+ * This function appends all the \p args to \p str. The size of the
+ * result is computed first so the string is reallocated at most once.
+ *
+ * See detail::concat_piece() for the list of supported types.
+ *
+ * \tparam StringT  The type of string to append to (i.e. std::string).
+ * \tparam ARGS  The types of the arguments.
+ * \param[in,out] str  The string where the arguments get appended.
+ * \param[in] args  The values to append.
+ *
+ * \return A reference to \p str.
+ */
+template<class StringT, typename ...ARGS>
+StringT & append_to(StringT & str, ARGS const & ... args)
+{
+    detail::append_pieces(str, detail::concat_piece(args)...);
+    return str;
+}
+
+
+/** \brief Concatenate any number of strings and numbers in a new string.
+ *
+ * This function creates a new string with all the \p args concatenated.
+ * The string buffer is allocated exactly once.
+ *
+ * \code
+ *     std::string const s(snapdev::concat_to_string("port: ", 4040));
+ * \endcode
+ *
+ * \tparam StringT  The type of string to return (std::string by default).
+ * \tparam ARGS  The types of the arguments.
+ * \param[in] args  The values to concatenate.
+ *
+ * \return The new string.
+ */
+template<class StringT = std::string, typename ...ARGS>
+StringT concat_to_string(ARGS const & ... args)
+{
+    StringT result;
+    append_to(result, args...);
+    return result;
+}
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
@@ -28,11 +28,22 @@
  *
  * The function will iterate at most n times where n is the minimum size
  * between the two sets and the intersection is the empty set.
+ *
+ * A second version accepts sorted random access containers such as
+ * vectors, spans, and flat sets. It uses sorted_intersection_empty()
+ * which is much faster than walking the nodes of an std::set.
  */
 
+// self
+//
+#include    <snapdev/sorted_intersection.h>
+
+
 // C++
 //
-#include <set>
+#include    <iterator>
+#include    <set>
+#include    <type_traits>
 
 
 
@@ -82,6 +93,29 @@ bool empty_set_intersection(std::set<K, C, A> const & lhs, std::set<K, C, A> con
 }
 
 
+/** \brief Check whether two sorted containers have elements in common.
+ *
+ * This function is the same as the std::set version for containers
+ * with random access iterators (i.e. a sorted std::vector). The
+ * containers must be sorted with std::less and not include duplicates.
+ *
+ * \tparam RangeT  The type of the containers.
+ * \param[in] lhs  Left hand side container.
+ * \param[in] rhs  Right hand side container.
+ *
+ * \return true if the intersection is empty, false otherwise.
+ *
+ * \sa sorted_intersection_empty()
+ */
+template<
+      typename RangeT
+    , std::enable_if_t<std::random_access_iterator<decltype(std::begin(std::declval<RangeT const &>()))>, int> = 0>
+bool empty_set_intersection(RangeT const & lhs, RangeT const & rhs)
+{
+    return sorted_intersection_empty(lhs, rhs);
+}
+
+
 
 } // namespace snapdev
 // vim: ts=4 sw=4 et
@@ -24,49 +24,27 @@
  * characters such as a period (.) using a backslash.
  */
 
+// self
+//
+#include    <snapdev/escaper.h>
+
+
 // C++
 //
-#include    <cstring>
 #include    <string>
-#include    <stdexcept>
 
 
 
 namespace snapdev
 {
 
-namespace
-{
-
 
 
 /** \brief Define the special regex characters.
- *
- * This macro is used so we can pick the largest character at compile time
- * since that gives us a valid sizeof().
- *
- * \note
- * For proper ECMA regex we need to have the `'/'`. Either way, it
- * is probably safer to have it (for someone may also want to create
- * regular expressions to use with a command such as `sed`). We may want
- * to change this parameter with a dynamic one so we can choose the type
- * of regex we are dealing with and whether such and such character is
- * special or not.
- *
- * \warning
- * The characters have to be sorted by their ASCII code.
- */
-#define SNAPDEV_SPECIAL_REGEX_CHARACTERS    "$()*+./?[\\]^{|}"
-
-
-/** \brief List of special regular expression characters.
  *
  * These metacharacters are used in regular expressions with some meaning.
  * If not escaped you may run in some problems.
  *
- * The list is sorted which allows us to break the search as soon as the
- * character `c` is smaller than the current special character.
- *
  * * '$' -- the end character (0x24)
  * * '(' -- the start group (0x28)
  * * ')' -- the end group (0x29)
@@ -82,15 +60,30 @@ namespace
  * * '{' -- the start repeat specification (0x7B)
  * * '|' -- the or operator (0x7C)
  * * '}' -- the end repeat specification (0x7D)
+ *
+ * \note
+ * For proper ECMA regex we need to have the `'/'`. Either way, it
+ * is probably safer to have it (for someone may also want to create
+ * regular expressions to use with a command such as `sed`). We may want
+ * to change this parameter with a dynamic one so we can choose the type
+ * of regex we are dealing with and whether such and such character is
+ * special or not.
  */
-char const * g_special_regex_characters = SNAPDEV_SPECIAL_REGEX_CHARACTERS;
-
-char const g_min_special_regex_character = g_special_regex_characters[0];
-char const g_max_special_regex_character = g_special_regex_characters[sizeof(SNAPDEV_SPECIAL_REGEX_CHARACTERS) - 2];
-
+#define SNAPDEV_SPECIAL_REGEX_CHARACTERS    "$()*+./?[\\]^{|}"
 
 
-} // no name namespace
+/** \brief An escaper for regular expressions.
+ *
+ * This escaper adds a backslash before each one of the
+ * SNAPDEV_SPECIAL_REGEX_CHARACTERS.
+ *
+ * \return A reference to the regular expression escaper.
+ */
+inline escaper const & regex_escaper()
+{
+    static escaper const e(escaper().prefix(SNAPDEV_SPECIAL_REGEX_CHARACTERS));
+    return e;
+}
 
 
 /** \brief Convert a string so it can be used as is in a regular expression.
@@ -100,10 +93,8 @@ char const g_max_special_regex_character = g_special_regex_characters[sizeof(SNA
  * The output can be used as is in a regular expression.
  *
  * \note
- * The function is optimized for speed.
- *
- * Based on function found here:
- * https://stackoverflow.com/questions/39228912/stdregex-escape-special-characters-for-use-in-regex
+ * The function uses the regex_escaper() which computes the exact size
+ * of the output first and copies runs of non-special characters at once.
  *
  * \tparam CharT  The type of character the string uses.
  * \tparam Traits  The traits of the characters.
@@ -119,56 +110,13 @@ template<
     class Allocator = std::allocator<CharT>>
 std::basic_string<CharT, Traits, Allocator> escape_special_regex_characters(std::basic_string<CharT, Traits, Allocator> const & s)
 {
-#ifdef _DEBUG
-    for(char const * r(g_special_regex_characters + 1); *r != '\0'; ++r)
-    {
-        if(r[-1] >= r[0])
-        {
-            throw std::logic_error("g_special_regex_characters characters are not properly sorted."); // LCOV_EXCL_LINE
-        }
-    }
-    if(g_special_regex_characters[0] != g_min_special_regex_character)
-    {
-        throw std::logic_error("g_min_special_regex_character is not the minimum."); // LCOV_EXCL_LINE
-    }
-    if(g_special_regex_characters[strlen(g_special_regex_characters) - 1] != g_max_special_regex_character)
-    {
-        throw std::logic_error( // LCOV_EXCL_LINE
-              "g_max_special_regex_character ("
-            + std::to_string(static_cast<int>(g_max_special_regex_character))
-            + ") is not the maximum (sizeof = "
-            + std::to_string(sizeof(SNAPDEV_SPECIAL_REGEX_CHARACTERS))
-            + ", strlen = "
-            + std::to_string(strlen(g_special_regex_characters))
-            + ").");
-    }
-#endif
-
-    std::string result;
-    result.reserve(s.size() * 2);
-    for(auto const c : s)
-    {
-        if(c >= g_min_special_regex_character
-        && c <= g_max_special_regex_character)
-        {
-            for(char const * r(g_special_regex_characters); *r != '\0'; ++r)
-            {
-                if(*r == c)
-                {
-                    result += '\\';
-                    break;
-                }
-                if(*r > c)
-                {
-                    break;
-                }
-            }
-        }
-        result += c;
-    }
-
+    escaper const & e(regex_escaper());
+    std::string_view const in(s.data(), s.length());
+    std::basic_string<CharT, Traits, Allocator> result;
+    result.resize(e.escaped_size(in));
+    e.escape(in, result.data());
     return result;
-} // LCOV_EXCL_LINE
+}
 
 
 
@@ -0,0 +1,471 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief A table driven string escaper.
+ *
+ * Escaping a string for a regular expression, a shell, JSON, or CSV is
+ * always the same process: most characters are copied as is and a few
+ * are either preceded by an escape character or replaced by a sequence.
+ *
+ * The escaper class defines what to do with each one of the 256 bytes
+ * in a table. The escape() function first computes the exact size of
+ * the output and then copies runs of characters which do not need to
+ * be escaped with memcpy(). When SSE2 is available and the set of
+ * special characters is small enough, those runs are found 16 bytes
+ * at a time.
+ *
+ * \code
+ *     snapdev::escaper e;
+ *     e.prefix("\"\\");
+ *     e.replace('\n', "\\n");
+ *     std::string const quoted('"' + e.escape(str) + '"');
+ * \endcode
+ */
+
+// C++
+//
+#include    <array>
+#include    <cstdint>
+#include    <cstring>
+#include    <stdexcept>
+#include    <string>
+#include    <string_view>
+
+
+// C
+//
+#if defined(__SSE2__)
+#include    <emmintrin.h>
+#endif
+
+
+
+namespace snapdev
+{
+
+
+
+enum class escape_action_t : std::uint8_t
+{
+    ESCAPE_ACTION_PASS,             // copy the character as is
+    ESCAPE_ACTION_PREFIX,           // add the escape character before this character
+    ESCAPE_ACTION_REPLACE,          // replace the character with a sequence
+};
+
+
+
+class escaper
+{
+public:
+    /** \brief Initialize an escaper.
+     *
+     * By default, all the characters are copied as is. Use the prefix()
+     * and replace() functions to define which characters get escaped.
+     *
+     * \param[in] escape  The character added by the prefix() action.
+     */
+    escaper(char escape = '\\')
+        : f_escape(escape)
+    {
+        f_action.fill(escape_action_t::ESCAPE_ACTION_PASS);
+        f_size.fill(1);
+        f_offset.fill(0);
+        compile();
+    }
+
+    /** \brief Copy the specified characters as is.
+     *
+     * This function resets the action of each character in \p characters
+     * to ESCAPE_ACTION_PASS.
+     *
+     * \param[in] characters  The characters to pass through.
+     *
+     * \return A reference to this escaper.
+     */
+    escaper & pass(std::string_view const & characters)
+    {
+        for(char const c : characters)
+        {
+            std::uint8_t const idx(static_cast<std::uint8_t>(c));
+            f_action[idx] = escape_action_t::ESCAPE_ACTION_PASS;
+            f_size[idx] = 1;
+            f_offset[idx] = 0;
+        }
+        compile();
+        return *this;
+    }
+
+    /** \brief Precede the specified characters with the escape character.
+     *
+     * Each character in \p characters gets output preceded by the
+     * escape character defined in the constructor.
+     *
+     * \param[in] characters  The characters to escape.
+     *
+     * \return A reference to this escaper.
+     */
+    escaper & prefix(std::string_view const & characters)
+    {
+        for(char const c : characters)
+        {
+            char const sequence[2] = { f_escape, c };
+            set_sequence(c, escape_action_t::ESCAPE_ACTION_PREFIX, std::string_view(sequence, 2));
+        }
+        compile();
+        return *this;
+    }
+
+    /** \brief Replace a character with a sequence.
+     *
+     * The character \p c gets replaced by \p sequence which can be empty
+     * (i.e. the character gets removed) and up to 255 characters.
+     *
+     * \exception std::length_error
+     * The sequence is more than 255 characters.
+     *
+     * \param[in] c  The character to replace.
+     * \param[in] sequence  The replacement.
+     *
+     * \return A reference to this escaper.
+     */
+    escaper & replace(char c, std::string_view const & sequence)
+    {
+        set_sequence(c, escape_action_t::ESCAPE_ACTION_REPLACE, sequence);
+        compile();
+        return *this;
+    }
+
+    /** \brief Get the action used with character \p c.
+     *
+     * \param[in] c  The character to check.
+     *
+     * \return The action used when \p c is found in the input.
+     */
+    escape_action_t get_action(char c) const
+    {
+        return f_action[static_cast<std::uint8_t>(c)];
+    }
+
+    /** \brief Get the output of character \p c.
+     *
+     * \param[in] c  The character to check.
+     *
+     * \return The sequence output when \p c is found in the input.
+     */
+    std::string get_sequence(char c) const
+    {
+        std::uint8_t const idx(static_cast<std::uint8_t>(c));
+        if(f_action[idx] == escape_action_t::ESCAPE_ACTION_PASS)
+        {
+            return std::string(1, c);
+        }
+        return f_sequences.substr(f_offset[idx], f_size[idx]);
+    }
+
+    /** \brief Check whether the scanning is vectorized.
+     *
+     * The scanning of characters which do not need to be escaped uses
+     * SSE2 when available and the special characters are a range at the
+     * start, a range at the end, and up to 16 other characters.
+     *
+     * \return true if escape() scans 16 characters at a time.
+     */
+    bool is_vectorized() const
+    {
+        return f_vectorized;
+    }
+
+    /** \brief Compute the exact size of the escaped string.
+     *
+     * \param[in] s  The string to escape.
+     *
+     * \return The size of the output of escape().
+     */
+    std::size_t escaped_size(std::string_view const & s) const
+    {
+        std::size_t size(s.length());
+        char const * end(s.data() + s.length());
+        for(char const * ptr(find_special(s.data(), end)); ptr < end; ptr = find_special(ptr + 1, end))
+        {
+            size = size - 1 + f_size[static_cast<std::uint8_t>(*ptr)];
+        }
+        return size;
+    }
+
+    /** \brief Escape a string to a caller buffer.
+     *
+     * The \p out buffer must be at least escaped_size() characters.
+     * No '\0' is added.
+     *
+     * \param[in] s  The string to escape.
+     * \param[out] out  The output buffer.
+     *
+     * \return A pointer after the last character written.
+     */
+    char * escape(std::string_view const & s, char * out) const
+    {
+        char const * ptr(s.data());
+        char const * const end(ptr + s.length());
+        for(;;)
+        {
+            char const * const special(find_special(ptr, end));
+            std::size_t const run(special - ptr);
+            if(run != 0)
+            {
+                memcpy(out, ptr, run);
+                out += run;
+            }
+            if(special >= end)
+            {
+                return out;
+            }
+            std::uint8_t const idx(static_cast<std::uint8_t>(*special));
+            memcpy(out, f_sequences.data() + f_offset[idx], f_size[idx]);
+            out += f_size[idx];
+            ptr = special + 1;
+        }
+    }
+
+    /** \brief Append an escaped string.
+     *
+     * The output string is resized once to its final size.
+     *
+     * \param[in] s  The string to escape.
+     * \param[in,out] out  The string receiving the escaped \p s.
+     *
+     * \return A reference to \p out.
+     */
+    std::string & escape_append(std::string_view const & s, std::string & out) const
+    {
+        std::size_t const start(out.length());
+        out.resize(start + escaped_size(s));
+        escape(s, out.data() + start);
+        return out;
+    }
+
+    /** \brief Escape a string.
+     *
+     * \param[in] s  The string to escape.
+     *
+     * \return The escaped string.
+     */
+    std::string escape(std::string_view const & s) const
+    {
+        std::string result;
+        escape_append(s, result);
+        return result;
+    }
+
+private:
+    void set_sequence(char c, escape_action_t action, std::string_view const & sequence)
+    {
+        if(sequence.length() > 255)
+        {
+            throw std::length_error("escaper sequences are limited to 255 characters.");
+        }
+        std::uint8_t const idx(static_cast<std::uint8_t>(c));
+        f_action[idx] = action;
+        f_size[idx] = static_cast<std::uint8_t>(sequence.length());
+        std::string::size_type pos(f_sequences.find(sequence));
+        if(pos == std::string::npos)
+        {
+            pos = f_sequences.length();
+            f_sequences += sequence;
+        }
+        f_offset[idx] = static_cast<std::uint32_t>(pos);
+    }
+
+    /** \brief Prepare the vectorized scanning.
+     *
+     * The special characters are viewed as a range starting at 0 (i.e.
+     * controls), a range ending at 255, and a list of other characters.
+     * When the list has 16 characters or less, the scanning can be
+     * done with SSE2 comparisons.
+     */
+    void compile()
+    {
+        f_low = 0;
+        while(f_low < 256
+           && f_action[f_low] != escape_action_t::ESCAPE_ACTION_PASS)
+        {
+            ++f_low;
+        }
+        f_high = 256;
+        while(f_high > f_low
+           && f_action[f_high - 1] != escape_action_t::ESCAPE_ACTION_PASS)
+        {
+            --f_high;
+        }
+
+        f_special_count = 0;
+        f_vectorized = false;
+        if(f_low == 256)
+        {
+            return;
+        }
+        for(int idx(f_low); idx < f_high; ++idx)
+        {
+            if(f_action[idx] != escape_action_t::ESCAPE_ACTION_PASS)
+            {
+                if(f_special_count >= f_special.size())
+                {
+                    return;
+                }
+                f_special[f_special_count] = static_cast<char>(idx);
+                ++f_special_count;
+            }
+        }
+#if defined(__SSE2__)
+        f_vectorized = true;
+#endif
+    }
+
+    /** \brief Find the next character which needs to be escaped.
+     *
+     * \param[in] ptr  The start of the string to search.
+     * \param[in] end  The end of the string.
+     *
+     * \return A pointer to the next special character or \p end.
+     */
+    char const * find_special(char const * ptr, char const * end) const
+    {
+#if defined(__SSE2__)
+        if(f_vectorized && end - ptr >= 16)
+        {
+            // compare unsigned bytes using signed comparisons
+            //
+            __m128i const bias(_mm_set1_epi8(static_cast<char>(0x80)));
+            __m128i const low(_mm_set1_epi8(static_cast<char>(f_low ^ 0x80)));
+            __m128i const high(_mm_set1_epi8(static_cast<char>((f_high - 1) ^ 0x80)));
+            __m128i special[16];
+            for(std::size_t idx(0); idx < f_special_count; ++idx)
+            {
+                special[idx] = _mm_set1_epi8(f_special[idx]);
+            }
+            do
+            {
+                __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(ptr)));
+                __m128i const b(_mm_xor_si128(v, bias));
+                __m128i found(_mm_or_si128(_mm_cmplt_epi8(b, low), _mm_cmpgt_epi8(b, high)));
+                for(std::size_t idx(0); idx < f_special_count; ++idx)
+                {
+                    found = _mm_or_si128(found, _mm_cmpeq_epi8(v, special[idx]));
+                }
+                int const mask(_mm_movemask_epi8(found));
+                if(mask != 0)
+                {
+                    return ptr + __builtin_ctz(mask);
+                }
+                ptr += 16;
+            }
+            while(end - ptr >= 16);
+        }
+#endif
+        while(ptr < end
+           && f_action[static_cast<std::uint8_t>(*ptr)] == escape_action_t::ESCAPE_ACTION_PASS)
+        {
+            ++ptr;
+        }
+        return ptr;
+    }
+
+    char                                f_escape = '\\';
+    std::array<escape_action_t, 256>    f_action = {};
+    std::array<std::uint8_t, 256>       f_size = {};
+    std::array<std::uint32_t, 256>      f_offset = {};
+    std::string                         f_sequences = std::string();
+    int                                 f_low = 0;
+    int                                 f_high = 256;
+    std::array<char, 16>                f_special = {};
+    std::size_t                         f_special_count = 0;
+    bool                                f_vectorized = false;
+};
+
+
+
+/** \brief An escaper for JSON strings.
+ *
+ * The double quote and backslash get escaped, the controls are replaced
+ * by their short form (i.e. "\n") or a "\u00XX" sequence. The output
+ * does not include the double quotes around the string.
+ *
+ * \return A reference to the JSON escaper.
+ */
+inline escaper const & json_escaper()
+{
+    static escaper const e([]()
+        {
+            escaper r;
+            r.prefix("\"\\");
+            for(int c(0); c < 0x20; ++c)
+            {
+                char const sequence[7] = {
+                    '\\', 'u', '0', '0',
+                    "0123456789ABCDEF"[c >> 4],
+                    "0123456789ABCDEF"[c & 15],
+                    '\0',
+                };
+                r.replace(static_cast<char>(c), sequence);
+            }
+            r.replace('\b', "\\b");
+            r.replace('\f', "\\f");
+            r.replace('\n', "\\n");
+            r.replace('\r', "\\r");
+            r.replace('\t', "\\t");
+            return r;
+        }());
+    return e;
+}
+
+
+/** \brief An escaper for CSV fields.
+ *
+ * The double quotes get doubled. The output does not include the double
+ * quotes around the field.
+ *
+ * \return A reference to the CSV escaper.
+ */
+inline escaper const & csv_escaper()
+{
+    static escaper const e(escaper().replace('"', "\"\""));
+    return e;
+}
+
+
+/** \brief An escaper for shell arguments.
+ *
+ * The shell metacharacters and spaces get escaped with a backslash.
+ * Since a backslash followed by a newline is removed by the shell, the
+ * newline is replaced by a quoted newline instead.
+ *
+ * \return A reference to the shell escaper.
+ */
+inline escaper const & shell_escaper()
+{
+    static escaper const e(escaper()
+            .prefix(" \t!\"#$&'()*,;<=>?[\\]^`{|}~")
+            .replace('\n', "'\n'"));
+    return e;
+}
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
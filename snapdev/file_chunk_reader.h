@@ -0,0 +1,429 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Read a file one chunk or one line at a time.
+ *
+ * The file_contents class loads an entire file in memory. For files
+ * larger than memory (i.e. logs), the file_chunk_reader reads the file
+ * in blocks of a fixed size. The same buffers get reused for each block
+ * so the amount of memory used does not depend on the size of the file.
+ *
+ * The reader can also return the file one line at a time. A line which
+ * straddles two blocks gets copied in a separate buffer so the caller
+ * always sees complete lines.
+ *
+ * With the read-ahead option, a thread reads the next block while the
+ * caller processes the current one (double buffering).
+ *
+ * \code
+ *     snapdev::file_chunk_reader in("/var/log/syslog");
+ *     std::string_view line;
+ *     while(in.next_line(line))
+ *     {
+ *         ...
+ *     }
+ *     if(!in.last_error().empty())
+ *     {
+ *         std::cerr << in.last_error() << "\n";
+ *     }
+ * \endcode
+ */
+
+// self
+//
+#include    <snapdev/concat_to_string.h>
+#include    <snapdev/raii_generic_deleter.h>
+
+
+// C++
+//
+#include    <condition_variable>
+#include    <mutex>
+#include    <stdexcept>
+#include    <string>
+#include    <string_view>
+#include    <thread>
+
+
+// C
+//
+#include    <fcntl.h>
+#include    <unistd.h>
+
+
+
+namespace snapdev
+{
+
+
+
+class file_chunk_reader
+{
+public:
+    /** \brief The default size of one chunk.
+     *
+     * The reader allocates one buffer of this size, or two when the
+     * read-ahead is turned on.
+     */
+    static constexpr std::size_t const DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /** \brief Initialize a chunk reader.
+     *
+     * The file gets opened on the first call to next_chunk() or
+     * next_line().
+     *
+     * \exception std::invalid_argument
+     * The \p filename parameter cannot be an empty string and the
+     * \p chunk_size cannot be zero.
+     *
+     * \param[in] filename  The name of the file to read.
+     * \param[in] chunk_size  The size of one chunk in bytes.
+     * \param[in] read_ahead  Whether to read the next chunk in a thread.
+     */
+    file_chunk_reader(
+              std::string const & filename
+            , std::size_t chunk_size = DEFAULT_CHUNK_SIZE
+            , bool read_ahead = false)
+        : f_filename(filename)
+        , f_chunk_size(chunk_size)
+        , f_read_ahead(read_ahead)
+    {
+        if(f_filename.empty())
+        {
+            throw std::invalid_argument("snapdev::file_chunk_reader: the filename of a file_chunk_reader object cannot be the empty string.");
+        }
+        if(f_chunk_size == 0)
+        {
+            throw std::invalid_argument("snapdev::file_chunk_reader: the chunk size cannot be zero.");
+        }
+    }
+
+    file_chunk_reader(file_chunk_reader const &) = delete;
+
+    /** \brief Stop the read-ahead thread.
+     *
+     * If the read-ahead thread is still running, it gets stopped and
+     * joined.
+     */
+    ~file_chunk_reader()
+    {
+        if(f_thread.joinable())
+        {
+            {
+                std::lock_guard lock(f_mutex);
+                f_stop = true;
+            }
+            f_condition.notify_all();
+            f_thread.join();
+        }
+    }
+
+    file_chunk_reader & operator = (file_chunk_reader const &) = delete;
+
+    std::string const & filename() const
+    {
+        return f_filename;
+    }
+
+    std::size_t chunk_size() const
+    {
+        return f_chunk_size;
+    }
+
+    /** \brief Get the next chunk of the file.
+     *
+     * The chunk is \p chunk_size bytes except for the last one which
+     * may be smaller. The view remains valid until the next call to
+     * next_chunk() or next_line().
+     *
+     * Do not mix calls to next_chunk() and next_line() on the same
+     * reader since next_line() keeps the end of the current chunk
+     * for the following lines.
+     *
+     * \param[out] chunk  The view of the next chunk.
+     *
+     * \return true if a chunk was read, false at the end of the file or
+     * on an error (see last_error()).
+     */
+    bool next_chunk(std::string_view & chunk)
+    {
+        if(!open())
+        {
+            return false;
+        }
+
+        if(f_read_ahead)
+        {
+            return next_read_ahead_chunk(chunk);
+        }
+
+        f_buffers[0].resize(f_chunk_size);
+        ssize_t const r(read_fully(f_fd.get(), f_buffers[0].data(), f_chunk_size));
+        if(r < 0)
+        {
+            set_read_error();
+            return false;
+        }
+        if(r == 0)
+        {
+            return false;
+        }
+        chunk = std::string_view(f_buffers[0].data(), r);
+        return true;
+    }
+
+    /** \brief Get the next line of the file.
+     *
+     * The line does not include the '\\n' character. The last line
+     * of the file is returned even if it does not end with a '\\n'.
+     *
+     * A line found within one chunk is a view of the chunk buffer.
+     * A line which straddles two or more chunks gets copied in a
+     * separate buffer which is reused for all such lines, so only lines
+     * longer than the chunk size make the memory use grow.
+     *
+     * The view remains valid until the next call to next_line().
+     *
+     * \param[out] line  The view of the next line.
+     *
+     * \return true if a line was read, false at the end of the file or
+     * on an error (see last_error()).
+     */
+    bool next_line(std::string_view & line)
+    {
+        f_carry.clear();
+        for(;;)
+        {
+            std::string_view::size_type const pos(f_pending.find('\n'));
+            if(pos != std::string_view::npos)
+            {
+                if(f_carry.empty())
+                {
+                    line = f_pending.substr(0, pos);
+                }
+                else
+                {
+                    f_carry.append(f_pending.substr(0, pos));
+                    line = f_carry;
+                }
+                f_pending.remove_prefix(pos + 1);
+                return true;
+            }
+
+            // the line continues in the next chunk, keep what we have
+            //
+            f_carry.append(f_pending);
+            f_pending = std::string_view();
+
+            std::string_view chunk;
+            if(!next_chunk(chunk))
+            {
+                if(f_carry.empty() || !f_error.empty())
+                {
+                    return false;
+                }
+                line = f_carry;
+                return true;
+            }
+            f_pending = chunk;
+        }
+    }
+
+    /** \brief Retrieve the last error message.
+     *
+     * When next_chunk() or next_line() return false, this function
+     * returns an empty string if the end of the file was reached and
+     * an error message otherwise.
+     *
+     * \return The last error generated.
+     */
+    std::string const & last_error() const
+    {
+        return f_error;
+    }
+
+private:
+    bool open()
+    {
+        if(f_fd != nullptr)
+        {
+            return true;
+        }
+        if(f_opened)
+        {
+            // the open() failed, do not try again
+            //
+            return false;
+        }
+        f_opened = true;
+
+        f_fd.reset(::open(f_filename.c_str(), O_RDONLY | O_CLOEXEC));
+        if(f_fd == nullptr)
+        {
+            f_error = concat_to_string(
+                      "could not open file \""
+                    , f_filename
+                    , "\" for reading.");
+            return false;
+        }
+        posix_fadvise(f_fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        if(f_read_ahead)
+        {
+            f_buffers[0].resize(f_chunk_size);
+            f_buffers[1].resize(f_chunk_size);
+            f_thread = std::thread(&file_chunk_reader::read_ahead, this);
+        }
+        return true;
+    }
+
+    void set_read_error()
+    {
+        f_error = concat_to_string(
+                  "an I/O error occurred reading \""
+                , f_filename
+                , "\".");
+    }
+
+    /** \brief The read-ahead thread.
+     *
+     * The thread fills the two buffers one after the other. It waits
+     * for the caller to be done with a buffer before filling it again.
+     * A size of 0 marks the end of the file and -1 an error.
+     */
+    void read_ahead()
+    {
+        for(int idx(0);; idx ^= 1)
+        {
+            {
+                std::unique_lock lock(f_mutex);
+                f_condition.wait(lock, [this, idx]()
+                    {
+                        return f_stop || !f_ready[idx];
+                    });
+                if(f_stop)
+                {
+                    return;
+                }
+            }
+
+            ssize_t const r(read_fully(f_fd.get(), f_buffers[idx].data(), f_chunk_size));
+
+            {
+                std::lock_guard lock(f_mutex);
+                f_sizes[idx] = r;
+                f_ready[idx] = true;
+            }
+            f_condition.notify_all();
+
+            if(r <= 0)
+            {
+                return;
+            }
+        }
+    }
+
+    bool next_read_ahead_chunk(std::string_view & chunk)
+    {
+        ssize_t size(0);
+        {
+            std::unique_lock lock(f_mutex);
+
+            // give the previous buffer back to the read-ahead thread
+            //
+            if(f_holding)
+            {
+                f_ready[f_current ^ 1] = false;
+                f_condition.notify_all();
+            }
+
+            f_condition.wait(lock, [this]()
+                {
+                    return f_ready[f_current];
+                });
+            size = f_sizes[f_current];
+            if(size <= 0)
+            {
+                // keep f_ready[] set so we return false again
+                //
+                f_holding = false;
+                if(size < 0)
+                {
+                    set_read_error();
+                }
+                return false;
+            }
+            f_holding = true;
+        }
+
+        chunk = std::string_view(f_buffers[f_current].data(), size);
+        f_current ^= 1;
+        return true;
+    }
+
+    static ssize_t read_fully(int fd, char * buffer, std::size_t size)
+    {
+        std::size_t pos(0);
+        while(pos < size)
+        {
+            ssize_t const r(::read(fd, buffer + pos, size - pos));
+            if(r < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+            if(r == 0)
+            {
+                break;
+            }
+            pos += r;
+        }
+        return pos;
+    }
+
+    std::string                 f_filename = std::string();
+    std::size_t                 f_chunk_size = DEFAULT_CHUNK_SIZE;
+    bool                        f_read_ahead = false;
+    bool                        f_opened = false;
+    raii_fd_t                   f_fd = raii_fd_t();
+    std::string                 f_error = std::string();
+    std::string                 f_buffers[2] = {};
+    std::string                 f_carry = std::string();
+    std::string_view            f_pending = std::string_view();
+
+    // read-ahead
+    //
+    std::thread                 f_thread = std::thread();
+    std::mutex                  f_mutex = std::mutex();
+    std::condition_variable     f_condition = std::condition_variable();
+    ssize_t                     f_sizes[2] = { 0, 0 };
+    bool                        f_ready[2] = { false, false };
+    bool                        f_stop = false;
+    bool                        f_holding = false;
+    int                         f_current = 0;
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
@@ -26,18 +26,29 @@
 
 // self
 //
+#include    <snapdev/concat_to_string.h>
 #include    <snapdev/mkdir_p.h>
+#include    <snapdev/pathinfo.h>
+#include    <snapdev/raii_generic_deleter.h>
 
 
 // C++
 //
+#include    <algorithm>
+#include    <atomic>
 #include    <fstream>
 #include    <iostream>
 #include    <ios>
+#include    <memory>
+#include    <set>
+#include    <vector>
 
 
 // C
 //
+#include    <fcntl.h>
+#include    <stdlib.h>
+#include    <sys/stat.h>
 #include    <unistd.h>
 
 
@@ -47,6 +58,295 @@ namespace snapdev
 
 
 
+namespace detail
+{
+
+
+/** \brief Counter used to generate unique temporary filenames.
+ *
+ * The counter is combined with the process identifier so two threads
+ * or two processes writing the same file use different temporary files.
+ */
+inline std::atomic<std::uint32_t> g_atomic_file_counter = 0;
+
+
+/** \brief Write a file atomically.
+ *
+ * The data is written to a temporary file created in the same directory
+ * as the destination. Once the data is written (and optionally synced),
+ * the temporary file is renamed over the destination. A reader (or a
+ * crash) sees either the old or the new contents, never a mix of both.
+ *
+ * If the destination is a symbolic link, the file it points to gets
+ * replaced and the link is kept. If the destination already exists,
+ * its permissions are copied to the new file. Its ownership is copied
+ * too when the process is allowed to do so (i.e. running as root or
+ * the owner changing the group to one of its own groups); otherwise
+ * the new file belongs to the process.
+ *
+ * If the object gets destroyed before rename() is called, the temporary
+ * file is deleted.
+ */
+class atomic_file_writer
+{
+public:
+    atomic_file_writer(std::string const & filename)
+        : f_filename(filename)
+    {
+    }
+
+    atomic_file_writer(atomic_file_writer const &) = delete;
+
+    ~atomic_file_writer()
+    {
+        abandon();
+    }
+
+    atomic_file_writer & operator = (atomic_file_writer const &) = delete;
+
+    std::string const & filename() const
+    {
+        return f_filename;
+    }
+
+    /** \brief The file which gets replaced.
+     *
+     * This is the filename with symbolic links resolved. It is only
+     * defined once write() was called.
+     *
+     * \return The name of the file which gets replaced.
+     */
+    std::string const & target() const
+    {
+        return f_target;
+    }
+
+    /** \brief Create the temporary file and write the data in it.
+     *
+     * \param[in] data  The data to write.
+     * \param[in] size  The number of bytes to write.
+     *
+     * \return true if the temporary file was created and written.
+     */
+    bool write(char const * data, std::size_t size)
+    {
+        // replace the file a symbolic link points to, not the link
+        //
+        f_target = f_filename;
+        struct stat st = {};
+        if(lstat(f_filename.c_str(), &st) == 0
+        && S_ISLNK(st.st_mode))
+        {
+            char * real(realpath(f_filename.c_str(), nullptr));
+            if(real != nullptr)
+            {
+                f_target = real;
+                free(real);
+            }
+        }
+
+        for(int retry(0);; ++retry)
+        {
+            f_temporary = concat_to_string(
+                      f_target
+                    , ".tmp-"
+                    , getpid()
+                    , '-'
+                    , ++g_atomic_file_counter);
+            f_fd.reset(::open(f_temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666));
+            if(f_fd != nullptr)
+            {
+                break;
+            }
+            if(errno != EEXIST || retry >= 100)
+            {
+                f_error = concat_to_string(
+                          "could not open file \""
+                        , f_filename
+                        , "\" for writing.");
+                f_temporary.clear();
+                return false;
+            }
+        }
+
+        if(stat(f_target.c_str(), &st) == 0)
+        {
+            if(fchown(f_fd.get(), st.st_uid, st.st_gid) != 0)
+            {
+                // keep the ownership of the process if not allowed
+            }
+            fchmod(f_fd.get(), st.st_mode & 07777);
+        }
+
+        std::size_t pos(0);
+        while(pos < size)
+        {
+            ssize_t const r(::write(f_fd.get(), data + pos, size - pos));
+            if(r < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;                                       // LCOV_EXCL_LINE
+                }
+                f_error = concat_to_string(                         // LCOV_EXCL_LINE
+                          "could not write "                        // LCOV_EXCL_LINE
+                        , size                                      // LCOV_EXCL_LINE
+                        , " bytes to \""                            // LCOV_EXCL_LINE
+                        , f_filename                                // LCOV_EXCL_LINE
+                        , "\".");                                   // LCOV_EXCL_LINE
+                abandon();                                          // LCOV_EXCL_LINE
+                return false;                                       // LCOV_EXCL_LINE
+            }
+            pos += r;
+        }
+
+        return true;
+    }
+
+    /** \brief Ask the kernel to start writing the data to disk.
+     *
+     * This function does not wait. It is used to queue the writes of
+     * many files before waiting on them with sync().
+     */
+    void start_sync()
+    {
+        if(f_fd != nullptr)
+        {
+            sync_file_range(f_fd.get(), 0, 0, SYNC_FILE_RANGE_WRITE);
+        }
+    }
+
+    /** \brief Close the temporary file.
+     *
+     * Once written, the temporary file does not need to remain open.
+     * Closing it limits the number of file descriptors used by a batch
+     * of many files. The sync() function reopens the file as required.
+     */
+    void close()
+    {
+        f_fd.reset();
+    }
+
+    /** \brief Wait for the data to be on disk.
+     *
+     * If the temporary file was closed, it gets reopened in read-only
+     * mode; fdatasync() flushes the data of the file, not just the data
+     * written through that file descriptor.
+     *
+     * \return true if fdatasync() succeeded.
+     */
+    bool sync()
+    {
+        if(f_fd == nullptr
+        && !f_temporary.empty())
+        {
+            f_fd.reset(::open(f_temporary.c_str(), O_RDONLY | O_CLOEXEC));
+        }
+        if(f_fd == nullptr || fdatasync(f_fd.get()) != 0)
+        {
+            f_error = concat_to_string(
+                      "could not sync \""
+                    , f_filename
+                    , "\" to disk.");
+            return false;
+        }
+        return true;
+    }
+
+    /** \brief Replace the destination with the temporary file.
+     *
+     * \return true if the rename() succeeded.
+     */
+    bool rename()
+    {
+        f_fd.reset();
+        if(f_temporary.empty()
+        || ::rename(f_temporary.c_str(), f_target.c_str()) != 0)
+        {
+            f_error = concat_to_string(
+                      "could not rename temporary file to \""
+                    , f_filename
+                    , "\".");
+            abandon();
+            return false;
+        }
+        f_temporary.clear();
+        return true;
+    }
+
+    /** \brief Delete the temporary file, if any.
+     */
+    void abandon()
+    {
+        f_fd.reset();
+        if(!f_temporary.empty())
+        {
+            unlink(f_temporary.c_str());
+            f_temporary.clear();
+        }
+    }
+
+    std::string const & last_error() const
+    {
+        return f_error;
+    }
+
+private:
+    std::string         f_filename = std::string();
+    std::string         f_target = std::string();
+    std::string         f_temporary = std::string();
+    raii_fd_t           f_fd = raii_fd_t();
+    std::string         f_error = std::string();
+};
+
+
+/** \brief Sync the directory of a file.
+ *
+ * After a rename(), the directory itself needs to be synced for the
+ * new name to survive a crash.
+ *
+ * \param[in] directory  The directory to sync.
+ * \param[out] error  The error message if the function fails.
+ *
+ * \return true if the directory was synced.
+ */
+inline bool sync_directory(std::string const & directory, std::string & error)
+{
+    raii_fd_t fd(::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if(fd == nullptr
+    || fsync(fd.get()) != 0)
+    {
+        error = concat_to_string(
+                  "could not sync directory \""
+                , directory
+                , "\".");
+        return false;
+    }
+    return true;
+}
+
+
+/** \brief Get the directory to sync after renaming \p filename.
+ *
+ * \param[in] filename  The name of the file.
+ *
+ * \return The directory of \p filename or "." if it has no directory.
+ */
+inline std::string directory_of(std::string const & filename)
+{
+    std::string const directory(pathinfo::dirname(filename));
+    if(directory.empty())
+    {
+        return ".";
+    }
+    return directory;
+}
+
+
+} // namespace detail
+
+
+
 class file_contents
 {
 public:
@@ -87,6 +387,54 @@ public:
     };
 
 
+    /** \brief Define the way the write_all() function saves the file.
+     *
+     * By default, the file is truncated and rewritten in place. If the
+     * process crashes while writing, the file is left partially written.
+     */
+    enum write_mode_t
+    {
+        /** \brief Truncate and rewrite the file in place.
+         *
+         * This mode is the default. It is the fastest but other processes
+         * may read a partial file and a crash leaves a torn file behind.
+         */
+        WRITE_MODE_TRUNCATE,
+
+        /** \brief Write a temporary file and rename it.
+         *
+         * The data is written in a temporary file in the same directory
+         * which then gets renamed over the destination. Readers see the
+         * old or the new contents, never a partial file. The data is not
+         * synced so after a power failure the file may be empty or
+         * still have its old contents.
+         *
+         * Since the file gets replaced, a new inode is used. If the
+         * destination is a symbolic link, the file it points to gets
+         * replaced and the link remains. The permissions of the old file
+         * are kept. Its owner and group are kept only if the process is
+         * allowed to set them, otherwise the file now belongs to the
+         * process. Hard links to the old file keep the old contents.
+         */
+        WRITE_MODE_ATOMIC,
+
+        /** \brief Write a temporary file, sync it, and rename it.
+         *
+         * This is the WRITE_MODE_ATOMIC mode with the temporary file
+         * synced with fdatasync() before the rename() and the directory
+         * synced after. Once write_all() returns true, the new contents
+         * survives a power failure.
+         *
+         * The file is replaced in the same way as with WRITE_MODE_ATOMIC
+         * so the same remarks about links and ownership apply.
+         *
+         * To save many files, the file_contents_batch is much faster
+         * since it syncs all the files together.
+         */
+        WRITE_MODE_DURABLE,
+    };
+
+
     /** \brief Initialize a content file.
      *
      * The constructor initialize the file content object with a filename.
@@ -230,6 +578,29 @@ public:
     }
 
 
+    /** \brief Change the write mode.
+     *
+     * This function defines how write_all() saves the file. By default
+     * the mode is write_mode_t::WRITE_MODE_TRUNCATE.
+     *
+     * \param[in] mode  The new write mode.
+     */
+    void write_mode(write_mode_t mode)
+    {
+        f_write_mode = mode;
+    }
+
+
+    /** \brief Retrieve the current write mode.
+     *
+     * \return The current write mode of this file_contents object.
+     */
+    write_mode_t write_mode() const
+    {
+        return f_write_mode;
+    }
+
+
     /** \brief Read the entire file in a buffer.
      *
      * This function reads the entire file in memory. It saves the data
@@ -237,6 +608,19 @@ public:
      * The file can be binary in which case remember that c_str()
      * and other similar function will not work right.
      *
+     * The file is read with the POSIX read() function directly in the
+     * contents buffer. In SIZE_MODE_SEEK mode, the size is retrieved
+     * with fstat() and the buffer allocated once. When the file is not
+     * a regular file or its size is reported as zero (i.e. "/proc/..."
+     * files), the function switches to the SIZE_MODE_READ mode where
+     * the buffer grows geometrically until the end of the file is
+     * reached.
+     *
+     * The buffer is not zero-filled before the data gets read in it.
+     * When the C++ library does not offer
+     * std::string::resize_and_overwrite(), the data is read in a
+     * default initialized buffer and then appended to the contents.
+     *
      * The function may return false if the file could not be opened or
      * read in full.
      *
@@ -250,81 +634,81 @@ public:
     {
         // try to open the file
         //
-        std::ifstream in;
-        in.open(f_filename, std::ios::in | std::ios::binary);
-        if(!in.is_open())
+        raii_fd_t fd(::open(f_filename.c_str(), O_RDONLY | O_CLOEXEC));
+        if(fd == nullptr)
         {
-            f_error = "could not open file \""
-                + f_filename
-                + "\" for reading.";
+            f_error = concat_to_string(
+                      "could not open file \""
+                    , f_filename
+                    , "\" for reading.");
             return false;
         }
 
         // get size
         //
-        std::ifstream::pos_type size(0);
+        struct stat st = {};
         size_mode_t mode(size_mode());
         if(mode == size_mode_t::SIZE_MODE_SEEK)
         {
-            in.seekg(0, std::ios::end);
-            size = in.tellg();
-            in.seekg(0, std::ios::beg);
-            if(std::ifstream::pos_type(-1) == size)
+            if(fstat(fd.get(), &st) != 0
+            || !S_ISREG(st.st_mode)
+            || st.st_size == 0)
             {
-                // try again in READ mode
+                // on certain files, the "get size" fails (i.e. "/proc/...",
+                // FIFO, socket, etc.)
                 //
                 mode = size_mode_t::SIZE_MODE_READ;
-                in.clear();
             }
         }
 
-        if(mode == size_mode_t::SIZE_MODE_READ)
+        posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        f_contents.clear();
+        ssize_t r(0);
+        std::size_t requested(0);
+        try
         {
-            // on certain files, the "get size" fails (i.e. "/proc/...",
-            // FIFO, socket, etc.)
-            //
-            f_contents.clear();
-            char buf[1024 * 16];
-            do
+            if(mode == size_mode_t::SIZE_MODE_READ)
             {
-                in.read(buf, sizeof(buf));
-                ssize_t sz(in.gcount());
-                if(sz <= 0)
+                // double the buffer each time it gets filled up
+                //
+                for(;;)
                 {
-                    break; // LCOV_EXCL_LINE
+                    std::size_t const size(std::max(READ_BUFFER_SIZE, f_contents.size()));
+                    requested = f_contents.size() + size;
+                    r = append_from(fd.get(), size);
+                    if(r < 0 || static_cast<std::size_t>(r) < size)
+                    {
+                        break;
+                    }
                 }
-                f_contents.insert(f_contents.end(), buf, buf + sz);
             }
-            while(in.good());
-        }
-        else
-        {
-            // resize the buffer accordingly
-            //
-            try
+            else
             {
-                f_contents.resize(size, '\0');
+                // a file which gets truncated while we read it is not
+                // an error, we just get less data
+                //
+                requested = st.st_size;
+                r = append_from(fd.get(), st.st_size);
             }
-            catch(std::bad_alloc const & e)                         // LCOV_EXCL_LINE
-            {
-                f_error = "cannot allocate buffer of "              // LCOV_EXCL_LINE
-                    + std::to_string(size)                          // LCOV_EXCL_LINE
-                    + " bytes to read file.";                       // LCOV_EXCL_LINE
-                f_contents.clear();                                 // LCOV_EXCL_LINE
-                return false;                                       // LCOV_EXCL_LINE
-            } // LCOV_EXCL_LINE
-
-            // read the data
-            //
-            in.read(f_contents.data(), size);
         }
-
-        if(in.bad()) // eof() always true, fail() may be true too (in case we can't gather the size() above)
+        catch(std::bad_alloc const & e)                         // LCOV_EXCL_LINE
         {
-            f_error = "an I/O error occurred reading \""        // LCOV_EXCL_LINE
-                + f_filename                                    // LCOV_EXCL_LINE
-                + "\".";                                        // LCOV_EXCL_LINE
+            f_error = concat_to_string(                         // LCOV_EXCL_LINE
+                      "cannot allocate buffer of "              // LCOV_EXCL_LINE
+                    , requested                                 // LCOV_EXCL_LINE
+                    , " bytes to read file.");                  // LCOV_EXCL_LINE
+            f_contents.clear();                                 // LCOV_EXCL_LINE
             return false;                                       // LCOV_EXCL_LINE
+        } // LCOV_EXCL_LINE
+
+        if(r < 0)
+        {
+            f_error = concat_to_string(
+                      "an I/O error occurred reading \""
+                    , f_filename
+                    , "\".");
+            return false;
         }
 
         f_error.clear();
@@ -365,6 +749,7 @@ public:
      * \sa contents(std::string const & new_contents)
      * \sa read_all()
      * \sa last_error()
+     * \sa write_mode()
      */
     bool write_all(std::string const & filename = std::string())
     {
@@ -372,15 +757,21 @@ public:
         //
         std::string const name(filename.empty() ? f_filename : filename);
 
+        if(f_write_mode != write_mode_t::WRITE_MODE_TRUNCATE)
+        {
+            return write_atomically(name);
+        }
+
         // try to open the file
         //
         std::ofstream out;
         out.open(name, std::ios::trunc | std::ios::out | std::ios::binary);
         if(!out.is_open())
         {
-            f_error = "could not open file \""
-                + name
-                + "\" for writing.";
+            f_error = concat_to_string(
+                      "could not open file \""
+                    , name
+                    , "\" for writing.");
             return false;
         }
 
@@ -390,9 +781,12 @@ public:
 
         if(out.fail())
         {
-            f_error = "could not write "                    // LCOV_EXCL_LINE
-                + std::to_string(f_contents.length())       // LCOV_EXCL_LINE
-                + " bytes to \"" + name + "\".";            // LCOV_EXCL_LINE
+            f_error = concat_to_string(                     // LCOV_EXCL_LINE
+                      "could not write "                    // LCOV_EXCL_LINE
+                    , f_contents.length()                   // LCOV_EXCL_LINE
+                    , " bytes to \""                        // LCOV_EXCL_LINE
+                    , name                                  // LCOV_EXCL_LINE
+                    , "\".");                               // LCOV_EXCL_LINE
             return false;                                   // LCOV_EXCL_LINE
         }
 
@@ -477,14 +871,255 @@ public:
     }
 
 private:
+    /** \brief The size of the first buffer used in SIZE_MODE_READ.
+     *
+     * The buffer starts with this size and then doubles each time it
+     * gets filled up.
+     */
+    static constexpr std::size_t const READ_BUFFER_SIZE = 16 * 1024;
+
+    /** \brief Read up to \p count bytes at the end of the contents.
+     *
+     * The function reads until \p count bytes were read, the end of
+     * the file is reached, or an error occurs. The contents is resized
+     * to include only the bytes actually read.
+     *
+     * \param[in] fd  The file descriptor to read from.
+     * \param[in] count  The number of bytes to read.
+     *
+     * \return The number of bytes read or -1 on an error.
+     */
+    ssize_t append_from(int fd, std::size_t count)
+    {
+        ssize_t result(0);
+        auto const read_fully([fd, count, &result](char * buffer)
+            {
+                std::size_t pos(0);
+                while(pos < count)
+                {
+                    ssize_t const r(::read(fd, buffer + pos, count - pos));
+                    if(r < 0)
+                    {
+                        if(errno == EINTR)
+                        {
+                            continue;
+                        }
+                        result = -1;
+                        return pos;
+                    }
+                    if(r == 0)
+                    {
+                        break;
+                    }
+                    pos += r;
+                }
+                result = pos;
+                return pos;
+            });
+
+#ifdef __cpp_lib_string_resize_and_overwrite
+        std::size_t const used(f_contents.size());
+        f_contents.resize_and_overwrite(used + count, [used, &read_fully](char * buffer, std::size_t)
+            {
+                return used + read_fully(buffer + used);
+            });
+#else
+        // avoid the zero-fill of resize() by reading in a default
+        // initialized buffer
+        //
+        std::unique_ptr<char[]> buffer(std::make_unique_for_overwrite<char[]>(count));
+        f_contents.append(buffer.get(), read_fully(buffer.get()));
+#endif
+        return result;
+    }
+
+    bool write_atomically(std::string const & name)
+    {
+        bool const durable(f_write_mode == write_mode_t::WRITE_MODE_DURABLE);
+        detail::atomic_file_writer writer(name);
+        if(!writer.write(f_contents.data(), f_contents.length())
+        || (durable && !writer.sync())
+        || !writer.rename())
+        {
+            f_error = writer.last_error();
+            return false;
+        }
+
+        if(durable
+        && !detail::sync_directory(detail::directory_of(writer.target()), f_error))
+        {
+            return false;                                   // LCOV_EXCL_LINE
+        }
+
+        f_error.clear();
+
+        return true;
+    }
+
     std::string         f_filename = std::string();
     std::string         f_contents = std::string();
     std::string         f_error = std::string();
     size_mode_t         f_size_mode = size_mode_t::SIZE_MODE_SEEK;
+    write_mode_t        f_write_mode = write_mode_t::WRITE_MODE_TRUNCATE;
     bool                f_temporary = false;
 };
 
 
+/** \brief Save many files with a single disk flush.
+ *
+ * Syncing each file with WRITE_MODE_DURABLE costs at least one disk
+ * flush per file. The batch instead writes all the files to temporary
+ * files, starts the write back of all of them, waits for all of them,
+ * renames them, and finally syncs each directory once.
+ *
+ * \code
+ *     snapdev::file_contents_batch batch;
+ *     for(auto const & state : states)
+ *     {
+ *         batch.add(state->filename(), state->serialize());
+ *     }
+ *     if(!batch.commit())
+ *     {
+ *         std::cerr << batch.last_error() << "\n";
+ *     }
+ * \endcode
+ *
+ * \note
+ * Each file is replaced atomically, but the batch as a whole is not a
+ * transaction. If a rename() fails, the files renamed before it keep
+ * their new contents.
+ */
+class file_contents_batch
+{
+public:
+    /** \brief Add a file to the batch.
+     *
+     * The contents is written to a temporary file immediately and its
+     * write back gets started. The file is then closed so a batch does
+     * not keep one file descriptor open per file. The destination does
+     * not change until commit() gets called.
+     *
+     * \param[in] filename  The name of the file to save.
+     * \param[in] contents  The new contents of the file.
+     *
+     * \return true if the temporary file was written.
+     */
+    bool add(std::string const & filename, std::string const & contents)
+    {
+        std::unique_ptr<detail::atomic_file_writer> writer(std::make_unique<detail::atomic_file_writer>(filename));
+        if(!writer->write(contents.data(), contents.length()))
+        {
+            f_error = writer->last_error();
+            return false;
+        }
+        writer->start_sync();
+        writer->close();
+        f_writers.push_back(std::move(writer));
+        return true;
+    }
+
+    /** \brief Add a file_contents to the batch.
+     *
+     * \param[in] file  The file to save.
+     * \param[in] filename  The name to use or an empty string to use the
+     *                      filename of \p file.
+     *
+     * \return true if the temporary file was written.
+     */
+    bool add(file_contents const & file, std::string const & filename = std::string())
+    {
+        return add(filename.empty() ? file.filename() : filename, file.contents());
+    }
+
+    std::size_t size() const
+    {
+        return f_writers.size();
+    }
+
+    bool empty() const
+    {
+        return f_writers.empty();
+    }
+
+    /** \brief Make all the files of the batch durable.
+     *
+     * The write back of all the temporary files was started by add()
+     * so the kernel can send all the data to the disk at once. Each
+     * file is now synced; since the data of the other files was already
+     * sent, these calls mostly wait on the same flush. Only one file is
+     * open at a time. Finally the files are renamed and each directory
+     * is synced once.
+     *
+     * The batch is empty on return.
+     *
+     * \return true if all the files were saved.
+     */
+    bool commit()
+    {
+        for(auto & w : f_writers)
+        {
+            if(!w->sync())
+            {
+                f_error = w->last_error();              // LCOV_EXCL_LINE
+                rollback();                             // LCOV_EXCL_LINE
+                return false;                           // LCOV_EXCL_LINE
+            }
+            w->close();
+        }
+
+        bool result(true);
+        std::set<std::string> directories;
+        for(auto & w : f_writers)
+        {
+            if(w->rename())
+            {
+                directories.insert(detail::directory_of(w->target()));
+            }
+            else
+            {
+                f_error = w->last_error();
+                result = false;
+            }
+        }
+        f_writers.clear();
+
+        for(auto const & d : directories)
+        {
+            if(!detail::sync_directory(d, f_error))
+            {
+                result = false;                         // LCOV_EXCL_LINE
+            }
+        }
+
+        if(result)
+        {
+            f_error.clear();
+        }
+        return result;
+    }
+
+    /** \brief Cancel the batch.
+     *
+     * The temporary files get deleted and the destinations are left
+     * untouched. Destroying the batch has the same effect.
+     */
+    void rollback()
+    {
+        f_writers.clear();
+    }
+
+    std::string const & last_error() const
+    {
+        return f_error;
+    }
+
+private:
+    std::vector<std::unique_ptr<detail::atomic_file_writer>>
+                        f_writers = std::vector<std::unique_ptr<detail::atomic_file_writer>>();
+    std::string         f_error = std::string();
+};
+
+
 
 } // namespace snapdev
 // vim: ts=4 sw=4 et
@@ -0,0 +1,723 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Keep the contents of files in memory.
+ *
+ * Components which read the same files over and over again (templates,
+ * configuration files, etc.) can use the file_contents_cache instead of
+ * a file_contents. The cache keeps the contents of the files in shared
+ * immutable buffers. A cached buffer is returned as long as the device,
+ * inode, modification time, and size of the file did not change, which
+ * costs one stat() per request.
+ *
+ * With watching turned on, an inotify thread invalidates the entries
+ * of files which get modified, so a hot file is returned without any
+ * system call at all. The thread also watches each directory of the
+ * path so a file replaced by a rename or a renamed parent directory
+ * gets detected. This is only done for absolute paths without any
+ * symbolic links (i.e. realpath() returns the same path) since the
+ * target of a symbolic link can change without any event on the path.
+ * Other paths still cost one stat() per request.
+ *
+ * The total size of the cached buffers is limited by a memory budget.
+ * When the budget is exceeded, the least recently used files get
+ * dropped from the cache. Buffers still in use elsewhere remain valid
+ * since they are shared pointers.
+ *
+ * \code
+ *     snapdev::file_contents_cache::buffer_t page(
+ *             snapdev::file_contents_cache::instance().get("/usr/share/website/page.html"));
+ *     if(page == nullptr)
+ *     {
+ *         ...file can't be read...
+ *     }
+ * \endcode
+ */
+
+// self
+//
+#include    <snapdev/file_contents.h>
+#include    <snapdev/raii_generic_deleter.h>
+
+
+// C++
+//
+#include    <list>
+#include    <map>
+#include    <memory>
+#include    <mutex>
+#include    <set>
+#include    <string>
+#include    <thread>
+#include    <unordered_map>
+#include    <vector>
+
+
+// C
+//
+#include    <poll.h>
+#include    <stdlib.h>
+#include    <sys/eventfd.h>
+#include    <sys/inotify.h>
+#include    <sys/stat.h>
+#include    <unistd.h>
+
+
+
+namespace snapdev
+{
+
+
+
+class file_contents_cache
+{
+public:
+    typedef std::shared_ptr<std::string const>  buffer_t;
+
+    /** \brief The default memory budget of a cache.
+     */
+    static constexpr std::size_t const DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    /** \brief Initialize a cache.
+     *
+     * In most cases, you want to use the process wide cache returned by
+     * instance() instead of creating your own.
+     *
+     * \param[in] memory_budget  The maximum number of bytes of file
+     *            contents kept in the cache.
+     */
+    file_contents_cache(std::size_t memory_budget = DEFAULT_MEMORY_BUDGET)
+        : f_memory_budget(memory_budget)
+    {
+    }
+
+    file_contents_cache(file_contents_cache const &) = delete;
+
+    /** \brief Stop the watching thread.
+     */
+    ~file_contents_cache()
+    {
+        if(f_thread.joinable())
+        {
+            std::uint64_t const value(1);
+            if(::write(f_stop.get(), &value, sizeof(value)) != sizeof(value))
+            {
+                // the eventfd can't be full after a single write
+            }
+            f_thread.join();
+        }
+    }
+
+    file_contents_cache & operator = (file_contents_cache const &) = delete;
+
+    /** \brief Retrieve the process wide cache.
+     *
+     * \return A reference to the process wide cache.
+     */
+    static file_contents_cache & instance()
+    {
+        static file_contents_cache cache;
+        return cache;
+    }
+
+    /** \brief Get the contents of a file.
+     *
+     * If the file is in the cache and did not change, the cached buffer
+     * is returned. Otherwise the file gets read and added to the cache.
+     *
+     * The buffer is never modified. If the file changes, a new buffer
+     * gets allocated so the buffers returned earlier remain valid.
+     *
+     * \param[in] filename  The name of the file to read.
+     * \param[out] error_msg  The error message if the file can't be read.
+     *
+     * \return The contents of the file or nullptr on an error.
+     */
+    buffer_t get(std::string const & filename, std::string & error_msg)
+    {
+        bool try_watch(true);
+        {
+            std::lock_guard lock(f_mutex);
+            auto it(f_entries.find(filename));
+            if(it != f_entries.end())
+            {
+                if(it->second.f_verified)
+                {
+                    touch(it->second);
+                    return it->second.f_buffer;
+                }
+                try_watch = it->second.f_canonical;
+            }
+        }
+
+        // watch before reading so a change while we read the file
+        // is not missed; a path which is known to not be canonical
+        // is only verified with stat()
+        //
+        std::size_t events(0);
+        bool canonical(try_watch);
+        watches_t watches;
+        if(try_watch)
+        {
+            watches = add_watches(filename, events, canonical);
+        }
+
+        struct stat st = {};
+        if(stat(filename.c_str(), &st) != 0)
+        {
+            error_msg = concat_to_string(
+                      "could not open file \""
+                    , filename
+                    , "\" for reading.");
+            std::lock_guard lock(f_mutex);
+            release_watches(watches);
+            erase(filename);
+            return buffer_t();
+        }
+        key_t const key(st);
+
+        {
+            std::lock_guard lock(f_mutex);
+            auto it(f_entries.find(filename));
+            if(it != f_entries.end()
+            && it->second.f_key == key)
+            {
+                it->second.f_verified = !watches.empty() && events == f_events;
+                it->second.f_canonical = canonical;
+                set_watches(it->first, it->second, std::move(watches));
+                touch(it->second);
+                return it->second.f_buffer;
+            }
+        }
+
+        file_contents in(filename);
+        if(!in.read_all())
+        {
+            error_msg = in.last_error();
+            std::lock_guard lock(f_mutex);
+            release_watches(watches);
+            erase(filename);
+            return buffer_t();
+        }
+        buffer_t buffer(std::make_shared<std::string const>(std::move(in.contents())));
+
+        // if the file changed while we were reading it, return the data
+        // but do not cache it
+        //
+        bool const unchanged(stat(filename.c_str(), &st) == 0 && key_t(st) == key);
+        std::lock_guard lock(f_mutex);
+        if(!unchanged
+        || buffer->length() > f_memory_budget)
+        {
+            release_watches(watches);
+            erase(filename);
+            return buffer;
+        }
+
+        erase(filename);
+        f_lru.push_front(filename);
+        entry_t & e(f_entries[filename]);
+        e.f_buffer = buffer;
+        e.f_key = key;
+        e.f_verified = !watches.empty() && events == f_events;
+        e.f_canonical = canonical;
+        set_watches(filename, e, std::move(watches));
+        e.f_lru = f_lru.begin();
+        f_memory_usage += buffer->length();
+        enforce_budget();
+
+        return buffer;
+    }
+
+    buffer_t get(std::string const & filename)
+    {
+        std::string error_msg;
+        return get(filename, error_msg);
+    }
+
+    /** \brief Remove a file from the cache.
+     *
+     * \param[in] filename  The name of the file to remove.
+     */
+    void invalidate(std::string const & filename)
+    {
+        std::lock_guard lock(f_mutex);
+        erase(filename);
+    }
+
+    /** \brief Remove all the files from the cache.
+     */
+    void clear()
+    {
+        std::lock_guard lock(f_mutex);
+        while(!f_lru.empty())
+        {
+            erase(f_lru.back());
+        }
+    }
+
+    /** \brief Change the memory budget.
+     *
+     * If the new budget is smaller than the current memory usage, the
+     * least recently used files get removed from the cache.
+     *
+     * \param[in] memory_budget  The new budget in bytes.
+     */
+    void set_memory_budget(std::size_t memory_budget)
+    {
+        std::lock_guard lock(f_mutex);
+        f_memory_budget = memory_budget;
+        enforce_budget();
+    }
+
+    std::size_t get_memory_budget() const
+    {
+        std::lock_guard lock(f_mutex);
+        return f_memory_budget;
+    }
+
+    std::size_t memory_usage() const
+    {
+        std::lock_guard lock(f_mutex);
+        return f_memory_usage;
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard lock(f_mutex);
+        return f_entries.size();
+    }
+
+    /** \brief Start the inotify thread.
+     *
+     * Once watching, files added to the cache get an inotify watch and
+     * are returned by get() without calling stat() until they change.
+     *
+     * This only applies to absolute filenames which do not include any
+     * symbolic links, "." or ".." (i.e. realpath() returns the same
+     * name). Each directory of such a path is watched too, so renaming
+     * or deleting the file, one of its directories, or moving another
+     * file in its place invalidates the entry. Other filenames keep
+     * being verified with stat() on each get().
+     *
+     * Note that the inotify events are asynchronous. A get() which
+     * happens right after a change may still return the old contents
+     * until the thread processed the event.
+     *
+     * Once started, the thread runs until the cache gets destroyed.
+     *
+     * \return true if the thread is running.
+     */
+    bool start_watching()
+    {
+        std::lock_guard lock(f_mutex);
+        if(f_inotify != nullptr)
+        {
+            return true;
+        }
+
+        f_inotify.reset(inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+        f_stop.reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        if(f_inotify == nullptr
+        || f_stop == nullptr)
+        {
+            f_inotify.reset();                          // LCOV_EXCL_LINE
+            f_stop.reset();                             // LCOV_EXCL_LINE
+            return false;                               // LCOV_EXCL_LINE
+        }
+        f_thread = std::thread(&file_contents_cache::watch, this);
+        return true;
+    }
+
+    bool is_watching() const
+    {
+        std::lock_guard lock(f_mutex);
+        return f_inotify != nullptr;
+    }
+
+private:
+    struct key_t
+    {
+        key_t() = default;
+
+        key_t(struct stat const & st)
+            : f_dev(st.st_dev)
+            , f_ino(st.st_ino)
+            , f_mtime_sec(st.st_mtim.tv_sec)
+            , f_mtime_nsec(st.st_mtim.tv_nsec)
+            , f_size(st.st_size)
+        {
+        }
+
+        bool operator == (key_t const & rhs) const = default;
+
+        dev_t           f_dev = 0;
+        ino_t           f_ino = 0;
+        time_t          f_mtime_sec = 0;
+        long            f_mtime_nsec = 0;
+        off_t           f_size = 0;
+    };
+
+    /** \brief One inotify watch of an entry.
+     *
+     * The watch of the file itself has an empty name. The watches of
+     * the directories of the path include the name of the next
+     * component so only events about that name invalidate the entry.
+     */
+    struct watch_t
+    {
+        int                                 f_wd = -1;
+        std::string                         f_name = std::string();
+    };
+
+    typedef std::vector<watch_t>            watches_t;
+
+    struct entry_t
+    {
+        buffer_t                            f_buffer = buffer_t();
+        key_t                               f_key = key_t();
+        watches_t                           f_watches = watches_t();
+        bool                                f_verified = false;
+        bool                                f_canonical = true;
+        std::list<std::string>::iterator    f_lru = std::list<std::string>::iterator();
+    };
+
+    /** \brief The entries affected by the events of one watch.
+     *
+     * The filenames are indexed by the name of interest in the watched
+     * directory (an empty name for the watch of the file itself) so an
+     * event only looks at the entries it concerns.
+     */
+    typedef std::unordered_map<std::string, std::set<std::string>>
+                                            watch_entries_t;
+
+    void touch(entry_t & e)
+    {
+        f_lru.splice(f_lru.begin(), f_lru, e.f_lru);
+    }
+
+    void erase(std::string const & filename)
+    {
+        auto it(f_entries.find(filename));
+        if(it == f_entries.end())
+        {
+            return;
+        }
+        f_memory_usage -= it->second.f_buffer->length();
+        set_watches(filename, it->second, watches_t());
+        f_lru.erase(it->second.f_lru);
+        f_entries.erase(it);
+    }
+
+    /** \brief Replace the watches of an entry.
+     *
+     * The old watches get released and removed from the index and the
+     * new watches get added to the index.
+     *
+     * \param[in] filename  The name of the entry.
+     * \param[in,out] e  The entry.
+     * \param[in] watches  The new watches of the entry.
+     */
+    void set_watches(std::string const & filename, entry_t & e, watches_t && watches)
+    {
+        for(auto const & w : e.f_watches)
+        {
+            auto index(f_watch_index.find(w.f_wd));
+            if(index == f_watch_index.end())
+            {
+                continue;
+            }
+            auto name(index->second.find(w.f_name));
+            if(name != index->second.end())
+            {
+                name->second.erase(filename);
+                if(name->second.empty())
+                {
+                    index->second.erase(name);
+                }
+            }
+            if(index->second.empty())
+            {
+                f_watch_index.erase(index);
+            }
+        }
+        release_watches(e.f_watches);
+
+        e.f_watches = std::move(watches);
+        for(auto const & w : e.f_watches)
+        {
+            f_watch_index[w.f_wd][w.f_name].insert(filename);
+        }
+    }
+
+    void enforce_budget()
+    {
+        while(f_memory_usage > f_memory_budget)
+        {
+            erase(f_lru.back());
+        }
+    }
+
+    /** \brief Add the watches of a file.
+     *
+     * The file gets watched along each directory of its path. If the
+     * path is not absolute, includes a symbolic link, or one of the
+     * watches can't be added, the function returns an empty list and
+     * the entry gets verified with stat() instead.
+     *
+     * The watches are added before the path is verified so a change
+     * happening in between generates an event.
+     *
+     * \param[in] filename  The name of the file to watch.
+     * \param[out] events  The event counter before adding the watches.
+     * \param[out] canonical  Set to false if the path is not canonical,
+     * in which case the caller does not have to try again.
+     *
+     * \return The list of watches or an empty list.
+     */
+    watches_t add_watches(std::string const & filename, std::size_t & events, bool & canonical)
+    {
+        watches_t watches;
+        {
+            std::lock_guard lock(f_mutex);
+            events = f_events;
+            if(f_inotify == nullptr)
+            {
+                return watches;
+            }
+            if(filename.empty()
+            || filename[0] != '/')
+            {
+                canonical = false;
+                return watches;
+            }
+
+            if(!add_watch(
+                  watches
+                , filename
+                , std::string()
+                , IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF))
+            {
+                return watches;
+            }
+            for(std::string::size_type pos(0); pos < filename.length(); )
+            {
+                std::string::size_type const next(filename.find('/', pos + 1));
+                std::string const dir(pos == 0 ? std::string("/") : filename.substr(0, pos));
+                std::string const name(filename.substr(pos + 1, next == std::string::npos ? std::string::npos : next - pos - 1));
+                if(!add_watch(
+                      watches
+                    , dir
+                    , name
+                    , IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_DELETE_SELF))
+                {
+                    return watches;
+                }
+                pos = next;
+            }
+        }
+
+        char * real(realpath(filename.c_str(), nullptr));
+        canonical = real != nullptr && filename == real;
+        free(real);
+        if(!canonical)
+        {
+            std::lock_guard lock(f_mutex);
+            release_watches(watches);
+        }
+        return watches;
+    }
+
+    /** \brief Add one watch to a list.
+     *
+     * On failure, the watches already in the list get released and the
+     * list is cleared.
+     *
+     * \param[in,out] watches  The list of watches to add the watch to.
+     * \param[in] path  The path to watch.
+     * \param[in] name  The name of interest within that directory.
+     * \param[in] mask  The inotify events to watch.
+     *
+     * \return true if the watch was added.
+     */
+    bool add_watch(
+          watches_t & watches
+        , std::string const & path
+        , std::string const & name
+        , std::uint32_t mask)
+    {
+        int const wd(inotify_add_watch(f_inotify.get(), path.c_str(), mask));
+        if(wd == -1)
+        {
+            release_watches(watches);
+            return false;
+        }
+        ++f_watch_refs[wd];
+        watches.push_back({ wd, name });
+        return true;
+    }
+
+    /** \brief Release all the watches of a list.
+     *
+     * \param[in,out] watches  The watches to release, the list gets cleared.
+     */
+    void release_watches(watches_t & watches)
+    {
+        for(auto const & w : watches)
+        {
+            release_watch(w.f_wd);
+        }
+        watches.clear();
+    }
+
+    /** \brief Release one reference to a watch.
+     *
+     * The same inode (i.e. hard links) gets the same watch so the watch
+     * is removed only once no entry uses it anymore.
+     *
+     * \param[in] watch  The watch to release.
+     */
+    void release_watch(int watch)
+    {
+        auto it(f_watch_refs.find(watch));
+        if(it == f_watch_refs.end())
+        {
+            return;
+        }
+        --it->second;
+        if(it->second == 0)
+        {
+            f_watch_refs.erase(it);
+            inotify_rm_watch(f_inotify.get(), watch);
+        }
+    }
+
+    /** \brief The inotify thread.
+     *
+     * Any event on a watched file removes its entries from the cache so
+     * the next get() reads the file again. This catches changes which
+     * the stat() key does not see, such as a write which restores the
+     * modification time.
+     */
+    void watch()
+    {
+        pollfd fds[2] =
+        {
+            { .fd = f_inotify.get(), .events = POLLIN, .revents = 0 },
+            { .fd = f_stop.get(), .events = POLLIN, .revents = 0 },
+        };
+        alignas(inotify_event) char buffer[4096];
+        for(;;)
+        {
+            if(poll(fds, 2, -1) < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;                           // LCOV_EXCL_LINE
+                }
+                return;                                 // LCOV_EXCL_LINE
+            }
+            if(fds[1].revents != 0)
+            {
+                return;
+            }
+
+            for(;;)
+            {
+                ssize_t const r(::read(f_inotify.get(), buffer, sizeof(buffer)));
+                if(r <= 0)
+                {
+                    break;
+                }
+
+                std::lock_guard lock(f_mutex);
+                ++f_events;
+                for(char const * p(buffer); p < buffer + r; )
+                {
+                    inotify_event const * event(reinterpret_cast<inotify_event const *>(p));
+                    std::vector<std::string> modified;
+                    if((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        // events were lost so all the entries have to
+                        // be verified again
+                        //
+                        for(auto const & e : f_entries)
+                        {
+                            modified.push_back(e.first);
+                        }
+                    }
+                    else
+                    {
+                        auto const index(f_watch_index.find(event->wd));
+                        if(index != f_watch_index.end())
+                        {
+                            if(event->len == 0)
+                            {
+                                for(auto const & name : index->second)
+                                {
+                                    modified.insert(modified.end(), name.second.begin(), name.second.end());
+                                }
+                            }
+                            else
+                            {
+                                auto const name(index->second.find(event->name));
+                                if(name != index->second.end())
+                                {
+                                    modified.assign(name->second.begin(), name->second.end());
+                                }
+                            }
+                        }
+                    }
+                    for(auto const & filename : modified)
+                    {
+                        erase(filename);
+                    }
+                    if((event->mask & IN_IGNORED) != 0)
+                    {
+                        f_watch_refs.erase(event->wd);
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+    }
+
+    mutable std::mutex                  f_mutex = std::mutex();
+    std::unordered_map<std::string, entry_t>
+                                        f_entries = std::unordered_map<std::string, entry_t>();
+    std::list<std::string>              f_lru = std::list<std::string>();
+    std::size_t                         f_memory_budget = DEFAULT_MEMORY_BUDGET;
+    std::size_t                         f_memory_usage = 0;
+
+    // inotify
+    //
+    raii_fd_t                           f_inotify = raii_fd_t();
+    raii_fd_t                           f_stop = raii_fd_t();
+    std::thread                         f_thread = std::thread();
+    std::map<int, std::size_t>          f_watch_refs = std::map<int, std::size_t>();
+    std::unordered_map<int, watch_entries_t>
+                                        f_watch_index = std::unordered_map<int, watch_entries_t>();
+    std::size_t                         f_events = 0;
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
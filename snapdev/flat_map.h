@@ -0,0 +1,609 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief A map implemented with a sorted vector.
+ *
+ * The flat_map keeps its key/value pairs in a vector sorted by key.
+ * See flat_set.h for the pros and cons of flat containers.
+ *
+ * The default comparator is `std::less<>` so a
+ * `flat_map<std::string, T>` can be searched with an `std::string_view`.
+ *
+ * \warning
+ * The iterators give access to `std::pair<Key, T>` objects so the value
+ * can be modified in place. Never modify the key (`first`) since that
+ * would break the order of the vector.
+ */
+
+// self
+//
+#include    <snapdev/flat_set.h>
+
+
+// C++
+//
+#include    <algorithm>
+#include    <functional>
+#include    <initializer_list>
+#include    <stdexcept>
+#include    <utility>
+#include    <vector>
+
+
+
+namespace snapdev
+{
+
+
+
+template<
+      typename Key
+    , typename T
+    , typename Compare = std::less<>
+    , typename Allocator = std::allocator<std::pair<Key, T>>>
+class flat_map
+{
+public:
+    typedef Key                                             key_type;
+    typedef T                                               mapped_type;
+    typedef std::pair<Key, T>                               value_type;
+    typedef Compare                                         key_compare;
+    typedef std::vector<value_type, Allocator>              container_type;
+    typedef typename container_type::size_type              size_type;
+    typedef typename container_type::difference_type        difference_type;
+    typedef value_type &                                    reference;
+    typedef value_type const &                              const_reference;
+    typedef typename container_type::iterator               iterator;
+    typedef typename container_type::const_iterator         const_iterator;
+    typedef typename container_type::reverse_iterator       reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+    /** \brief Compare two pairs using their key.
+     */
+    class value_compare
+    {
+    public:
+        value_compare(Compare const & comp)
+            : f_compare(comp)
+        {
+        }
+
+        bool operator () (value_type const & lhs, value_type const & rhs) const
+        {
+            return f_compare(lhs.first, rhs.first);
+        }
+
+    private:
+        Compare f_compare;
+    };
+
+    flat_map() = default;
+
+    explicit flat_map(Compare const & comp)
+        : f_compare(comp)
+    {
+    }
+
+    /** \brief Create a map from a vector of pairs.
+     *
+     * The vector gets sorted by key and the duplicate keys removed. When
+     * two pairs have equivalent keys, the first one is kept.
+     *
+     * \param[in] data  The pairs of the new map.
+     * \param[in] comp  The comparator.
+     */
+    explicit flat_map(container_type data, Compare const & comp = Compare())
+        : f_data(std::move(data))
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    /** \brief Create a map from a vector of pairs sorted by key.
+     *
+     * The vector is used as is. It must be sorted with \p comp and not
+     * include duplicate keys.
+     *
+     * \param[in] data  The sorted pairs of the new map.
+     * \param[in] comp  The comparator.
+     */
+    flat_map(sorted_unique_t, container_type data, Compare const & comp = Compare())
+        : f_data(std::move(data))
+        , f_compare(comp)
+    {
+    }
+
+    template<typename InputIt>
+    flat_map(InputIt first, InputIt last, Compare const & comp = Compare())
+        : f_data(first, last)
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    flat_map(std::initializer_list<value_type> list, Compare const & comp = Compare())
+        : f_data(list)
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    iterator begin()
+    {
+        return f_data.begin();
+    }
+
+    iterator end()
+    {
+        return f_data.end();
+    }
+
+    const_iterator begin() const
+    {
+        return f_data.cbegin();
+    }
+
+    const_iterator end() const
+    {
+        return f_data.cend();
+    }
+
+    const_iterator cbegin() const
+    {
+        return f_data.cbegin();
+    }
+
+    const_iterator cend() const
+    {
+        return f_data.cend();
+    }
+
+    reverse_iterator rbegin()
+    {
+        return f_data.rbegin();
+    }
+
+    reverse_iterator rend()
+    {
+        return f_data.rend();
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return f_data.crbegin();
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return f_data.crend();
+    }
+
+    const_reverse_iterator crbegin() const
+    {
+        return f_data.crbegin();
+    }
+
+    const_reverse_iterator crend() const
+    {
+        return f_data.crend();
+    }
+
+    bool empty() const
+    {
+        return f_data.empty();
+    }
+
+    size_type size() const
+    {
+        return f_data.size();
+    }
+
+    size_type max_size() const
+    {
+        return f_data.max_size();
+    }
+
+    size_type capacity() const
+    {
+        return f_data.capacity();
+    }
+
+    void reserve(size_type size)
+    {
+        f_data.reserve(size);
+    }
+
+    void shrink_to_fit()
+    {
+        f_data.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        f_data.clear();
+    }
+
+    key_compare key_comp() const
+    {
+        return f_compare;
+    }
+
+    value_compare value_comp() const
+    {
+        return value_compare(f_compare);
+    }
+
+    /** \brief Retrieve the value of a key, create it if necessary.
+     *
+     * \param[in] key  The key of the value to retrieve.
+     *
+     * \return A reference to the value.
+     */
+    mapped_type & operator [] (key_type const & key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    mapped_type & operator [] (key_type && key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    /** \brief Retrieve the value of an existing key.
+     *
+     * \exception std::out_of_range
+     * The key is not defined in this map.
+     *
+     * \param[in] key  The key of the value to retrieve.
+     *
+     * \return A reference to the value.
+     */
+    template<typename K>
+    mapped_type & at(K const & key)
+    {
+        iterator const it(find(key));
+        if(it == end())
+        {
+            throw std::out_of_range("flat_map::at(): key not found.");
+        }
+        return it->second;
+    }
+
+    template<typename K>
+    mapped_type const & at(K const & key) const
+    {
+        const_iterator const it(find(key));
+        if(it == end())
+        {
+            throw std::out_of_range("flat_map::at(): key not found.");
+        }
+        return it->second;
+    }
+
+    std::pair<iterator, bool> insert(value_type const & value)
+    {
+        return try_emplace(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type && value)
+    {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    /** \brief Insert one pair using a hint.
+     *
+     * When \p hint is the position where the pair goes (i.e. when
+     * inserting pairs sorted by key at the end), the insertion does not
+     * search the position.
+     *
+     * \param[in] hint  The expected position of the new pair.
+     * \param[in] value  The pair to insert.
+     *
+     * \return The position of the new or existing pair.
+     */
+    iterator insert(const_iterator hint, value_type const & value)
+    {
+        iterator const pos(find_hint(hint, value.first));
+        if(pos != end() && !f_compare(value.first, pos->first))
+        {
+            return pos;
+        }
+        return f_data.insert(pos, value);
+    }
+
+    /** \brief Insert many pairs at once.
+     *
+     * The pairs get appended, sorted, merged with the existing pairs,
+     * and the duplicate keys removed. Existing pairs are kept over new
+     * pairs with an equivalent key.
+     *
+     * \param[in] first  The first pair to insert.
+     * \param[in] last  The end of the pairs to insert.
+     */
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        size_type const old_size(f_data.size());
+        f_data.insert(f_data.end(), first, last);
+        normalize(old_size);
+    }
+
+    void insert(std::initializer_list<value_type> list)
+    {
+        insert(list.begin(), list.end());
+    }
+
+    template<typename ...ARGS>
+    std::pair<iterator, bool> emplace(ARGS && ... args)
+    {
+        value_type value(std::forward<ARGS>(args)...);
+        return insert(std::move(value));
+    }
+
+    /** \brief Insert a pair if the key does not exist yet.
+     *
+     * The value is only constructed if the key is not found.
+     *
+     * \param[in] key  The key of the new pair.
+     * \param[in] args  The parameters used to construct the value.
+     *
+     * \return The position of the pair and true if it was inserted.
+     */
+    template<typename K, typename ...ARGS>
+    std::pair<iterator, bool> try_emplace(K && key, ARGS && ... args)
+    {
+        iterator const pos(lower_bound(key));
+        if(pos != end() && !f_compare(key, pos->first))
+        {
+            return std::make_pair(pos, false);
+        }
+        return std::make_pair(
+                  f_data.emplace(
+                          pos
+                        , std::piecewise_construct
+                        , std::forward_as_tuple(std::forward<K>(key))
+                        , std::forward_as_tuple(std::forward<ARGS>(args)...))
+                , true);
+    }
+
+    /** \brief Insert a pair or replace the value of an existing key.
+     *
+     * \param[in] key  The key of the pair.
+     * \param[in] value  The new value.
+     *
+     * \return The position of the pair and true if it was inserted,
+     * false if it was assigned.
+     */
+    template<typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign(K && key, M && value)
+    {
+        std::pair<iterator, bool> result(try_emplace(std::forward<K>(key), std::forward<M>(value)));
+        if(!result.second)
+        {
+            result.first->second = std::forward<M>(value);
+        }
+        return result;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return f_data.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return f_data.erase(first, last);
+    }
+
+    size_type erase(key_type const & key)
+    {
+        const_iterator const it(find(key));
+        if(it == end())
+        {
+            return 0;
+        }
+        f_data.erase(it);
+        return 1;
+    }
+
+    /** \brief Remove the pairs matching a predicate.
+     *
+     * \param[in] pred  The predicate, return true to remove the pair.
+     *
+     * \return The number of pairs removed.
+     */
+    template<typename Predicate>
+    size_type erase_if(Predicate pred)
+    {
+        size_type const old_size(f_data.size());
+        f_data.erase(std::remove_if(f_data.begin(), f_data.end(), pred), f_data.end());
+        return old_size - f_data.size();
+    }
+
+    template<typename K>
+    iterator lower_bound(K const & key)
+    {
+        return f_data.begin() + (std::as_const(*this).lower_bound(key) - f_data.cbegin());
+    }
+
+    template<typename K>
+    const_iterator lower_bound(K const & key) const
+    {
+        return std::lower_bound(
+                  f_data.begin()
+                , f_data.end()
+                , key
+                , [this](value_type const & lhs, K const & rhs)
+                  {
+                      return f_compare(lhs.first, rhs);
+                  });
+    }
+
+    template<typename K>
+    iterator upper_bound(K const & key)
+    {
+        return f_data.begin() + (std::as_const(*this).upper_bound(key) - f_data.cbegin());
+    }
+
+    template<typename K>
+    const_iterator upper_bound(K const & key) const
+    {
+        return std::upper_bound(
+                  f_data.begin()
+                , f_data.end()
+                , key
+                , [this](K const & lhs, value_type const & rhs)
+                  {
+                      return f_compare(lhs, rhs.first);
+                  });
+    }
+
+    template<typename K>
+    std::pair<const_iterator, const_iterator> equal_range(K const & key) const
+    {
+        const_iterator const it(find(key));
+        return std::make_pair(it, it == end() ? it : it + 1);
+    }
+
+    /** \brief Search a key.
+     *
+     * The \p key may be of a type other than Key when the comparator is
+     * transparent, which is the case of the default `std::less<>`.
+     *
+     * \param[in] key  The key to search.
+     *
+     * \return An iterator to the pair or end().
+     */
+    template<typename K>
+    iterator find(K const & key)
+    {
+        return f_data.begin() + (std::as_const(*this).find(key) - f_data.cbegin());
+    }
+
+    template<typename K>
+    const_iterator find(K const & key) const
+    {
+        static_assert(
+              std::is_convertible_v<K const &, Key const &>
+           || detail::is_transparent_v<Compare>
+           , "heterogeneous lookups require a transparent comparator");
+
+        const_iterator const it(lower_bound(key));
+        if(it != end() && !f_compare(key, it->first))
+        {
+            return it;
+        }
+        return end();
+    }
+
+    template<typename K>
+    bool contains(K const & key) const
+    {
+        return find(key) != end();
+    }
+
+    template<typename K>
+    size_type count(K const & key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    /** \brief Move the vector out of the map.
+     *
+     * The map is empty on return. The vector is sorted by key and has
+     * no duplicate keys.
+     *
+     * \return The vector of pairs.
+     */
+    container_type extract()
+    {
+        container_type result(std::move(f_data));
+        f_data.clear();
+        return result;
+    }
+
+    /** \brief Replace the vector of pairs.
+     *
+     * The \p data must be sorted by key and not include duplicate keys.
+     *
+     * \param[in] data  The new pairs.
+     */
+    void replace(container_type && data)
+    {
+        f_data = std::move(data);
+    }
+
+    void swap(flat_map & rhs)
+    {
+        std::swap(f_data, rhs.f_data);
+        std::swap(f_compare, rhs.f_compare);
+    }
+
+    bool operator == (flat_map const & rhs) const
+    {
+        return f_data == rhs.f_data;
+    }
+
+    bool operator != (flat_map const & rhs) const
+    {
+        return f_data != rhs.f_data;
+    }
+
+private:
+    iterator find_hint(const_iterator hint, key_type const & key)
+    {
+        if((hint == cbegin() || f_compare(hint[-1].first, key))
+        && (hint == cend() || !f_compare(hint->first, key)))
+        {
+            return f_data.begin() + (hint - f_data.cbegin());
+        }
+        return lower_bound(key);
+    }
+
+    /** \brief Sort the new pairs and merge them with the old ones.
+     *
+     * \param[in] sorted  The number of pairs at the start of the vector
+     * which are already sorted and unique.
+     */
+    void normalize(size_type sorted)
+    {
+        value_compare const comp(f_compare);
+        auto const middle(f_data.begin() + sorted);
+        std::stable_sort(middle, f_data.end(), comp);
+        std::inplace_merge(f_data.begin(), middle, f_data.end(), comp);
+        f_data.erase(
+                  std::unique(
+                          f_data.begin()
+                        , f_data.end()
+                        , [&comp](value_type const & a, value_type const & b)
+                          {
+                              return !comp(a, b);
+                          })
+                , f_data.end());
+    }
+
+    container_type f_data = container_type();
+    Compare f_compare = Compare();
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
@@ -0,0 +1,505 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief A set implemented with a sorted vector.
+ *
+ * The flat_set keeps its elements in a sorted std::vector. Compared to
+ * an std::set, the lookups are binary searches in contiguous memory
+ * and iterating is reading an array, which is much more cache friendly.
+ * Inserting or erasing one element in the middle is O(n) so the
+ * container is best used for small sets and for sets which are built
+ * once and then searched many times. To build a large set, insert all
+ * the elements at once: they get appended, sorted, and the duplicates
+ * removed in one pass.
+ *
+ * The default comparator is `std::less<>` so an
+ * `flat_set<std::string>` can be searched with an `std::string_view`
+ * or a `char const *` without creating a temporary string.
+ *
+ * The iterators are random access iterators so the functions of
+ * sorted_intersection.h and empty_set_intersection() work with flat
+ * sets.
+ */
+
+// C++
+//
+#include    <algorithm>
+#include    <functional>
+#include    <initializer_list>
+#include    <iterator>
+#include    <type_traits>
+#include    <utility>
+#include    <vector>
+
+
+
+namespace snapdev
+{
+
+
+/** \brief Tag used to create flat containers from sorted data.
+ *
+ * When the input of a flat_set or flat_map constructor is already
+ * sorted and does not include duplicates, pass this tag so the
+ * constructor does not sort the data again.
+ */
+struct sorted_unique_t
+{
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+
+namespace detail
+{
+
+
+/** \brief Whether a comparator accepts keys of other types.
+ *
+ * \tparam Compare  The comparator to check.
+ */
+template<typename Compare, typename = void>
+constexpr bool is_transparent_v = false;
+
+template<typename Compare>
+constexpr bool is_transparent_v<Compare, std::void_t<typename Compare::is_transparent>> = true;
+
+
+} // namespace detail
+
+
+
+template<
+      typename Key
+    , typename Compare = std::less<>
+    , typename Allocator = std::allocator<Key>>
+class flat_set
+{
+public:
+    typedef Key                                             key_type;
+    typedef Key                                             value_type;
+    typedef Compare                                         key_compare;
+    typedef Compare                                         value_compare;
+    typedef std::vector<Key, Allocator>                     container_type;
+    typedef typename container_type::size_type              size_type;
+    typedef typename container_type::difference_type        difference_type;
+    typedef value_type const &                              reference;
+    typedef value_type const &                              const_reference;
+    typedef typename container_type::const_iterator         iterator;
+    typedef typename container_type::const_iterator         const_iterator;
+    typedef std::reverse_iterator<const_iterator>           reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>           const_reverse_iterator;
+
+    flat_set() = default;
+
+    explicit flat_set(Compare const & comp)
+        : f_compare(comp)
+    {
+    }
+
+    /** \brief Create a set from a vector.
+     *
+     * The vector gets sorted and its duplicates removed. When two
+     * elements are equivalent, the first one is kept.
+     *
+     * \param[in] data  The elements of the new set.
+     * \param[in] comp  The comparator.
+     */
+    explicit flat_set(container_type data, Compare const & comp = Compare())
+        : f_data(std::move(data))
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    /** \brief Create a set from a sorted vector without duplicates.
+     *
+     * The vector is used as is. It must be sorted with \p comp and not
+     * include duplicates.
+     *
+     * \param[in] data  The sorted elements of the new set.
+     * \param[in] comp  The comparator.
+     */
+    flat_set(sorted_unique_t, container_type data, Compare const & comp = Compare())
+        : f_data(std::move(data))
+        , f_compare(comp)
+    {
+    }
+
+    template<typename InputIt>
+    flat_set(InputIt first, InputIt last, Compare const & comp = Compare())
+        : f_data(first, last)
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    flat_set(std::initializer_list<value_type> list, Compare const & comp = Compare())
+        : f_data(list)
+        , f_compare(comp)
+    {
+        normalize(0);
+    }
+
+    const_iterator begin() const
+    {
+        return f_data.cbegin();
+    }
+
+    const_iterator end() const
+    {
+        return f_data.cend();
+    }
+
+    const_iterator cbegin() const
+    {
+        return f_data.cbegin();
+    }
+
+    const_iterator cend() const
+    {
+        return f_data.cend();
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return f_data.crbegin();
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return f_data.crend();
+    }
+
+    const_reverse_iterator crbegin() const
+    {
+        return f_data.crbegin();
+    }
+
+    const_reverse_iterator crend() const
+    {
+        return f_data.crend();
+    }
+
+    bool empty() const
+    {
+        return f_data.empty();
+    }
+
+    size_type size() const
+    {
+        return f_data.size();
+    }
+
+    size_type max_size() const
+    {
+        return f_data.max_size();
+    }
+
+    size_type capacity() const
+    {
+        return f_data.capacity();
+    }
+
+    void reserve(size_type size)
+    {
+        f_data.reserve(size);
+    }
+
+    void shrink_to_fit()
+    {
+        f_data.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        f_data.clear();
+    }
+
+    value_type const * data() const
+    {
+        return f_data.data();
+    }
+
+    key_compare key_comp() const
+    {
+        return f_compare;
+    }
+
+    value_compare value_comp() const
+    {
+        return f_compare;
+    }
+
+    /** \brief Insert one element.
+     *
+     * \param[in] value  The value to insert.
+     *
+     * \return The position of the element and true if it was inserted,
+     * false if an equivalent element already existed.
+     */
+    std::pair<iterator, bool> insert(value_type const & value)
+    {
+        return emplace_at(lower_bound(value), value);
+    }
+
+    std::pair<iterator, bool> insert(value_type && value)
+    {
+        return emplace_at(lower_bound(value), std::move(value));
+    }
+
+    /** \brief Insert one element using a hint.
+     *
+     * When \p hint is the position where the element goes (i.e. when
+     * inserting sorted data at the end), the insertion does not search
+     * the position. This is what std::inserter() uses so map_keyset()
+     * can fill a flat_set from a map in O(n).
+     *
+     * \param[in] hint  The expected position of the new element.
+     * \param[in] value  The value to insert.
+     *
+     * \return The position of the new or existing element.
+     */
+    iterator insert(const_iterator hint, value_type const & value)
+    {
+        return emplace_at(find_hint(hint, value), value).first;
+    }
+
+    iterator insert(const_iterator hint, value_type && value)
+    {
+        const_iterator const pos(find_hint(hint, value));
+        return emplace_at(pos, std::move(value)).first;
+    }
+
+    /** \brief Insert many elements at once.
+     *
+     * The elements get appended, sorted, merged with the existing
+     * elements, and the duplicates removed. This is O(n log n) for the
+     * whole batch instead of O(n) per element. Existing elements are
+     * kept over new equivalent ones.
+     *
+     * \param[in] first  The first element to insert.
+     * \param[in] last  The end of the elements to insert.
+     */
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        size_type const old_size(f_data.size());
+        f_data.insert(f_data.end(), first, last);
+        normalize(old_size);
+    }
+
+    void insert(std::initializer_list<value_type> list)
+    {
+        insert(list.begin(), list.end());
+    }
+
+    template<typename ...ARGS>
+    std::pair<iterator, bool> emplace(ARGS && ... args)
+    {
+        value_type value(std::forward<ARGS>(args)...);
+        const_iterator const pos(lower_bound(value));
+        return emplace_at(pos, std::move(value));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return f_data.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return f_data.erase(first, last);
+    }
+
+    size_type erase(key_type const & key)
+    {
+        const_iterator const it(find(key));
+        if(it == end())
+        {
+            return 0;
+        }
+        f_data.erase(it);
+        return 1;
+    }
+
+    /** \brief Remove the elements matching a predicate.
+     *
+     * \param[in] pred  The predicate, return true to remove the element.
+     *
+     * \return The number of elements removed.
+     */
+    template<typename Predicate>
+    size_type erase_if(Predicate pred)
+    {
+        size_type const old_size(f_data.size());
+        f_data.erase(std::remove_if(f_data.begin(), f_data.end(), pred), f_data.end());
+        return old_size - f_data.size();
+    }
+
+    template<typename K>
+    const_iterator lower_bound(K const & key) const
+    {
+        return std::lower_bound(f_data.begin(), f_data.end(), key, f_compare);
+    }
+
+    template<typename K>
+    const_iterator upper_bound(K const & key) const
+    {
+        return std::upper_bound(f_data.begin(), f_data.end(), key, f_compare);
+    }
+
+    template<typename K>
+    std::pair<const_iterator, const_iterator>
+    equal_range(K const & key) const
+    {
+        const_iterator const it(find(key));
+        return std::make_pair(it, it == end() ? it : it + 1);
+    }
+
+    /** \brief Search an element.
+     *
+     * The \p key may be of a type other than Key when the comparator is
+     * transparent, which is the case of the default `std::less<>`.
+     *
+     * \param[in] key  The key to search.
+     *
+     * \return An iterator to the element or end().
+     */
+    template<typename K>
+    const_iterator find(K const & key) const
+    {
+        static_assert(
+              std::is_convertible_v<K const &, Key const &>
+           || detail::is_transparent_v<Compare>
+           , "heterogeneous lookups require a transparent comparator");
+
+        const_iterator const it(lower_bound(key));
+        if(it != end() && !f_compare(key, *it))
+        {
+            return it;
+        }
+        return end();
+    }
+
+    template<typename K>
+    bool contains(K const & key) const
+    {
+        return find(key) != end();
+    }
+
+    template<typename K>
+    size_type count(K const & key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    /** \brief Move the vector out of the set.
+     *
+     * The set is empty on return. The vector is sorted and has no
+     * duplicates.
+     *
+     * \return The vector of elements.
+     */
+    container_type extract()
+    {
+        container_type result(std::move(f_data));
+        f_data.clear();
+        return result;
+    }
+
+    /** \brief Replace the vector of elements.
+     *
+     * The \p data must be sorted and not include duplicates.
+     *
+     * \param[in] data  The new elements.
+     */
+    void replace(container_type && data)
+    {
+        f_data = std::move(data);
+    }
+
+    void swap(flat_set & rhs)
+    {
+        std::swap(f_data, rhs.f_data);
+        std::swap(f_compare, rhs.f_compare);
+    }
+
+    bool operator == (flat_set const & rhs) const
+    {
+        return f_data == rhs.f_data;
+    }
+
+    bool operator != (flat_set const & rhs) const
+    {
+        return f_data != rhs.f_data;
+    }
+
+private:
+    template<typename V>
+    std::pair<iterator, bool> emplace_at(const_iterator pos, V && value)
+    {
+        if(pos != end() && !f_compare(value, *pos))
+        {
+            return std::make_pair(pos, false);
+        }
+        return std::make_pair(f_data.insert(pos, std::forward<V>(value)), true);
+    }
+
+    const_iterator find_hint(const_iterator hint, value_type const & value) const
+    {
+        if((hint == begin() || f_compare(hint[-1], value))
+        && (hint == end() || !f_compare(*hint, value)))
+        {
+            return hint;
+        }
+        return lower_bound(value);
+    }
+
+    /** \brief Sort the new elements and merge them with the old ones.
+     *
+     * \param[in] sorted  The number of elements at the start of the vector
+     * which are already sorted and unique.
+     */
+    void normalize(size_type sorted)
+    {
+        auto const middle(f_data.begin() + sorted);
+        std::stable_sort(middle, f_data.end(), f_compare);
+        std::inplace_merge(f_data.begin(), middle, f_data.end(), f_compare);
+        f_data.erase(
+                  std::unique(
+                          f_data.begin()
+                        , f_data.end()
+                        , [this](value_type const & a, value_type const & b)
+                          {
+                              return !f_compare(a, b);
+                          })
+                , f_data.end());
+    }
+
+    container_type f_data = container_type();
+    Compare f_compare = Compare();
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
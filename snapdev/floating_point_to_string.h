@@ -18,93 +18,294 @@
 #pragma once
 
 /** \file
- * \brief Create a list of files using glob().
+ * \brief Convert a floating point number to a string.
  *
- * This template allows you to insert filenames from the output of a glob()
- * call to an STL container.
+ * The functions found here convert floating points to the shortest
+ * string which, once parsed back, gives the exact same value. The
+ * conversion is done with std::to_chars() so it does not depend on
+ * the locale and does not lose precision on small numbers. A fixed
+ * precision mode is also available.
+ *
+ * NaN is output as "NaN" and infinities as "Infinity" and "-Infinity".
  */
 
-// snapdev
-//
-//#include    "snapdev/pathinfo.h"
-//#include    "snapdev/raii_generic_deleter.h"
-
-
 // C++
 //
+#include    <charconv>
 #include    <cmath>
-//#include    <memory>
+#include    <cstring>
+#include    <limits>
 #include    <string>
 
 
-// C
-//
-//#include    <limits.h>
-//#include    <stdlib.h>
 
+namespace snapdev
+{
 
 
-namespace snapdev
+namespace detail
 {
 
 
+/** \brief Copy a string to the output buffer.
+ *
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] str  The string to copy.
+ *
+ * \return A pointer after the copied string or nullptr if it does not fit.
+ */
+inline char * floating_point_copy(char * first, char * last, char const * str)
+{
+    std::size_t const size(strlen(str));
+    if(static_cast<std::size_t>(last - first) < size)
+    {
+        return nullptr;
+    }
+    memcpy(first, str, size);
+    return first + size;
+}
 
-template<
-    typename F,
-    class CharT,
-    class Traits = std::char_traits<CharT>,
-    class Allocator = std::allocator<CharT>>
-std::basic_string<CharT, Traits, Allocator> floating_point_to_string(F value, bool keep_period = true)
+
+/** \brief Output the special values.
+ *
+ * This function outputs NaN and the infinities.
+ *
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[out] end  The end of the output or nullptr if it does not fit.
+ *
+ * \return true if \p value was a special value.
+ */
+template<typename F>
+bool floating_point_special(char * first, char * last, F value, char * & end)
 {
+    if(std::isnan(value))
+    {
+        end = floating_point_copy(first, last, "NaN");
+        return true;
+    }
+    if(std::isinf(value))
+    {
+        end = floating_point_copy(first, last, std::signbit(value) ? "-Infinity" : "Infinity");
+        return true;
+    }
+    return false;
+}
+
+
+} // namespace detail
+
+
+
+/** \brief Size of a buffer large enough for floating_point_to_chars().
+ *
+ * The shortest representation of any float, double, or long double
+ * fits in this many characters.
+ */
+constexpr std::size_t floating_point_to_chars_max_size = 64;
+
+
+/** \brief Convert a floating point to its shortest representation.
+ *
+ * This function writes the shortest string which parses back to
+ * exactly \p value in the buffer defined by \p first and \p last. It
+ * does not add a '\0'.
+ *
+ * Numbers from 1e-5 (included) to 1e16 (excluded), in absolute value,
+ * are written in fixed notation (i.e. "100000.0", "0.0001"). Numbers
+ * outside of that range are written in scientific notation (i.e.
+ * "1e+16", "1.5e-07"). This way round numbers do not switch notation
+ * depending on which one happens to be shorter.
+ *
+ * Zero is always output as "0.0" (the sign is ignored), NaN as "NaN"
+ * and the infinities as "Infinity" and "-Infinity".
+ *
+ * When \p keep_period is true and the number is an integer, ".0" is
+ * appended so the result still looks like a floating point (i.e. "1.0"
+ * instead of "1"). In scientific notation, the ".0" is added to the
+ * mantissa (i.e. "1.0e+20").
+ *
+ * If the buffer is too small, the function returns nullptr. A buffer
+ * of floating_point_to_chars_max_size characters is always large enough.
+ *
+ * \tparam F  The type of floating point.
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] keep_period  Whether to keep ".0" on integers.
+ *
+ * \return A pointer after the last character written or nullptr.
+ */
+template<typename F>
+char * floating_point_to_chars(char * first, char * last, F value, bool keep_period = true)
+{
+    char * end(nullptr);
+    if(detail::floating_point_special(first, last, value, end))
+    {
+        return end;
+    }
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wfloat-equal"
-    if(std::isnan(value))
+    if(value == 0.0)
     {
-        return std::basic_string<CharT, Traits, Allocator>("NaN");
+        return detail::floating_point_copy(first, last, keep_period ? "0.0" : "0");
     }
-    else if(value == 0.0)
+#pragma GCC diagnostic pop
+
+    F const magnitude(std::fabs(value));
+    bool const fixed(magnitude >= static_cast<F>(1e-5) && magnitude < static_cast<F>(1e16));
+    std::to_chars_result const r(std::to_chars(
+              first
+            , last
+            , value
+            , fixed ? std::chars_format::fixed : std::chars_format::scientific));
+    if(r.ec != std::errc())
     {
-        if(keep_period)
-        {
-            return std::basic_string<CharT, Traits, Allocator>("0.0");
-        }
-        return std::basic_string<CharT, Traits, Allocator>("0");
+        return nullptr;
     }
-    else if(std::isinf(value))
+    end = r.ptr;
+
+    if(keep_period)
     {
-        if(std::signbit(value))
-        {
-            return std::basic_string<CharT, Traits, Allocator>("-Infinity");
-        }
-        else
+        char * mantissa_end(static_cast<char *>(memchr(first, 'e', end - first)));
+        if(mantissa_end == nullptr)
         {
-            return std::basic_string<CharT, Traits, Allocator>("Infinity");
+            mantissa_end = end;
         }
-    }
-    else
-    {
-        std::basic_string<CharT, Traits, Allocator> str(std::to_string(value));
-        if(str.find('.') != str.npos)
+        if(memchr(first, '.', mantissa_end - first) == nullptr)
         {
-            while(str.back() == '0')
-            {
-                str.pop_back();
-            }
-            if(str.back() == '.')
+            if(last - end < 2)
             {
-                if(keep_period)
-                {
-                    str += '0';
-                }
-                else
-                {
-                    str.pop_back();
-                }
+                return nullptr;
             }
+            memmove(mantissa_end + 2, mantissa_end, end - mantissa_end);
+            mantissa_end[0] = '.';
+            mantissa_end[1] = '0';
+            end += 2;
         }
-        return str;
+    }
+
+    return end;
+}
+
+
+/** \brief Convert a floating point with a fixed number of decimals.
+ *
+ * This function writes \p value in fixed notation with exactly
+ * \p precision digits after the period, like printf("%.*f") in the "C"
+ * locale. When \p precision is 0, the period is not output.
+ *
+ * Zero is output without a sign, NaN as "NaN" and the infinities as
+ * "Infinity" and "-Infinity".
+ *
+ * Large numbers require a large buffer (up to 309 digits for a double
+ * plus the sign, the period, and the decimals). If the buffer is too
+ * small, the function returns nullptr.
+ *
+ * \tparam F  The type of floating point.
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] precision  The number of digits after the period.
+ *
+ * \return A pointer after the last character written or nullptr.
+ */
+template<typename F>
+char * floating_point_to_chars_fixed(char * first, char * last, F value, int precision)
+{
+    char * end(nullptr);
+    if(detail::floating_point_special(first, last, value, end))
+    {
+        return end;
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wfloat-equal"
+    if(value == 0.0)
+    {
+        // ignore the sign of -0.0
+        //
+        value = 0.0;
     }
 #pragma GCC diagnostic pop
+
+    std::to_chars_result const r(std::to_chars(
+              first
+            , last
+            , value
+            , std::chars_format::fixed
+            , precision < 0 ? 0 : precision));
+    if(r.ec != std::errc())
+    {
+        return nullptr;
+    }
+
+    return r.ptr;
+}
+
+
+/** \brief Convert a floating point to its shortest string.
+ *
+ * This function returns the shortest string which parses back to
+ * exactly \p value. See floating_point_to_chars() for details.
+ *
+ * \tparam F  The type of floating point.
+ * \tparam CharT  The type of characters of the output string.
+ * \param[in] value  The value to convert.
+ * \param[in] keep_period  Whether to keep ".0" on integers.
+ *
+ * \return The string representing \p value.
+ */
+template<
+    typename F,
+    class CharT = char,
+    class Traits = std::char_traits<CharT>,
+    class Allocator = std::allocator<CharT>>
+std::basic_string<CharT, Traits, Allocator> floating_point_to_string(F value, bool keep_period = true)
+{
+    char buf[floating_point_to_chars_max_size];
+    char * end(floating_point_to_chars(buf, buf + sizeof(buf), value, keep_period));
+    return std::basic_string<CharT, Traits, Allocator>(buf, end);
+}
+
+
+/** \brief Convert a floating point to a string with a fixed precision.
+ *
+ * This function returns \p value with exactly \p precision digits
+ * after the period. See floating_point_to_chars_fixed() for details.
+ *
+ * \tparam F  The type of floating point.
+ * \tparam CharT  The type of characters of the output string.
+ * \param[in] value  The value to convert.
+ * \param[in] precision  The number of digits after the period.
+ *
+ * \return The string representing \p value.
+ */
+template<
+    typename F,
+    class CharT = char,
+    class Traits = std::char_traits<CharT>,
+    class Allocator = std::allocator<CharT>>
+std::basic_string<CharT, Traits, Allocator> floating_point_to_string_fixed(F value, int precision)
+{
+    char buf[floating_point_to_chars_max_size];
+    char * end(floating_point_to_chars_fixed(buf, buf + sizeof(buf), value, precision));
+    if(end != nullptr)
+    {
+        return std::basic_string<CharT, Traits, Allocator>(buf, end);
+    }
+
+    // very large numbers or precision
+    //
+    std::string large(
+              std::numeric_limits<F>::max_exponent10 + 3
+                + static_cast<std::size_t>(precision < 0 ? 0 : precision)
+            , '\0');
+    end = floating_point_to_chars_fixed(large.data(), large.data() + large.length(), value, precision);
+    return std::basic_string<CharT, Traits, Allocator>(large.data(), end);
 }
 
 
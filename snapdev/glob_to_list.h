@@ -26,6 +26,7 @@
 
 // snapdev
 //
+#include    "snapdev/concat_to_string.h"
 #include    "snapdev/pathinfo.h"
 #include    "snapdev/raii_generic_deleter.h"
 
@@ -756,17 +757,17 @@ private:
             switch(r)
             {
             case GLOB_NOSPACE:
-                f_last_error_message =
+                f_last_error_message = concat_to_string(
                           "glob(\""
-                        + path
-                        + "\") did not have enough memory to allocate its buffers.";
+                        , path
+                        , "\") did not have enough memory to allocate its buffers.");
                 break;
 
             case GLOB_ABORTED:
-                f_last_error_message =
+                f_last_error_message = concat_to_string(
                           "glob(\""
-                        + path
-                        + "\") was aborted after a read error.";
+                        , path
+                        , "\") was aborted after a read error.");
                 break;
 
             case GLOB_NOMATCH:
@@ -774,18 +775,20 @@ private:
                 {
                     return true;
                 }
-                f_last_error_message = "glob(\""
-                        + path
-                        + "\") could not find any files matching the pattern.";
+                f_last_error_message = concat_to_string(
+                          "glob(\""
+                        , path
+                        , "\") could not find any files matching the pattern.");
                 f_last_error_errno = ENOENT;
                 break;
 
             default:
-                f_last_error_message = "unknown glob(\""
-                        + path
-                        + "\") error code: "
-                        + std::to_string(r)
-                        + ".";
+                f_last_error_message = concat_to_string(
+                          "unknown glob(\""
+                        , path
+                        , "\") error code: "
+                        , r
+                        , ".");
                 break;
 
             }
@@ -26,6 +26,10 @@
  *
  * Here we can convert a buffer of any length to hexadecimal and vice
  * versa. You can also use this implementation to covert just one byte.
+ *
+ * The buffer conversions are table driven and, when SSE2 is available,
+ * process 16 bytes at a time. The pointer and std::span versions write
+ * to a caller buffer so no allocation is necessary.
  */
 
 // libexcept
@@ -36,9 +40,19 @@
 // C++
 //
 #include    <algorithm>
+#include    <array>
 #include    <climits>
 #include    <cstdint>
 #include    <iomanip>
+#include    <span>
+#include    <string_view>
+
+
+// C
+//
+#if defined(__SSE2__)
+#include    <emmintrin.h>
+#endif
 
 
 
@@ -148,6 +162,123 @@ int hexdigit_to_number(charT c)
 }
 
 
+namespace detail
+{
+
+
+/** \brief The hexadecimal digits in lowercase and uppercase.
+ *
+ * The bin_to_hex() functions use these tables to convert a nibble to
+ * a character.
+ */
+inline constexpr char const g_hex_digits[2][16] =
+{
+    { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' },
+    { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' },
+};
+
+
+/** \brief Table to convert an hexadecimal character to a number.
+ *
+ * The hex_to_bin() functions use this table to convert a character to
+ * a number. Characters which are not hexadecimal digits are set to 0xFF.
+ */
+inline constexpr std::array<std::uint8_t, 256> const g_hex_values = []()
+{
+    std::array<std::uint8_t, 256> values{};
+    for(int c(0); c < 256; ++c)
+    {
+        values[c] = 0xFF;
+    }
+    for(int c('0'); c <= '9'; ++c)
+    {
+        values[c] = c - '0';
+    }
+    for(int c('a'); c <= 'f'; ++c)
+    {
+        values[c] = c - ('a' - 10);
+        values[c - 0x20] = c - ('a' - 10);
+    }
+    return values;
+}();
+
+
+} // namespace detail
+
+
+/** \brief Transform binary data to hexadecimal in a caller buffer.
+ *
+ * This function writes exactly `binary.size() * 2` hexadecimal digits
+ * to \p out. No '\0' is added at the end.
+ *
+ * \code
+ *     std::array<std::uint8_t, 32> const hash(...);
+ *     char buf[64];
+ *     snapdev::bin_to_hex(hash, buf);
+ * \endcode
+ *
+ * \param[in] binary  The bytes to convert.
+ * \param[out] out  The output buffer, at least `binary.size() * 2` chars.
+ * \param[in] uppercase  If true, use uppercase letters for a-f.
+ *
+ * \return A pointer just after the last character written in \p out.
+ */
+inline char * bin_to_hex(
+      std::span<std::uint8_t const> binary
+    , char * out
+    , bool uppercase = false)
+{
+    std::uint8_t const * in(binary.data());
+    std::size_t size(binary.size());
+
+#if defined(__SSE2__)
+    __m128i const mask(_mm_set1_epi8(0x0F));
+    __m128i const nine(_mm_set1_epi8(9));
+    __m128i const zero(_mm_set1_epi8('0'));
+    __m128i const letters(_mm_set1_epi8(uppercase ? 'A' - '0' - 10 : 'a' - '0' - 10));
+    for(; size >= 16; size -= 16, in += 16, out += 32)
+    {
+        __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(in)));
+        __m128i const hi(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i const lo(_mm_and_si128(v, mask));
+        __m128i n1(_mm_unpacklo_epi8(hi, lo));
+        __m128i n2(_mm_unpackhi_epi8(hi, lo));
+        n1 = _mm_add_epi8(_mm_add_epi8(n1, zero), _mm_and_si128(_mm_cmpgt_epi8(n1, nine), letters));
+        n2 = _mm_add_epi8(_mm_add_epi8(n2, zero), _mm_and_si128(_mm_cmpgt_epi8(n2, nine), letters));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), n1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), n2);
+    }
+#endif
+
+    char const * digits(detail::g_hex_digits[uppercase ? 1 : 0]);
+    for(; size > 0; --size, ++in, out += 2)
+    {
+        out[0] = digits[*in >> 4];
+        out[1] = digits[*in & 15];
+    }
+
+    return out;
+}
+
+
+/** \brief Transform binary data to an hexadecimal string.
+ *
+ * This function transforms a span of bytes to a string of hexadecimal
+ * digits. The output string is exactly 2x the size of the input.
+ *
+ * \param[in] binary  The bytes to convert.
+ * \param[in] uppercase  If true, use uppercase letters for a-f.
+ *
+ * \return The hexademical representation of the input bytes.
+ */
+inline std::string bin_to_hex(std::span<std::uint8_t const> binary, bool uppercase = false)
+{
+    std::string result(binary.size() * 2, '\0');
+    bin_to_hex(binary, result.data(), uppercase);
+    return result;
+}
+
+
 /** \brief Transform a binary string to hexadecimal.
  *
  * This function transforms a string of binary bytes (any value from 0x00
@@ -165,25 +296,85 @@ int hexdigit_to_number(charT c)
  */
 inline std::string bin_to_hex(std::string const & binary, bool uppercase = false)
 {
-    if(binary.empty())
+    return bin_to_hex(
+              std::span<std::uint8_t const>(
+                      reinterpret_cast<std::uint8_t const *>(binary.data())
+                    , binary.length())
+            , uppercase);
+}
+
+
+/** \brief Convert an hexadecimal string to binary in a caller buffer.
+ *
+ * This function converts the hexadecimal digits of \p hex to bytes
+ * written to \p out. The output buffer must be at least half the size
+ * of the input.
+ *
+ * The validation is the same as the hex_to_bin() string version: the
+ * length must be even and every character must be an hexadecimal digit.
+ * If an error is detected, some bytes may already have been written to
+ * \p out.
+ *
+ * \exception hexadecimal_string_invalid_parameter
+ * The length of \p hex is odd or one of the characters is not an
+ * hexadecimal digit.
+ *
+ * \param[in] hex  The hexadecimal string of characters.
+ * \param[out] out  The output buffer, at least `hex.length() / 2` bytes.
+ *
+ * \return A pointer just after the last byte written in \p out.
+ */
+inline std::uint8_t * hex_to_bin(std::string_view const & hex, std::uint8_t * out)
+{
+    if((hex.length() & 1) != 0)
     {
-        return std::string();
+        throw hexadecimal_string_invalid_parameter("the hex parameter must have an even size.");
     }
 
-    std::string result;
+    char const * in(hex.data());
+    std::size_t size(hex.length());
 
-    result.reserve(binary.length() * 2);
+#if defined(__SSE2__)
+    for(; size >= 16; size -= 16, in += 16, out += 8)
+    {
+        __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(in)));
+        __m128i const lower(_mm_or_si128(v, _mm_set1_epi8(0x20)));
+        __m128i const is_digit(_mm_and_si128(
+                  _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1))
+                , _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))));
+        __m128i const is_letter(_mm_and_si128(
+                  _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1))
+                , _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1))));
+        if(_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF)
+        {
+            // let the scalar loop find the invalid character
+            //
+            break;
+        }
+        __m128i const values(_mm_or_si128(
+                  _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0')))
+                , _mm_andnot_si128(is_digit, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)))));
+        __m128i const bytes(_mm_or_si128(
+                  _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 4)
+                , _mm_srli_epi16(values, 8)));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(bytes, bytes));
+    }
+#endif
 
-    std::for_each(
-              binary.begin()
-            , binary.end()
-            , [&result,uppercase](char const & c)
-            {
-                result.push_back(to_hex((c >> 4) & 15, uppercase));
-                result.push_back(to_hex(c & 15, uppercase));
-            });
+    for(; size > 0; size -= 2, in += 2, ++out)
+    {
+        std::uint8_t const hi(detail::g_hex_values[static_cast<std::uint8_t>(in[0])]);
+        std::uint8_t const lo(detail::g_hex_values[static_cast<std::uint8_t>(in[1])]);
+        if((hi | lo) == 0xFF)
+        {
+            // generate the same error as hexdigit_to_number()
+            //
+            hexdigit_to_number(hi == 0xFF ? in[0] : in[1]);
+        }
+        *out = (hi << 4) | lo;
+    }
 
-    return result;
+    return out;
 }
 
 
@@ -210,20 +401,8 @@ inline std::string bin_to_hex(std::string const & binary, bool uppercase = false
  */
 inline std::string hex_to_bin(std::string const & hex)
 {
-    if((hex.length() & 1) != 0)
-    {
-        throw hexadecimal_string_invalid_parameter("the hex parameter must have an even size.");
-    }
-
-    std::string result;
-
-    for(char const * s(hex.c_str()); *s != '\0'; s += 2)
-    {
-        char value = static_cast<char>(hexdigit_to_number(s[0]) * 16
-                                     + hexdigit_to_number(s[1]));
-        result.push_back(value);
-    }
-
+    std::string result(hex.length() / 2, '\0');
+    hex_to_bin(hex, reinterpret_cast<std::uint8_t *>(result.data()));
     return result;
 }
 
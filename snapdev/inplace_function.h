@@ -0,0 +1,277 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief A function wrapper which never allocates memory.
+ *
+ * The std::function object allocates its callable on the heap whenever
+ * the callable is larger than a couple of pointers (i.e. a lambda
+ * capturing a few variables). The inplace_function saves the callable
+ * in a buffer of a fixed size within the object itself. A callable
+ * which does not fit is a compile time error instead of an allocation.
+ *
+ * This is useful as the value type of a callback_manager: the callbacks
+ * can then be added and called without allocating any memory for them.
+ *
+ * \code
+ *     typedef snapdev::inplace_function<bool(int, std::string const &)> callback_t;
+ *     snapdev::callback_manager<callback_t> callbacks;
+ *
+ *     callbacks.add_callback([this, &counter](int id, std::string const & name)
+ *         {
+ *             ...
+ *             return true;
+ *         });
+ * \endcode
+ */
+
+// C++
+//
+#include    <cstddef>
+#include    <functional>
+#include    <new>
+#include    <type_traits>
+#include    <utility>
+
+
+
+namespace snapdev
+{
+
+
+
+/** \brief The default size of the inplace_function buffer.
+ *
+ * This is enough for a lambda capturing up to four pointers or
+ * references.
+ */
+constexpr std::size_t const INPLACE_FUNCTION_DEFAULT_CAPACITY = sizeof(void *) * 4;
+
+
+
+template<
+      typename Signature
+    , std::size_t CAPACITY = INPLACE_FUNCTION_DEFAULT_CAPACITY
+    , std::size_t ALIGNMENT = alignof(std::max_align_t)>
+class inplace_function;
+
+
+/** \brief A function wrapper with a fixed size buffer.
+ *
+ * The class works like an std::function except that the callable is
+ * saved in a buffer of \p CAPACITY bytes within the object. The
+ * callable must be copy constructible and fit in that buffer.
+ *
+ * \tparam R  The type returned by the function.
+ * \tparam ARGS  The types of the function parameters.
+ * \tparam CAPACITY  The size of the buffer.
+ * \tparam ALIGNMENT  The alignment of the buffer.
+ */
+template<
+      typename R
+    , typename ... ARGS
+    , std::size_t CAPACITY
+    , std::size_t ALIGNMENT>
+class inplace_function<R(ARGS...), CAPACITY, ALIGNMENT>
+{
+public:
+    typedef R                   result_type;
+
+    static constexpr std::size_t const capacity = CAPACITY;
+
+    inplace_function() = default;
+
+    inplace_function(std::nullptr_t)
+    {
+    }
+
+    /** \brief Save a callable in this function.
+     *
+     * The callable is copied or moved in the buffer of the object.
+     *
+     * \tparam F  The type of callable.
+     * \param[in] f  The callable to save.
+     */
+    template<
+          typename F
+        , typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, inplace_function>
+                && std::is_invocable_r_v<R, std::decay_t<F> &, ARGS...>>>
+    inplace_function(F && f)
+    {
+        typedef std::decay_t<F> functor_t;
+
+        static_assert(sizeof(functor_t) <= CAPACITY
+            , "the callable is too large for this inplace_function, increase its CAPACITY");
+        static_assert(ALIGNMENT % alignof(functor_t) == 0
+            , "the callable alignment is not compatible with this inplace_function ALIGNMENT");
+        static_assert(std::is_copy_constructible_v<functor_t>
+            , "the callable of an inplace_function must be copy constructible");
+
+        ::new(f_buffer) functor_t(std::forward<F>(f));
+        f_vtable = get_vtable<functor_t>();
+    }
+
+    inplace_function(inplace_function const & rhs)
+        : f_vtable(rhs.f_vtable)
+    {
+        if(f_vtable != nullptr)
+        {
+            f_vtable->f_copy(f_buffer, rhs.f_buffer);
+        }
+    }
+
+    inplace_function(inplace_function && rhs)
+        : f_vtable(rhs.f_vtable)
+    {
+        if(f_vtable != nullptr)
+        {
+            f_vtable->f_move(f_buffer, rhs.f_buffer);
+        }
+    }
+
+    ~inplace_function()
+    {
+        reset();
+    }
+
+    inplace_function & operator = (inplace_function const & rhs)
+    {
+        if(this != &rhs)
+        {
+            reset();
+            if(rhs.f_vtable != nullptr)
+            {
+                rhs.f_vtable->f_copy(f_buffer, rhs.f_buffer);
+                f_vtable = rhs.f_vtable;
+            }
+        }
+        return *this;
+    }
+
+    inplace_function & operator = (inplace_function && rhs)
+    {
+        if(this != &rhs)
+        {
+            reset();
+            if(rhs.f_vtable != nullptr)
+            {
+                rhs.f_vtable->f_move(f_buffer, rhs.f_buffer);
+                f_vtable = rhs.f_vtable;
+            }
+        }
+        return *this;
+    }
+
+    inplace_function & operator = (std::nullptr_t)
+    {
+        reset();
+        return *this;
+    }
+
+    explicit operator bool () const
+    {
+        return f_vtable != nullptr;
+    }
+
+    /** \brief Call the function.
+     *
+     * \exception std::bad_function_call
+     * The function is empty.
+     *
+     * \param[in] args  The arguments passed to the callable.
+     *
+     * \return The value returned by the callable.
+     */
+    R operator () (ARGS ... args) const
+    {
+        if(f_vtable == nullptr)
+        {
+            throw std::bad_function_call();
+        }
+        return f_vtable->f_invoke(f_buffer, std::forward<ARGS>(args)...);
+    }
+
+    void swap(inplace_function & rhs)
+    {
+        inplace_function tmp(std::move(rhs));
+        rhs = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+private:
+    struct vtable_t
+    {
+        R (*f_invoke)(void * object, ARGS && ... args);
+        void (*f_copy)(void * dest, void const * src);
+        void (*f_move)(void * dest, void * src);
+        void (*f_destroy)(void * object);
+    };
+
+    template<typename F>
+    static vtable_t const * get_vtable()
+    {
+        static constexpr vtable_t const vtable =
+        {
+            .f_invoke = [](void * object, ARGS && ... args) -> R
+                {
+                    if constexpr(std::is_void_v<R>)
+                    {
+                        std::invoke(*static_cast<F *>(object), std::forward<ARGS>(args)...);
+                    }
+                    else
+                    {
+                        return std::invoke(*static_cast<F *>(object), std::forward<ARGS>(args)...);
+                    }
+                },
+            .f_copy = [](void * dest, void const * src)
+                {
+                    ::new(dest) F(*static_cast<F const *>(src));
+                },
+            .f_move = [](void * dest, void * src)
+                {
+                    ::new(dest) F(std::move(*static_cast<F *>(src)));
+                },
+            .f_destroy = [](void * object)
+                {
+                    static_cast<F *>(object)->~F();
+                },
+        };
+        return &vtable;
+    }
+
+    void reset()
+    {
+        if(f_vtable != nullptr)
+        {
+            f_vtable->f_destroy(f_buffer);
+            f_vtable = nullptr;
+        }
+    }
+
+    // the buffer is mutable since, like std::function, calling a const
+    // function may modify the state of the callable
+    //
+    alignas(ALIGNMENT) mutable std::byte f_buffer[CAPACITY];
+    vtable_t const *            f_vtable = nullptr;
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
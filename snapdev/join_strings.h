@@ -30,15 +30,33 @@
  *
  * If you want to do concatenation at compile time, use the string_view
  * templates instead of an std::string container.
+ *
+ * When the result is only going to be written to a stream, a file, or a
+ * socket, the streaming versions avoid building the result string: the
+ * tokens and separators are directly written to an std::ostream, an output
+ * iterator (which can be a caller buffer), or described by an array of
+ * iovec structures ready for writev().
  */
 
 // C++
 //
 #include    <algorithm>
 #include    <array>
+#include    <iterator>
 #include    <numeric>
+#include    <ostream>
 #include    <string>
 #include    <string_view>
+#include    <type_traits>
+#include    <vector>
+
+
+// C
+//
+#include    <errno.h>
+#include    <limits.h>
+#include    <sys/uio.h>
+#include    <unistd.h>
 
 
 
@@ -102,10 +120,10 @@ typename ContainerT::value_type join_strings(
         std::for_each(
                   std::next(tokens.begin())
                 , tokens.end()
-                , [separator, &result](auto const & s)
+                , [&separator, &result](auto const & s)
                         {
-                            static_cast<std::string &>(result) += static_cast<std::string const &>(separator)
-                                                                + static_cast<std::string const &>(s);
+                            static_cast<std::string &>(result) += static_cast<std::string const &>(separator);
+                            static_cast<std::string &>(result) += static_cast<std::string const &>(s);
                         });
     }
 
@@ -148,9 +166,10 @@ typename std::iterator_traits<InputIt>::value_type join_strings(
         std::for_each(
                   std::next(first)
                 , last
-                , [separator, &result](auto const & s)
+                , [&separator, &result](auto const & s)
                         {
-                            result += separator + s;
+                            result += separator;
+                            result += s;
                         });
     }
 
@@ -158,6 +177,288 @@ typename std::iterator_traits<InputIt>::value_type join_strings(
 }
 
 
+/** \brief Compute the size of the joined strings.
+ *
+ * This function returns the number of characters that join_strings()
+ * would return for the same \p tokens and \p separator. It can be used
+ * to allocate a buffer before calling join_strings_to() with a pointer.
+ *
+ * \tparam ContainerT  The type of container of strings.
+ * \tparam SeparatorT  The type of the separator.
+ * \param[in] tokens  The container of strings.
+ * \param[in] separator  The separator added between each string.
+ *
+ * \return The size of the joined strings.
+ */
+template<class ContainerT, class SeparatorT>
+std::size_t join_strings_size(
+        ContainerT const & tokens
+      , SeparatorT const & separator)
+{
+    if(tokens.empty())
+    {
+        return 0;
+    }
+
+    return std::accumulate(
+              tokens.begin()
+            , tokens.end()
+            , std::basic_string_view<typename ContainerT::value_type::value_type>(separator).length() * (tokens.size() - 1)
+            , [](std::size_t const & sum, auto const & str)
+                {
+                    return sum + str.size();
+                });
+}
+
+
+/** \brief Join strings directly in an output stream.
+ *
+ * This function writes the \p tokens to \p out with \p separator between
+ * each string. No intermediate string gets created.
+ *
+ * The strings are written with the unformatted write() function so
+ * std::setw() and similar manipulators have no effect.
+ *
+ * \tparam CharT  The type of character of the stream.
+ * \tparam Traits  The traits of the stream.
+ * \tparam ContainerT  The type of container of strings.
+ * \tparam SeparatorT  The type of the separator.
+ * \param[in,out] out  The stream where the strings get written.
+ * \param[in] tokens  The container of strings.
+ * \param[in] separator  The separator to add between each string.
+ *
+ * \return A reference to \p out.
+ */
+template<class CharT, class Traits, class ContainerT, class SeparatorT>
+std::basic_ostream<CharT, Traits> & join_strings(
+        std::basic_ostream<CharT, Traits> & out
+      , ContainerT const & tokens
+      , SeparatorT const & separator)
+{
+    std::basic_string_view<CharT, Traits> const sep(separator);
+    bool first(true);
+    for(auto const & s : tokens)
+    {
+        if(first)
+        {
+            first = false;
+        }
+        else
+        {
+            out.write(sep.data(), sep.length());
+        }
+        std::basic_string_view<CharT, Traits> const v(s);
+        out.write(v.data(), v.length());
+    }
+
+    return out;
+}
+
+
+/** \brief Join strings directly in an output iterator.
+ *
+ * This function copies the characters of the \p tokens to \p out with
+ * the \p separator between each string. The iterator can be an
+ * std::back_inserter() or a pointer to a caller buffer. In the latter
+ * case, the buffer must be at least join_strings_size() characters.
+ *
+ * \code
+ *     std::vector<char> buffer(snapdev::join_strings_size(tokens, ", "));
+ *     snapdev::join_strings_to(buffer.data(), tokens, std::string(", "));
+ * \endcode
+ *
+ * \tparam OutputIt  The type of output iterator.
+ * \tparam ContainerT  The type of container of strings.
+ * \tparam SeparatorT  The type of the separator.
+ * \param[in] out  The output iterator.
+ * \param[in] tokens  The container of strings.
+ * \param[in] separator  The separator to add between each string.
+ *
+ * \return The output iterator just after the last character written.
+ */
+template<class OutputIt, class ContainerT, class SeparatorT>
+OutputIt join_strings_to(
+        OutputIt out
+      , ContainerT const & tokens
+      , SeparatorT const & separator)
+{
+    std::basic_string_view<typename ContainerT::value_type::value_type> const sep(separator);
+    bool first(true);
+    for(auto const & s : tokens)
+    {
+        if(first)
+        {
+            first = false;
+        }
+        else
+        {
+            out = std::copy(sep.begin(), sep.end(), out);
+        }
+        out = std::copy(s.begin(), s.end(), out);
+    }
+
+    return out;
+}
+
+
+/** \brief Join strings as a list of iovec structures.
+ *
+ * This class creates an array of iovec structures which point to the
+ * tokens and the separators. Nothing gets copied so the tokens and the
+ * separator must remain valid and unmodified for as long as the
+ * join_strings_iovec object is in use.
+ *
+ * The array can directly be passed to writev() or use the write() function
+ * which handles partial writes and the IOV_MAX limit.
+ *
+ * \code
+ *     snapdev::join_strings_iovec const v(lines, "\n");
+ *     if(v.write(fd) != static_cast<ssize_t>(v.total_size()))
+ *     {
+ *         ...handle error...
+ *     }
+ * \endcode
+ *
+ * Empty tokens and an empty separator do not generate an iovec entry.
+ */
+class join_strings_iovec
+{
+public:
+    /** \brief Create the list of iovec structures.
+     *
+     * This constructor creates one entry per non-empty token and one
+     * entry per separator (unless empty).
+     *
+     * \tparam ContainerT  The type of container of strings.
+     * \param[in] tokens  The container of strings.
+     * \param[in] separator  The separator to add between each string.
+     */
+    template<class ContainerT>
+    join_strings_iovec(ContainerT const & tokens, std::string_view const & separator)
+    {
+        if(tokens.empty())
+        {
+            return;
+        }
+        f_iovec.reserve(tokens.size() * (separator.empty() ? 1 : 2) - (separator.empty() ? 0 : 1));
+        bool first(true);
+        for(auto const & s : tokens)
+        {
+            if(first)
+            {
+                first = false;
+            }
+            else
+            {
+                add(separator);
+            }
+            add(std::string_view(s));
+        }
+    }
+
+    /** \brief Prevent the use of a temporary separator.
+     *
+     * The iovec structures point to the separator so it has to outlive
+     * the object. A temporary std::string would be destroyed at the end
+     * of the full expression and leave dangling pointers.
+     *
+     * \tparam ContainerT  The type of container of strings.
+     * \tparam StringT  The type of the temporary separator.
+     */
+    template<
+          class ContainerT
+        , class StringT
+        , std::enable_if_t<std::is_same_v<StringT, std::string>, int> = 0>
+    join_strings_iovec(ContainerT const & tokens, StringT && separator) = delete;
+
+    /** \brief Get a pointer to the array of iovec structures.
+     *
+     * \return A pointer to the first iovec structure.
+     */
+    iovec const * data() const
+    {
+        return f_iovec.data();
+    }
+
+    /** \brief Get the number of iovec structures.
+     *
+     * \warning
+     * The writev() function fails if this number is larger than IOV_MAX.
+     * The write() function does not have that limitation.
+     *
+     * \return The number of iovec structures in the array.
+     */
+    std::size_t size() const
+    {
+        return f_iovec.size();
+    }
+
+    /** \brief Get the total number of bytes described by the iovec.
+     *
+     * \return The size of the joined strings.
+     */
+    std::size_t total_size() const
+    {
+        return f_total_size;
+    }
+
+    /** \brief Write the joined strings to a file descriptor.
+     *
+     * This function calls writev() as many times as required to write
+     * all the data. It handles partial writes, EINTR, and arrays larger
+     * than IOV_MAX.
+     *
+     * \param[in] fd  The file descriptor where the data gets written.
+     *
+     * \return The number of bytes written or -1 on error (see errno).
+     */
+    ssize_t write(int fd) const
+    {
+        std::vector<iovec> v(f_iovec);
+        std::size_t idx(0);
+        ssize_t total(0);
+        while(idx < v.size())
+        {
+            int const count(static_cast<int>(std::min(v.size() - idx, static_cast<std::size_t>(IOV_MAX))));
+            ssize_t r(::writev(fd, v.data() + idx, count));
+            if(r < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+            total += r;
+            while(idx < v.size() && static_cast<std::size_t>(r) >= v[idx].iov_len)
+            {
+                r -= v[idx].iov_len;
+                ++idx;
+            }
+            if(r > 0)
+            {
+                v[idx].iov_base = static_cast<char *>(v[idx].iov_base) + r;
+                v[idx].iov_len -= r;
+            }
+        }
+        return total;
+    }
+
+private:
+    void add(std::string_view const & s)
+    {
+        if(!s.empty())
+        {
+            f_iovec.push_back(iovec{ const_cast<char *>(s.data()), s.length() });
+            f_total_size += s.length();
+        }
+    }
+
+    std::vector<iovec>  f_iovec = std::vector<iovec>();
+    std::size_t         f_total_size = 0;
+};
+
+
 namespace detail
 {
 
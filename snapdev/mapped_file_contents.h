@@ -0,0 +1,345 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Access the contents of a file through a read-only memory map.
+ *
+ * The file_contents class copies the whole file in an std::string. For
+ * very large files, this doubles the amount of memory used (the page
+ * cache and the string) and the copy itself is costly. The
+ * mapped_file_contents class instead maps the file in memory and gives
+ * you a read-only view of the data.
+ *
+ * Files which cannot be mapped (i.e. "/proc/..." files, FIFOs, sockets)
+ * are read in a buffer instead, so the class can be used with any file.
+ *
+ * \code
+ *     snapdev::mapped_file_contents in("/var/lib/data/large.db");
+ *     if(!in.read_all(snapdev::mapped_file_contents::ADVICE_SEQUENTIAL))
+ *     {
+ *         std::cerr << in.last_error() << "\n";
+ *         return;
+ *     }
+ *     std::string_view const data(in.contents());
+ * \endcode
+ */
+
+// self
+//
+#include    <snapdev/concat_to_string.h>
+#include    <snapdev/file_contents.h>
+#include    <snapdev/raii_generic_deleter.h>
+
+
+// C++
+//
+#include    <cstdint>
+#include    <span>
+#include    <string_view>
+#include    <utility>
+
+
+// C
+//
+#include    <fcntl.h>
+#include    <string.h>
+#include    <sys/mman.h>
+#include    <sys/stat.h>
+#include    <unistd.h>
+
+
+
+namespace snapdev
+{
+
+
+
+class mapped_file_contents
+{
+public:
+    /** \brief Hints passed to madvise() once the file is mapped.
+     *
+     * The hints are flags which can be combined. They are ignored when
+     * the file is read in a buffer instead of being mapped.
+     */
+    typedef std::uint32_t               advice_t;
+
+    static constexpr advice_t const     ADVICE_NORMAL = 0x0000;
+    static constexpr advice_t const     ADVICE_SEQUENTIAL = 0x0001;
+    static constexpr advice_t const     ADVICE_RANDOM = 0x0002;
+    static constexpr advice_t const     ADVICE_WILLNEED = 0x0004;
+    static constexpr advice_t const     ADVICE_HUGEPAGES = 0x0008;
+
+    /** \brief Initialize a mapped file.
+     *
+     * The constructor only saves the filename. Call read_all() to
+     * actually map the file.
+     *
+     * \exception std::invalid_argument
+     * The \p filename parameter cannot be an empty string.
+     *
+     * \param[in] filename  The name of the file to map.
+     */
+    mapped_file_contents(std::string const & filename)
+        : f_filename(filename)
+    {
+        if(f_filename.empty())
+        {
+            throw std::invalid_argument("snapdev::mapped_file_contents: the filename of a mapped_file_contents object cannot be the empty string.");
+        }
+    }
+
+    mapped_file_contents(mapped_file_contents const &) = delete;
+
+    mapped_file_contents(mapped_file_contents && rhs)
+        : f_filename(std::move(rhs.f_filename))
+        , f_buffer(std::move(rhs.f_buffer))
+        , f_error(std::move(rhs.f_error))
+        , f_address(std::exchange(rhs.f_address, nullptr))
+        , f_size(std::exchange(rhs.f_size, 0))
+    {
+    }
+
+    /** \brief Unmap the file.
+     *
+     * The destructor releases the memory map, if any. Any string_view
+     * or span retrieved from this object becomes invalid.
+     */
+    ~mapped_file_contents()
+    {
+        unmap();
+    }
+
+    mapped_file_contents & operator = (mapped_file_contents const &) = delete;
+
+    mapped_file_contents & operator = (mapped_file_contents && rhs)
+    {
+        if(this != &rhs)
+        {
+            unmap();
+            f_filename = std::move(rhs.f_filename);
+            f_buffer = std::move(rhs.f_buffer);
+            f_error = std::move(rhs.f_error);
+            f_address = std::exchange(rhs.f_address, nullptr);
+            f_size = std::exchange(rhs.f_size, 0);
+        }
+        return *this;
+    }
+
+    std::string const & filename() const
+    {
+        return f_filename;
+    }
+
+    /** \brief Map the file in memory.
+     *
+     * This function maps the file read-only and applies the \p advice
+     * hints with madvise(). The hints are only hints: a failing madvise()
+     * (i.e. ADVICE_HUGEPAGES on a filesystem which does not support
+     * huge pages) is ignored.
+     *
+     * If the file is not a regular file or its size is reported as
+     * zero (which is the case of the "/proc/..." files), then the file
+     * gets read in a buffer instead. is_mapped() tells you which
+     * method was used.
+     *
+     * Calling read_all() again releases the previous data first.
+     *
+     * \param[in] advice  The madvise() hints to apply to the map.
+     *
+     * \return true if the file was mapped or read, false otherwise.
+     *
+     * \sa last_error()
+     */
+    bool read_all(advice_t advice = ADVICE_NORMAL)
+    {
+        unmap();
+
+        raii_fd_t fd(::open(f_filename.c_str(), O_RDONLY | O_CLOEXEC));
+        if(fd == nullptr)
+        {
+            f_error = concat_to_string(
+                      "could not open file \""
+                    , f_filename
+                    , "\" for reading.");
+            return false;
+        }
+
+        struct stat st = {};
+        if(fstat(fd.get(), &st) != 0)
+        {
+            f_error = concat_to_string(                     // LCOV_EXCL_LINE
+                      "could not retrieve the status of \"" // LCOV_EXCL_LINE
+                    , f_filename                            // LCOV_EXCL_LINE
+                    , "\".");                               // LCOV_EXCL_LINE
+            return false;                                   // LCOV_EXCL_LINE
+        }
+
+        if(S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void * address(mmap(
+                      nullptr
+                    , st.st_size
+                    , PROT_READ
+                    , MAP_PRIVATE
+                    , fd.get()
+                    , 0));
+            if(address != MAP_FAILED)
+            {
+                f_address = address;
+                f_size = st.st_size;
+                advise(advice);
+                f_error.clear();
+                return true;
+            }
+        }
+
+        return read_buffer();
+    }
+
+    /** \brief Apply more madvise() hints.
+     *
+     * The hints can be changed after the file was mapped, for example
+     * to switch from ADVICE_SEQUENTIAL to ADVICE_RANDOM.
+     *
+     * \param[in] advice  The hints to apply.
+     *
+     * \return true if all the hints were accepted.
+     */
+    bool advise(advice_t advice)
+    {
+        if(f_address == nullptr)
+        {
+            return false;
+        }
+
+        bool result(true);
+        if((advice & ADVICE_SEQUENTIAL) != 0)
+        {
+            result = madvise(f_address, f_size, MADV_SEQUENTIAL) == 0 && result;
+        }
+        if((advice & ADVICE_RANDOM) != 0)
+        {
+            result = madvise(f_address, f_size, MADV_RANDOM) == 0 && result;
+        }
+        if((advice & ADVICE_WILLNEED) != 0)
+        {
+            result = madvise(f_address, f_size, MADV_WILLNEED) == 0 && result;
+        }
+#ifdef MADV_HUGEPAGE
+        if((advice & ADVICE_HUGEPAGES) != 0)
+        {
+            result = madvise(f_address, f_size, MADV_HUGEPAGE) == 0 && result;
+        }
+#endif
+        return result;
+    }
+
+    /** \brief Release the data.
+     *
+     * This function unmaps the file or releases the buffer used to
+     * read it.
+     */
+    void unmap()
+    {
+        if(f_address != nullptr)
+        {
+            munmap(f_address, f_size);
+            f_address = nullptr;
+        }
+        f_size = 0;
+        f_buffer.clear();
+        f_buffer.shrink_to_fit();
+    }
+
+    /** \brief Check whether the data is a memory map.
+     *
+     * \return true if the file is mapped, false if it was read in a
+     * buffer or not loaded at all.
+     */
+    bool is_mapped() const
+    {
+        return f_address != nullptr;
+    }
+
+    std::size_t size() const
+    {
+        return f_address != nullptr ? f_size : f_buffer.size();
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /** \brief Get the contents of the file.
+     *
+     * The view remains valid until the object is destroyed or
+     * read_all() or unmap() get called.
+     *
+     * \return A view of the file data.
+     */
+    std::string_view contents() const
+    {
+        if(f_address != nullptr)
+        {
+            return std::string_view(static_cast<char const *>(f_address), f_size);
+        }
+        return f_buffer;
+    }
+
+    std::span<std::byte const> data() const
+    {
+        std::string_view const view(contents());
+        return std::span<std::byte const>(
+                  reinterpret_cast<std::byte const *>(view.data())
+                , view.size());
+    }
+
+    std::string const & last_error() const
+    {
+        return f_error;
+    }
+
+private:
+    bool read_buffer()
+    {
+        file_contents in(f_filename);
+        in.size_mode(file_contents::size_mode_t::SIZE_MODE_READ);
+        if(!in.read_all())
+        {
+            f_error = in.last_error();
+            return false;
+        }
+        f_buffer = std::move(in.contents());
+        f_error.clear();
+        return true;
+    }
+
+    std::string         f_filename = std::string();
+    std::string         f_buffer = std::string();
+    std::string         f_error = std::string();
+    void *              f_address = nullptr;
+    std::size_t         f_size = 0;
+};
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
@@ -22,6 +22,9 @@
  *
  * These functions are extensions to the math functions offered by the C
  * and the C++ libraries.
+ *
+ * The file also includes fast non-cryptographic hash functions (see
+ * hash64() and hash128()).
  */
 
 // self
@@ -31,6 +34,14 @@
 #include    <snapdev/not_reached.h>
 
 
+// C++
+//
+#include    <cstring>
+#include    <span>
+#include    <string_view>
+#include    <type_traits>
+
+
 // C
 //
 #include    <byteswap.h>
@@ -341,5 +352,431 @@ inline unsigned __int128 bswap_128(unsigned __int128 n)
 
 
 
+namespace detail
+{
+
+
+/** \brief The constants used by the hash functions.
+ *
+ * These are odd numbers with 32 bits set, as used by wyhash.
+ */
+constexpr std::uint64_t const g_hash_secret[4] =
+{
+    0x2d358dccaa6c78a5ULL,
+    0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL,
+    0x4d5a2da51de1aa47ULL,
+};
+
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+constexpr void hash_mum(std::uint64_t & a, std::uint64_t & b)
+{
+    unsigned __int128 const r(static_cast<unsigned __int128>(a) * b);
+    a = static_cast<std::uint64_t>(r);
+    b = static_cast<std::uint64_t>(r >> 64);
+}
+#pragma GCC diagnostic pop
+
+
+constexpr std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b)
+{
+    hash_mum(a, b);
+    return a ^ b;
+}
+
+
+/** \brief Read a little endian number from a buffer.
+ *
+ * At compile time, the bytes are assembled one by one. At runtime, the
+ * function uses memcpy() which compiles to a single unaligned load.
+ *
+ * \tparam T  The type of integer to read.
+ * \param[in] p  The pointer to the bytes to read.
+ *
+ * \return The number read from \p p.
+ */
+template<typename T>
+constexpr T hash_read(char const * p)
+{
+    if(std::is_constant_evaluated())
+    {
+        T v(0);
+        for(int i(sizeof(T) - 1); i >= 0; --i)
+        {
+            v = (v << 8) | static_cast<std::uint8_t>(p[i]);
+        }
+        return v;
+    }
+
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    if constexpr(sizeof(T) == 8)
+    {
+        v = bswap_64(v);
+    }
+    else
+    {
+        v = bswap_32(v);
+    }
+#endif
+    return v;
+}
+
+
+constexpr std::uint64_t hash_init(std::uint64_t seed)
+{
+    return seed ^ hash_mix(seed ^ g_hash_secret[0], g_hash_secret[1]);
+}
+
+
+/** \brief Hash one block of 48 bytes.
+ *
+ * The long inputs are hashed with three independent states so the
+ * multiplications can run in parallel.
+ *
+ * \param[in,out] state  The three states of the hash.
+ * \param[in] p  The pointer to the 48 bytes to hash.
+ */
+constexpr void hash_block(std::uint64_t * state, char const * p)
+{
+    state[0] = hash_mix(hash_read<std::uint64_t>(p +  0) ^ g_hash_secret[1], hash_read<std::uint64_t>(p +  8) ^ state[0]);
+    state[1] = hash_mix(hash_read<std::uint64_t>(p + 16) ^ g_hash_secret[2], hash_read<std::uint64_t>(p + 24) ^ state[1]);
+    state[2] = hash_mix(hash_read<std::uint64_t>(p + 32) ^ g_hash_secret[3], hash_read<std::uint64_t>(p + 40) ^ state[2]);
+}
+
+
+/** \brief Hash the last 48 bytes or less.
+ *
+ * When \p total is more than 16, the function reads the 16 bytes
+ * before the end of the data, which may be before \p p.
+ *
+ * \param[in] seed  The state of the hash.
+ * \param[in] p  The pointer to the remaining bytes.
+ * \param[in] size  The number of remaining bytes.
+ * \param[in] total  The total number of bytes hashed.
+ *
+ * \return The final hash.
+ */
+constexpr std::uint64_t hash_finish(
+      std::uint64_t seed
+    , char const * p
+    , std::size_t size
+    , std::uint64_t total)
+{
+    std::uint64_t a(0);
+    std::uint64_t b(0);
+    if(total <= 16)
+    {
+        if(size >= 4)
+        {
+            std::size_t const offset((size >> 3) << 2);
+            a = (static_cast<std::uint64_t>(hash_read<std::uint32_t>(p)) << 32)
+                | hash_read<std::uint32_t>(p + offset);
+            b = (static_cast<std::uint64_t>(hash_read<std::uint32_t>(p + size - 4)) << 32)
+                | hash_read<std::uint32_t>(p + size - 4 - offset);
+        }
+        else if(size > 0)
+        {
+            a = (static_cast<std::uint64_t>(static_cast<std::uint8_t>(p[0])) << 16)
+                | (static_cast<std::uint64_t>(static_cast<std::uint8_t>(p[size >> 1])) << 8)
+                | static_cast<std::uint8_t>(p[size - 1]);
+        }
+    }
+    else
+    {
+        while(size > 16)
+        {
+            seed = hash_mix(hash_read<std::uint64_t>(p) ^ g_hash_secret[1], hash_read<std::uint64_t>(p + 8) ^ seed);
+            p += 16;
+            size -= 16;
+        }
+        a = hash_read<std::uint64_t>(p + size - 16);
+        b = hash_read<std::uint64_t>(p + size - 8);
+    }
+
+    a ^= g_hash_secret[1];
+    b ^= seed;
+    hash_mum(a, b);
+    return hash_mix(a ^ g_hash_secret[0] ^ total, b ^ g_hash_secret[1]);
+}
+
+
+constexpr std::uint64_t hash_bytes(char const * p, std::size_t size, std::uint64_t seed)
+{
+    seed = hash_init(seed);
+    if(size <= 48)
+    {
+        return hash_finish(seed, p, size, size);
+    }
+
+    std::uint64_t state[3] = { seed, seed, seed };
+    std::size_t remaining(size);
+    do
+    {
+        hash_block(state, p);
+        p += 48;
+        remaining -= 48;
+    }
+    while(remaining > 48);
+
+    return hash_finish(state[0] ^ state[1] ^ state[2], p, remaining, size);
+}
+
+
+/** \brief The seed of the upper half of a 128 bit hash.
+ *
+ * \param[in] seed  The seed of the lower half.
+ *
+ * \return The seed of the upper half.
+ */
+constexpr std::uint64_t hash_high_seed(std::uint64_t seed)
+{
+    return seed + g_hash_secret[3];
+}
+
+
+} // namespace detail
+
+
+
+/** \brief Compute a 64 bit hash of a string.
+ *
+ * This function computes a fast non-cryptographic hash of the bytes of
+ * \p s. The algorithm is the one of wyhash: the bytes are mixed with
+ * 64x64 to 128 bit multiplications, which makes it several times faster
+ * than the byte by byte hashes while passing the usual quality tests.
+ * Long inputs are processed 48 bytes at a time.
+ *
+ * The function is constexpr so it can be used to hash strings at
+ * compile time, for example in the case labels of a switch.
+ *
+ * The result does not depend on the endianness of the processor so it
+ * can be saved or sent to another computer. It is, however, not
+ * designed to resist attacks. Do not use it where an attacker can
+ * choose the input and benefit from collisions, unless you use a
+ * random \p seed.
+ *
+ * \param[in] s  The string to hash.
+ * \param[in] seed  A seed to change the hash.
+ *
+ * \return The 64 bit hash.
+ *
+ * \sa hash128()
+ * \sa hasher64
+ */
+constexpr std::uint64_t hash64(std::string_view s, std::uint64_t seed = 0)
+{
+    return detail::hash_bytes(s.data(), s.length(), seed);
+}
+
+
+/** \brief Compute a 64 bit hash of a buffer.
+ *
+ * \param[in] data  The bytes to hash.
+ * \param[in] size  The number of bytes to hash.
+ * \param[in] seed  A seed to change the hash.
+ *
+ * \return The 64 bit hash.
+ */
+inline std::uint64_t hash64(void const * data, std::size_t size, std::uint64_t seed = 0)
+{
+    return detail::hash_bytes(reinterpret_cast<char const *>(data), size, seed);
+}
+
+
+/** \brief Compute a 64 bit hash of a span of bytes.
+ *
+ * \param[in] data  The bytes to hash, see std::as_bytes().
+ * \param[in] seed  A seed to change the hash.
+ *
+ * \return The 64 bit hash.
+ */
+inline std::uint64_t hash64(std::span<std::byte const> data, std::uint64_t seed = 0)
+{
+    return hash64(data.data(), data.size(), seed);
+}
+
+
+/** \brief Compute a 128 bit hash of a string.
+ *
+ * The 128 bit hash is composed of two 64 bit hashes computed with
+ * different seeds. The lower 64 bits are equal to hash64() with the
+ * same \p seed.
+ *
+ * This is useful when the hash is used as the identifier of the data
+ * (i.e. to detect duplicates without comparing the data itself) since
+ * the probability of a collision is then negligible.
+ *
+ * \param[in] s  The string to hash.
+ * \param[in] seed  A seed to change the hash.
+ *
+ * \return The 128 bit hash.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+constexpr unsigned __int128 hash128(std::string_view s, std::uint64_t seed = 0)
+{
+    return (static_cast<unsigned __int128>(detail::hash_bytes(s.data(), s.length(), detail::hash_high_seed(seed))) << 64)
+         | detail::hash_bytes(s.data(), s.length(), seed);
+}
+
+
+inline unsigned __int128 hash128(void const * data, std::size_t size, std::uint64_t seed = 0)
+{
+    return hash128(std::string_view(reinterpret_cast<char const *>(data), size), seed);
+}
+
+
+inline unsigned __int128 hash128(std::span<std::byte const> data, std::uint64_t seed = 0)
+{
+    return hash128(data.data(), data.size(), seed);
+}
+#pragma GCC diagnostic pop
+
+
+namespace detail
+{
+
+
+/** \brief Compute a hash in multiple steps.
+ *
+ * This class computes the same hash as hash64() or hash128() for data
+ * which is not available all at once (i.e. a file read by blocks).
+ * Call update() with each block, then digest() to get the result.
+ *
+ * The class keeps up to 48 bytes which it cannot hash until it knows
+ * whether more data follows, plus the last 16 bytes hashed since the
+ * last step may read them again.
+ *
+ * \tparam LANES  The number of 64 bit hashes to compute (1 or 2).
+ */
+template<int LANES>
+class basic_hasher
+{
+public:
+    static_assert(LANES == 1 || LANES == 2, "basic_hasher supports 64 or 128 bits only");
+
+    basic_hasher(std::uint64_t seed = 0)
+    {
+        for(int lane(0); lane < LANES; ++lane)
+        {
+            std::uint64_t const s(hash_init(lane == 0 ? seed : hash_high_seed(seed)));
+            f_state[lane][0] = s;
+            f_state[lane][1] = s;
+            f_state[lane][2] = s;
+        }
+    }
+
+    void update(void const * data, std::size_t size)
+    {
+        char const * p(reinterpret_cast<char const *>(data));
+        f_total += size;
+
+        char * pending(f_buffer + 16);
+        if(f_pending + size <= 48)
+        {
+            std::memcpy(pending + f_pending, p, size);
+            f_pending += size;
+            return;
+        }
+
+        // more data follows so the pending bytes can be hashed
+        //
+        if(f_pending > 0)
+        {
+            std::size_t const fill(48 - f_pending);
+            std::memcpy(pending + f_pending, p, fill);
+            p += fill;
+            size -= fill;
+            block(pending);
+            std::memcpy(f_buffer, pending + 32, 16);
+            f_pending = 0;
+        }
+
+        if(size > 48)
+        {
+            do
+            {
+                block(p);
+                p += 48;
+                size -= 48;
+            }
+            while(size > 48);
+            std::memcpy(f_buffer, p - 16, 16);
+        }
+
+        std::memcpy(pending, p, size);
+        f_pending = size;
+    }
+
+    void update(std::string_view s)
+    {
+        update(s.data(), s.length());
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    auto digest() const
+    {
+        if constexpr(LANES == 1)
+        {
+            return finish(0);
+        }
+        else
+        {
+            return (static_cast<unsigned __int128>(finish(1)) << 64) | finish(0);
+        }
+    }
+#pragma GCC diagnostic pop
+
+private:
+    void block(char const * p)
+    {
+        for(int lane(0); lane < LANES; ++lane)
+        {
+            hash_block(f_state[lane], p);
+        }
+    }
+
+    std::uint64_t finish(int lane) const
+    {
+        std::uint64_t seed(f_state[lane][0]);
+        if(f_total > 48)
+        {
+            seed ^= f_state[lane][1] ^ f_state[lane][2];
+        }
+        return hash_finish(seed, f_buffer + 16, f_pending, f_total);
+    }
+
+    std::uint64_t f_state[LANES][3] = {};
+    std::uint64_t f_total = 0;
+    std::size_t f_pending = 0;
+    char f_buffer[16 + 48] = {};
+};
+
+
+} // namespace detail
+
+
+/** \brief Compute a hash64() in multiple steps.
+ *
+ * \code
+ *     snapdev::hasher64 h;
+ *     h.update(header, header_size);
+ *     h.update(body);
+ *     std::uint64_t const hash(h.digest());
+ * \endcode
+ */
+typedef detail::basic_hasher<1>     hasher64;
+
+/** \brief Compute a hash128() in multiple steps.
+ */
+typedef detail::basic_hasher<2>     hasher128;
+
+
+
 } // namespace snapdev
 // vim: ts=4 sw=4 et
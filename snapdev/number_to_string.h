@@ -23,13 +23,19 @@
  * This function allows you to convert a number (integer or double) to a
  * string. The function accepts a \em base (radix) parameter so it is
  * possible to convert the number to any base from 2 to 36.
+ *
+ * Base 10 is converted two digits at a time using a table of pairs and
+ * bases which are a power of two (2, 4, 8, 16, 32) use shifts instead of
+ * divisions. The integer_to_chars() function writes the digits directly
+ * in a caller buffer and returns the end pointer.
  */
 
 // C++
 //
-//#include    <cmath>
-//#include    <stdexcept>
-//#include    <type_traits>
+#include    <cstdint>
+#include    <stdexcept>
+#include    <string>
+#include    <type_traits>
 
 
 
@@ -37,74 +43,257 @@ namespace snapdev
 {
 
 
+namespace detail
+{
+
 
-/** \brief Convert integrals to a string.
+/** \brief The 100 pairs of decimal digits.
  *
- * This template is used to convert integers to a string of characters.
- * It supports a base so you can convert integers to decimal,
- * octal, hexadecimal, binary, and any other base from 2 up to 36.
+ * The base 10 conversion copies two digits at a time from this table.
+ */
+inline constexpr char const g_decimal_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+
+/** \brief The digits of all the supported bases.
  *
- * \note
- * This class is overfully complete and can be used to traverse the resulting
- * string.
+ * The first string is used for lowercase and the second for uppercase.
+ */
+inline constexpr char const g_base36_digits[2][37] =
+{
+    "0123456789abcdefghijklmnopqrstuvwxyz",
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+};
+
+
+/** \brief Count the number of decimal digits of \p value.
+ *
+ * \tparam U  An unsigned integer type.
+ * \param[in] value  The value to check.
+ *
+ * \return The number of digits, at least 1.
+ */
+template<typename U>
+int decimal_digit_count(U value)
+{
+    int count(1);
+    for(;;)
+    {
+        if(value < 10)
+        {
+            return count;
+        }
+        if(value < 100)
+        {
+            return count + 1;
+        }
+        if(value < 1000)
+        {
+            return count + 2;
+        }
+        if(value < 10000)
+        {
+            return count + 3;
+        }
+        value /= 10000;
+        count += 4;
+    }
+}
+
+
+} // namespace detail
+
+
+
+/** \brief The maximum number of characters output by integer_to_chars().
+ *
+ * The largest output is in base 2 for a negative number: one character
+ * per bit plus the minus sign.
+ *
+ * \tparam T  The type of integer.
+ */
+template<typename T>
+constexpr std::size_t integer_to_chars_max_size = sizeof(T) * 8 + 1;
+
+
+/** \brief Convert an integer to characters in a caller buffer.
+ *
+ * This function writes \p value in \p base to the buffer defined by
+ * \p first and \p last. It does not add a '\0'. Negative numbers are
+ * written with a '-' followed by their absolute value in all bases.
+ *
+ * If the buffer is too small, nothing is written and the function
+ * returns nullptr. A buffer of integer_to_chars_max_size<T> characters
+ * is always large enough.
+ *
+ * \code
+ *     char buf[snapdev::integer_to_chars_max_size<int>];
+ *     char * end(snapdev::integer_to_chars(buf, buf + sizeof(buf), 1234));
+ *     write(fd, buf, end - buf);
+ * \endcode
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
  *
  * \tparam T  The type of number (i.e. `int`).
- * \tparam base  Desired base.
- * \tparam uppercase  Whether to use uppercase (true) or lowercase (false).
- * \tparam CharT  Type of characters of the output string.
+ * \tparam CharT  Type of characters of the output buffer.
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] base  Desired base.
+ * \param[in] uppercase  Whether to use uppercase (true) or lowercase (false).
+ *
+ * \return A pointer after the last character written or nullptr.
  */
 template<
-      typename T = int
+      typename T
     , typename CharT = char
     , std::enable_if_t<std::is_integral_v<T>, int> = 0>
-std::basic_string<CharT> integer_to_string(T value, int base = 10, bool uppercase = false)
+CharT * integer_to_chars(CharT * first, CharT * last, T value, int base = 10, bool uppercase = false)
 {
     if(base < 2 || base > 36)
     {
-        throw std::range_error("base is out of range in integer_to_string()");
+        throw std::range_error("base is out of range in integer_to_chars()");
+    }
+
+    typedef std::make_unsigned_t<T> unsigned_t;
+
+    bool const neg(value < 0);
+    unsigned_t u(neg
+            ? static_cast<unsigned_t>(0) - static_cast<unsigned_t>(value)
+            : static_cast<unsigned_t>(value));
+
+    // count the digits first so we can write them in place
+    //
+    int count(0);
+    int shift(0);
+    if(base == 10)
+    {
+        count = detail::decimal_digit_count(u);
+    }
+    else if((base & (base - 1)) == 0)
+    {
+        shift = __builtin_ctz(base);
+        int bits(1);
+        for(unsigned_t v(u >> 1); v != 0; v >>= 1)
+        {
+            ++bits;
+        }
+        count = (bits + shift - 1) / shift;
+    }
+    else
+    {
+        count = 1;
+        for(unsigned_t v(u / base); v != 0; v /= base)
+        {
+            ++count;
+        }
+    }
+
+    if(last - first < count + (neg ? 1 : 0))
+    {
+        return nullptr;
     }
 
-    CharT buf[40];
-    CharT * end(buf + sizeof(buf) / sizeof(CharT));
+    if(neg)
+    {
+        *first = '-';
+        ++first;
+    }
+    CharT * const end(first + count);
     CharT * ptr(end);
-    if(value != 0)
+
+    if(base == 10)
     {
-        bool const neg(value < 0);
-        if(neg)
+        while(u >= 100)
         {
-            value = -value;
+            int const idx(static_cast<int>(u % 100) * 2);
+            u /= 100;
+            ptr -= 2;
+            ptr[0] = detail::g_decimal_digit_pairs[idx];
+            ptr[1] = detail::g_decimal_digit_pairs[idx + 1];
         }
-        for(; value != 0; value /= base)
+        if(u >= 10)
         {
-            --ptr;
-            int const digit(value % base);
-            if(digit < 10)
-            {
-                *ptr = '0' + digit;
-            }
-            else if(uppercase)
-            {
-                *ptr = ('A' - 10) + digit;
-            }
-            else
+            int const idx(static_cast<int>(u) * 2);
+            ptr[-2] = detail::g_decimal_digit_pairs[idx];
+            ptr[-1] = detail::g_decimal_digit_pairs[idx + 1];
+        }
+        else
+        {
+            ptr[-1] = static_cast<CharT>('0' + u);
+        }
+    }
+    else
+    {
+        char const * digits(detail::g_base36_digits[uppercase ? 1 : 0]);
+        if(shift != 0)
+        {
+            unsigned_t const mask(base - 1);
+            do
             {
-                *ptr = ('a' - 10) + digit;
+                --ptr;
+                *ptr = digits[u & mask];
+                u >>= shift;
             }
+            while(ptr > first);
         }
-
-        if(neg)
+        else
         {
-            --ptr;
-            *ptr = '-';
+            do
+            {
+                --ptr;
+                *ptr = digits[u % base];
+                u /= base;
+            }
+            while(ptr > first);
         }
     }
-    else
+
+    return end;
+}
+
+
+/** \brief Convert integrals to a string.
+ *
+ * This template is used to convert integers to a string of characters.
+ * It supports a base so you can convert integers to decimal,
+ * octal, hexadecimal, binary, and any other base from 2 up to 36.
+ *
+ * \note
+ * This class is overfully complete and can be used to traverse the resulting
+ * string.
+ *
+ * \tparam T  The type of number (i.e. `int`).
+ * \tparam base  Desired base.
+ * \tparam uppercase  Whether to use uppercase (true) or lowercase (false).
+ * \tparam CharT  Type of characters of the output string.
+ *
+ * \sa integer_to_chars()
+ */
+template<
+      typename T = int
+    , typename CharT = char
+    , std::enable_if_t<std::is_integral_v<T>, int> = 0>
+std::basic_string<CharT> integer_to_string(T value, int base = 10, bool uppercase = false)
+{
+    if(base < 2 || base > 36)
     {
-        --ptr;
-        *ptr = '0';
+        throw std::range_error("base is out of range in integer_to_string()");
     }
 
-    return std::basic_string<CharT>(ptr, end - ptr);
+    CharT buf[integer_to_chars_max_size<T>];
+    CharT * const end(integer_to_chars(buf, buf + integer_to_chars_max_size<T>, value, base, uppercase));
+    return std::basic_string<CharT>(buf, end - buf);
 }
 
 
@@ -18,64 +18,554 @@
 #pragma once
 
 /** \file
- * \brief Print large integers to any iostream.
+ * \brief Print and parse large integers (128 bits).
  *
- * This function prints large integers (128 bits) to the specified iostream.
+ * This file offers functions to convert large integers (128 bits) to
+ * and from strings and the corresponding operators to print them to
+ * any iostream and read them from any iostream.
+ *
+ * A 128 bit division calls a libgcc function which is slow. To avoid
+ * one such division per digit, the conversion to a string first splits
+ * the number in chunks which fit in 64 bits (i.e. 10^19 in decimal)
+ * and then converts each chunk with 64 bit arithmetic. Power of two
+ * bases only use shifts. The parser does the reverse: it accumulates
+ * as many digits as possible in a 64 bit number before doing one 128
+ * bit multiplication.
  */
 
+// self
+//
+#include    <snapdev/number_to_string.h>
+
+
 // C++
 //
+#include    <array>
+#include    <charconv>
+#include    <cstdint>
+#include    <cstring>
+#include    <istream>
+#include    <limits>
 #include    <ostream>
 #include    <sstream>
+#include    <stdexcept>
+#include    <string>
+#include    <system_error>
 
 
 
 namespace snapdev
 {
 
-/** \brief Convert an __int128 to a string.
+namespace detail
+{
+
+
+/** \brief Definition of the largest chunk of digits fitting in 64 bits.
  *
- * This function converts an __int128 to a string.
+ * For a given base, f_power is the largest power of that base which
+ * fits in an std::uint64_t and f_digits is the corresponding exponent,
+ * i.e. the number of digits in one chunk.
+ */
+struct int128_chunk
+{
+    int                 f_digits = 0;
+    std::uint64_t       f_power = 0;
+};
+
+
+/** \brief Compute the chunk definitions of all the bases.
  *
- * \param[in] x  An __int128 number.
+ * \return An array with the chunk definition of bases 2 to 36.
+ */
+constexpr std::array<int128_chunk, 37> int128_chunks()
+{
+    std::array<int128_chunk, 37> result{};
+    for(std::uint64_t base(2); base <= 36; ++base)
+    {
+        result[base].f_digits = 1;
+        result[base].f_power = base;
+        while(result[base].f_power <= std::numeric_limits<std::uint64_t>::max() / base)
+        {
+            result[base].f_power *= base;
+            ++result[base].f_digits;
+        }
+    }
+    return result;
+}
+
+
+/** \brief The chunk definitions indexed by base.
  *
- * \return A string representing that __int128 number.
+ * In base 10, the chunk is 10^19 and has 19 digits.
+ */
+inline constexpr std::array<int128_chunk, 37> g_int128_chunks = int128_chunks();
+
+
+/** \brief Write a 64 bit chunk backward.
+ *
+ * This function writes \p value in \p base ending at \p ptr. If the
+ * number has less than \p min_digits digits, it gets padded with '0'.
+ *
+ * \param[in] ptr  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] base  The base, from 2 to 36.
+ * \param[in] digits  The digits to use (lower or upper case).
+ * \param[in] min_digits  The minimum number of digits to output.
+ *
+ * \return A pointer to the first character written.
+ */
+inline char * uint64_to_chars_backward(
+      char * ptr
+    , std::uint64_t value
+    , int base
+    , char const * digits
+    , int min_digits)
+{
+    char * const stop(ptr - min_digits);
+    if(base == 10)
+    {
+        while(value >= 100)
+        {
+            int const idx(static_cast<int>(value % 100) * 2);
+            value /= 100;
+            ptr -= 2;
+            ptr[0] = g_decimal_digit_pairs[idx];
+            ptr[1] = g_decimal_digit_pairs[idx + 1];
+        }
+        if(value >= 10)
+        {
+            int const idx(static_cast<int>(value) * 2);
+            ptr -= 2;
+            ptr[0] = g_decimal_digit_pairs[idx];
+            ptr[1] = g_decimal_digit_pairs[idx + 1];
+        }
+        else
+        {
+            --ptr;
+            *ptr = static_cast<char>('0' + value);
+        }
+    }
+    else
+    {
+        do
+        {
+            --ptr;
+            *ptr = digits[value % base];
+            value /= base;
+        }
+        while(value != 0);
+    }
+    while(ptr > stop)
+    {
+        --ptr;
+        *ptr = '0';
+    }
+    return ptr;
+}
+
+
+/** \brief Write an unsigned __int128 backward.
+ *
+ * This function writes \p value in \p base ending at \p end. The buffer
+ * must have room for 128 characters before \p end.
+ *
+ * Power of two bases are converted using shifts. The other bases are
+ * converted one 64 bit chunk at a time so only two or three 128 bit
+ * divisions are required.
+ *
+ * \param[in] end  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] base  The base, from 2 to 36.
+ * \param[in] uppercase  Whether to use uppercase letters.
+ *
+ * \return A pointer to the first character written.
  */
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
-inline std::string to_string(__int128 x, __int128 base = 10, bool uppercase = false)
+inline char * uint128_to_chars_backward(char * end, unsigned __int128 value, int base, bool uppercase)
+{
+    char const * digits(g_base36_digits[uppercase ? 1 : 0]);
+
+    if((base & (base - 1)) == 0)
+    {
+        int const shift(__builtin_ctz(base));
+        int const mask(base - 1);
+        do
+        {
+            --end;
+            *end = digits[static_cast<int>(value) & mask];
+            value >>= shift;
+        }
+        while(value != 0);
+        return end;
+    }
+
+    int128_chunk const & chunk(g_int128_chunks[base]);
+    while(value > std::numeric_limits<std::uint64_t>::max())
+    {
+        unsigned __int128 const q(value / chunk.f_power);
+        end = uint64_to_chars_backward(
+                  end
+                , static_cast<std::uint64_t>(value - q * chunk.f_power)
+                , base
+                , digits
+                , chunk.f_digits);
+        value = q;
+    }
+    return uint64_to_chars_backward(end, static_cast<std::uint64_t>(value), base, digits, 1);
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Copy the temporary result to the user buffer.
+ *
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] start  The start of the converted number.
+ * \param[in] end  The end of the converted number.
+ *
+ * \return The end of the number in the output buffer or nullptr if it
+ * does not fit.
+ */
+inline char * int128_copy_chars(char * first, char * last, char const * start, char const * end)
 {
-    char buf[129];  // binary requires 128 + '-' = 129 chars
+    std::size_t const size(end - start);
+    if(static_cast<std::size_t>(last - first) < size)
+    {
+        return nullptr;
+    }
+    memcpy(first, start, size);
+    return first + size;
+}
 
-    char const adjust((uppercase ? 'A' : 'a') - ('9' + 1));
 
-    int idx(sizeof(buf));
-    unsigned __int128 y(x < 0
-        ? -static_cast<unsigned __int128>(x)
-        : static_cast<unsigned __int128>(x));
-    while(y >= static_cast<unsigned __int128>(base))
+/** \brief Check the base of the int128 conversion functions.
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] base  The base to verify.
+ * \param[in] function  The name of the function, used in the error.
+ */
+inline void int128_verify_base(int base, char const * function)
+{
+    if(base < 2 || base > 36)
     {
-        --idx;
-        buf[idx] = y % base + '0';
-        if(buf[idx] > '9')
+        throw std::range_error(std::string("base is out of range in ") + function + "().");
+    }
+}
+
+
+/** \brief Convert a character to a digit.
+ *
+ * \param[in] c  The character to convert.
+ *
+ * \return The value of the digit or 36 if \p c is not a digit in any
+ * of the supported bases.
+ */
+inline int int128_digit_value(char c)
+{
+    if(c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'z')
+    {
+        return c - ('a' - 10);
+    }
+    if(c >= 'A' && c <= 'Z')
+    {
+        return c - ('A' - 10);
+    }
+    return 36;
+}
+
+
+/** \brief Parse the digits of an unsigned 128 bit number.
+ *
+ * This function parses as many digits as possible and saves the result
+ * in \p value if it is not larger than \p limit.
+ *
+ * \param[in] first  The start of the input.
+ * \param[in] last  The end of the input.
+ * \param[out] value  The resulting value.
+ * \param[in] limit  The largest acceptable value.
+ * \param[in] base  The base, from 2 to 36.
+ *
+ * \return The std::from_chars_result of the conversion.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline std::from_chars_result uint128_from_chars(
+      char const * first
+    , char const * last
+    , unsigned __int128 & value
+    , unsigned __int128 limit
+    , int base)
+{
+    int128_chunk const & chunk(g_int128_chunks[base]);
+    char const * ptr(first);
+    unsigned __int128 result(0);
+    bool overflow(false);
+    for(;;)
+    {
+        // accumulate one chunk in 64 bits
+        //
+        std::uint64_t part(0);
+        std::uint64_t multiplier(1);
+        int count(0);
+        for(; ptr < last && count < chunk.f_digits; ++ptr, ++count)
+        {
+            int const digit(int128_digit_value(*ptr));
+            if(digit >= base)
+            {
+                break;
+            }
+            part = part * base + digit;
+            multiplier *= base;
+        }
+        if(count == 0)
         {
-            buf[idx] += adjust;
+            break;
+        }
+        if(!overflow)
+        {
+            overflow = __builtin_mul_overflow(result, multiplier, &result)
+                    || __builtin_add_overflow(result, part, &result);
+        }
+        if(count < chunk.f_digits)
+        {
+            break;
         }
-        y /= base;
     }
-    --idx;
-    buf[idx] = y + '0';
-    if(buf[idx] > '9')
+
+    if(ptr == first)
     {
-        buf[idx] += adjust;
+        return std::from_chars_result{ first, std::errc::invalid_argument };
     }
-    if(x < 0)
+    if(overflow || result > limit)
+    {
+        return std::from_chars_result{ ptr, std::errc::result_out_of_range };
+    }
+    value = result;
+    return std::from_chars_result{ ptr, std::errc() };
+}
+#pragma GCC diagnostic pop
+
+
+} // namespace detail
+
+
+
+/** \brief The maximum number of characters output by int128_to_chars().
+ *
+ * The largest output is in base 2 for a negative number: 128 digits
+ * plus the minus sign.
+ */
+constexpr std::size_t int128_to_chars_max_size = 129;
+
+
+/** \brief Convert an __int128 to characters in a caller buffer.
+ *
+ * This function writes \p value in \p base to the buffer defined by
+ * \p first and \p last. It does not add a '\0'. Negative numbers are
+ * written with a '-' followed by their absolute value in all bases.
+ *
+ * If the buffer is too small, nothing is written and the function
+ * returns nullptr. A buffer of int128_to_chars_max_size characters
+ * is always large enough.
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] base  Desired base.
+ * \param[in] uppercase  Whether to use uppercase (true) or lowercase (false).
+ *
+ * \return A pointer after the last character written or nullptr.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline char * int128_to_chars(char * first, char * last, __int128 value, int base = 10, bool uppercase = false)
+{
+    detail::int128_verify_base(base, "int128_to_chars");
+
+    char buf[int128_to_chars_max_size];
+    char * const end(buf + sizeof(buf));
+    char * start(detail::uint128_to_chars_backward(
+              end
+            , value < 0
+                ? -static_cast<unsigned __int128>(value)
+                : static_cast<unsigned __int128>(value)
+            , base
+            , uppercase));
+    if(value < 0)
     {
-        --idx;
-        buf[idx] = '-';
+        --start;
+        *start = '-';
     }
+    return detail::int128_copy_chars(first, last, start, end);
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Convert an unsigned __int128 to characters in a caller buffer.
+ *
+ * This function writes \p value in \p base to the buffer defined by
+ * \p first and \p last. It does not add a '\0'.
+ *
+ * If the buffer is too small, nothing is written and the function
+ * returns nullptr.
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] first  The start of the output buffer.
+ * \param[in] last  The end of the output buffer.
+ * \param[in] value  The value to convert.
+ * \param[in] base  Desired base.
+ * \param[in] uppercase  Whether to use uppercase (true) or lowercase (false).
+ *
+ * \return A pointer after the last character written or nullptr.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline char * int128_to_chars(char * first, char * last, unsigned __int128 value, int base = 10, bool uppercase = false)
+{
+    detail::int128_verify_base(base, "int128_to_chars");
 
-    return std::string(buf + idx, sizeof(buf) - idx);
+    char buf[int128_to_chars_max_size];
+    char * const end(buf + sizeof(buf));
+    char const * start(detail::uint128_to_chars_backward(end, value, base, uppercase));
+    return detail::int128_copy_chars(first, last, start, end);
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Parse an __int128 from a string.
+ *
+ * This function works like std::from_chars(): it parses an optional
+ * '-' sign followed by digits in \p base. It does not skip spaces, does
+ * not accept a '+' sign and does not understand prefixes such as "0x".
+ * Letters are accepted in lower or upper case.
+ *
+ * On success, \p value is set and the returned `ec` is `std::errc()`.
+ * If no digits are found, `ec` is `std::errc::invalid_argument` and `ptr`
+ * is \p first. If the number does not fit in an __int128, `ec` is
+ * `std::errc::result_out_of_range` and `ptr` points after all the digits.
+ * On an error \p value is not modified.
+ *
+ * \code
+ *     __int128 value(0);
+ *     std::from_chars_result const r(snapdev::int128_from_chars(
+ *               str.data()
+ *             , str.data() + str.length()
+ *             , value));
+ *     if(r.ec != std::errc())
+ *     {
+ *         ...handle error...
+ *     }
+ * \endcode
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] first  The start of the input.
+ * \param[in] last  The end of the input.
+ * \param[out] value  The resulting value.
+ * \param[in] base  The base, from 2 to 36.
+ *
+ * \return The std::from_chars_result of the conversion.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline std::from_chars_result int128_from_chars(char const * first, char const * last, __int128 & value, int base = 10)
+{
+    detail::int128_verify_base(base, "int128_from_chars");
+
+    bool const negative(first < last && *first == '-');
+    unsigned __int128 const largest(static_cast<unsigned __int128>(1) << 127);
+    unsigned __int128 magnitude(0);
+    std::from_chars_result const result(detail::uint128_from_chars(
+              first + (negative ? 1 : 0)
+            , last
+            , magnitude
+            , negative ? largest : largest - 1
+            , base));
+    if(result.ec == std::errc::invalid_argument)
+    {
+        return std::from_chars_result{ first, std::errc::invalid_argument };
+    }
+    if(result.ec == std::errc())
+    {
+        value = static_cast<__int128>(negative ? -magnitude : magnitude);
+    }
+    return result;
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Parse an unsigned __int128 from a string.
+ *
+ * This function works like std::from_chars(): it parses digits in
+ * \p base. Signs and prefixes are not accepted.
+ *
+ * See the signed version for details about the returned value.
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] first  The start of the input.
+ * \param[in] last  The end of the input.
+ * \param[out] value  The resulting value.
+ * \param[in] base  The base, from 2 to 36.
+ *
+ * \return The std::from_chars_result of the conversion.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline std::from_chars_result int128_from_chars(char const * first, char const * last, unsigned __int128 & value, int base = 10)
+{
+    detail::int128_verify_base(base, "int128_from_chars");
+
+    return detail::uint128_from_chars(
+              first
+            , last
+            , value
+            , ~static_cast<unsigned __int128>(0)
+            , base);
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Convert an __int128 to a string.
+ *
+ * This function converts an __int128 to a string.
+ *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
+ * \param[in] x  An __int128 number.
+ * \param[in] base  The base, from 2 to 36.
+ * \param[in] uppercase  Whether to use uppercase letters.
+ *
+ * \return A string representing that __int128 number.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+inline std::string to_string(__int128 x, __int128 base = 10, bool uppercase = false)
+{
+    char buf[int128_to_chars_max_size];
+    char * const end(int128_to_chars(
+              buf
+            , buf + sizeof(buf)
+            , x
+            , base < 2 || base > 36 ? 0 : static_cast<int>(base)
+            , uppercase));
+    return std::string(buf, end);
 }
 #pragma GCC diagnostic pop
 
@@ -84,7 +574,12 @@ inline std::string to_string(__int128 x, __int128 base = 10, bool uppercase = fa
  *
  * This function converts an unsigned __int128 to a string.
  *
+ * \exception std::range_error
+ * The \p base is not between 2 and 36 inclusive.
+ *
  * \param[in] x  An unsigned __int128 number.
+ * \param[in] base  The base, from 2 to 36.
+ * \param[in] uppercase  Whether to use uppercase letters.
  *
  * \return A string representing that unsigned __int128 number.
  */
@@ -92,31 +587,162 @@ inline std::string to_string(__int128 x, __int128 base = 10, bool uppercase = fa
 #pragma GCC diagnostic ignored "-Wpedantic"
 inline std::string to_string(unsigned __int128 x, unsigned __int128 base = 10, bool uppercase = false)
 {
-    char buf[128];  // binary requires 128 chars
+    char buf[int128_to_chars_max_size];
+    char * const end(int128_to_chars(
+              buf
+            , buf + sizeof(buf)
+            , x
+            , base < 2 || base > 36 ? 0 : static_cast<int>(base)
+            , uppercase));
+    return std::string(buf, end);
+}
+#pragma GCC diagnostic pop
+
+
+namespace detail
+{
+
+
+/** \brief Read the characters of a 128 bit number from a stream.
+ *
+ * This function skips leading spaces (unless std::noskipws is used)
+ * and then reads an optional sign, a prefix and digits. The prefix
+ * depends on the stream base field: "0x" is optional with std::hex
+ * and, when no base is selected, "0x" selects base 16 and "0" selects
+ * base 8, as with scanf("%i").
+ *
+ * \param[in,out] is  The input stream.
+ * \param[out] text  The sign and digits found in the stream.
+ * \param[out] base  The base to use to convert \p text.
+ * \param[in] accept_minus  Whether the '-' sign is accepted.
+ *
+ * \return true if the input stream was in a good state.
+ */
+template<class _CharT, class _Traits>
+bool read_int128(std::basic_istream<_CharT, _Traits> & is, std::string & text, int & base, bool accept_minus)
+{
+    typename std::basic_istream<_CharT, _Traits>::sentry s(is);
+    if(!s)
+    {
+        return false;
+    }
 
-    char const adjust((uppercase ? 'A' : 'a') - ('9' + 1));
+    auto next = [&is]()
+    {
+        typename _Traits::int_type const c(is.rdbuf()->sgetc());
+        if(_Traits::eq_int_type(c, _Traits::eof()))
+        {
+            is.setstate(std::ios_base::eofbit);
+            return '\0';
+        }
+        return is.narrow(_Traits::to_char_type(c), '\0');
+    };
+    auto skip = [&is]()
+    {
+        is.rdbuf()->sbumpc();
+    };
 
-    int idx(sizeof(buf));
-    while(x >= base)
+    std::ios_base::fmtflags const fmt(is.flags() & std::ios_base::basefield);
+    base = fmt == std::ios_base::oct
+                ? 8
+                : (fmt == std::ios_base::hex
+                    ? 16
+                    : (fmt == std::ios_base::dec ? 10 : 0));
+
+    char c(next());
+    if(c == '+'
+    || (c == '-' && accept_minus))
     {
-        --idx;
-        buf[idx] = x % base + '0';
-        if(buf[idx] > '9')
+        if(c == '-')
         {
-            buf[idx] += adjust;
+            text += c;
         }
-        x /= base;
+        skip();
+        c = next();
+    }
+
+    if(c == '0'
+    && (base == 0 || base == 16))
+    {
+        skip();
+        c = next();
+        if(c == 'x' || c == 'X')
+        {
+            skip();
+            c = next();
+            base = 16;
+        }
+        else
+        {
+            text += '0';
+            if(base == 0)
+            {
+                base = 8;
+            }
+        }
+    }
+    if(base == 0)
+    {
+        base = 10;
     }
-    --idx;
-    buf[idx] = x + '0';
-    if(buf[idx] > '9')
+
+    while(c != '\0' && detail::int128_digit_value(c) < base)
     {
-        buf[idx] += adjust;
+        text += c;
+        skip();
+        c = next();
     }
 
-    return std::string(buf + idx, sizeof(buf) - idx);
+    return true;
+}
+
+
+/** \brief Save the value read from a stream.
+ *
+ * This function converts \p text and saves the result in \p x. On an
+ * error the failbit is set and \p x is set to 0 (invalid input) or to
+ * the minimum or maximum (overflow) as done by the standard operators.
+ *
+ * \param[in,out] is  The input stream.
+ * \param[in] text  The characters read by read_int128().
+ * \param[in] base  The base of the number.
+ * \param[out] x  The variable receiving the result.
+ */
+template<class _CharT, class _Traits, typename T>
+void save_int128(std::basic_istream<_CharT, _Traits> & is, std::string const & text, int base, T & x)
+{
+    T value(0);
+    char const * const last(text.data() + text.length());
+    std::from_chars_result const r(int128_from_chars(text.data(), last, value, base));
+    if(r.ec == std::errc::result_out_of_range)
+    {
+        if(text[0] == '-')
+        {
+            x = static_cast<T>(static_cast<T>(1) << 127);
+        }
+        else
+        {
+            x = static_cast<T>(~static_cast<T>(0));
+            if(static_cast<T>(-1) < 0)
+            {
+                x = static_cast<T>(x & ~(static_cast<T>(1) << 127));
+            }
+        }
+        is.setstate(std::ios_base::failbit);
+    }
+    else if(r.ec != std::errc() || r.ptr != last)
+    {
+        x = 0;
+        is.setstate(std::ios_base::failbit);
+    }
+    else
+    {
+        x = value;
+    }
 }
-#pragma GCC diagnostic pop
+
+
+} // namespace detail
 
 } // namespace snapdev
 
@@ -124,31 +750,22 @@ inline std::string to_string(unsigned __int128 x, unsigned __int128 base = 10, b
 // no namespace for operators, it's easier that way
 
 
-/** \brief Output an __int128 number.
+/** \brief Output an unsigned __int128 number.
  *
  * This function outputs the specified __int128 number to this output
  * stream. It respects the base and for hexadecimal, it also respects
  * the uppercase format.
  *
  * \note
- * The hexadecimal and octal formats do not understand negative numbers.
- * This function respects the C++ definition and prints out unsigned
- * numbers when one of the std::hex or std::oct format are set. If you
- * would prefer a negative number (i.e. -0x1 instead of 0xfff...fff)
- * then make sure to directly call the snapdev::to_string() function
- * instead.
- *
- * \warning
- * This implementation does not offer proper formatting.
- * It will first generate a string then output that string
- * which means the result is not what you'd expect if you
- * used formatting such as std::setfill() and std::setw().
+ * The number, including its prefix, is output as one string so
+ * std::setw() and std::setfill() apply to the whole number.
+ * The std::internal adjustment is not supported.
  *
  * \note
  * This is not ADL. You may need to add a `using` definition like so:
  * \code
  *     using ::operator<<;
- *     std::cout << my_int128_number;
+ *     std::cout << my_uint128_number;
  * \endcode
  *
  * \tparam _CharT  The character type of this stream.
@@ -161,68 +778,73 @@ inline std::string to_string(unsigned __int128 x, unsigned __int128 base = 10, b
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 template<class _CharT, class _Traits>
-std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _Traits> & os, __int128 x)
+std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _Traits> & os, unsigned __int128 x)
 {
     std::ios_base::fmtflags const fmt(os.flags() & std::ios_base::basefield);
+    bool const uppercase((os.flags() & std::ios_base::uppercase) != 0);
+    bool const showbase(x != 0 && (os.flags() & std::ios_base::showbase) != 0);
 
+    // the number, a "0x" prefix, and a '\0'
+    //
+    char buf[snapdev::int128_to_chars_max_size + 3];
+    char * const end(buf + sizeof(buf) - 1);
+    *end = '\0';
+    char * start(nullptr);
     if(fmt == std::ios_base::oct)
     {
-        if(x != 0
-        && (os.flags() & std::ios_base::showbase) != 0)
+        start = snapdev::detail::uint128_to_chars_backward(end, x, 8, false);
+        if(showbase)
         {
-            os << '0';
+            --start;
+            *start = '0';
         }
-        return os << snapdev::to_string(static_cast<unsigned __int128>(x), 8);
     }
-
-    if(fmt == std::ios_base::hex)
+    else if(fmt == std::ios_base::hex)
     {
-        bool const uppercase(os.flags() & std::ios_base::uppercase);
-        if(x != 0
-        && (os.flags() & std::ios_base::showbase) != 0)
+        start = snapdev::detail::uint128_to_chars_backward(end, x, 16, uppercase);
+        if(showbase)
         {
-            if(uppercase)
-            {
-                os << "0X";
-            }
-            else
-            {
-                os << "0x";
-            }
+            start -= 2;
+            start[0] = '0';
+            start[1] = uppercase ? 'X' : 'x';
         }
-        return os << snapdev::to_string(static_cast<unsigned __int128>(x), 16, uppercase);
     }
-
-    // the '-' is added by the to_string(), but not the '+'
-    //
-    if(x >= 0
-    && (os.flags() & std::ios_base::showpos) != 0)
+    else
     {
-        os << '+';
+        // unsigned do not show the '+' sign at all
+        //
+        start = snapdev::detail::uint128_to_chars_backward(end, x, 10, false);
     }
 
-    return os << snapdev::to_string(x);
+    return os << start;
 }
 #pragma GCC diagnostic pop
 
 
-/** \brief Output an unsigned __int128 number.
+/** \brief Output an __int128 number.
  *
  * This function outputs the specified __int128 number to this output
  * stream. It respects the base and for hexadecimal, it also respects
  * the uppercase format.
  *
- * \warning
- * This implementation does not offer proper formatting.
- * It will first generate a string then output that string
- * which means the result is not what you'd expect if you
- * used formatting such as std::setfill() and std::setw().
+ * \note
+ * The hexadecimal and octal formats do not understand negative numbers.
+ * This function respects the C++ definition and prints out unsigned
+ * numbers when one of the std::hex or std::oct format are set. If you
+ * would prefer a negative number (i.e. -0x1 instead of 0xfff...fff)
+ * then make sure to directly call the snapdev::to_string() function
+ * instead.
+ *
+ * \note
+ * The number, including its sign and prefix, is output as one string
+ * so std::setw() and std::setfill() apply to the whole number.
+ * The std::internal adjustment is not supported.
  *
  * \note
  * This is not ADL. You may need to add a `using` definition like so:
  * \code
  *     using ::operator<<;
- *     std::cout << my_uint128_number;
+ *     std::cout << my_int128_number;
  * \endcode
  *
  * \tparam _CharT  The character type of this stream.
@@ -235,41 +857,102 @@ std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _T
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 template<class _CharT, class _Traits>
-std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _Traits> & os, unsigned __int128 x)
+std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _Traits> & os, __int128 x)
 {
     std::ios_base::fmtflags const fmt(os.flags() & std::ios_base::basefield);
+    if(fmt == std::ios_base::oct
+    || fmt == std::ios_base::hex)
+    {
+        return os << static_cast<unsigned __int128>(x);
+    }
 
-    if(fmt == std::ios_base::oct)
+    // the number, its sign, and a '\0'
+    //
+    char buf[snapdev::int128_to_chars_max_size + 2];
+    char * const end(buf + sizeof(buf) - 1);
+    *end = '\0';
+    char * start(snapdev::detail::uint128_to_chars_backward(
+              end
+            , x < 0
+                ? -static_cast<unsigned __int128>(x)
+                : static_cast<unsigned __int128>(x)
+            , 10
+            , false));
+    if(x < 0)
     {
-        if(x != 0
-        && (os.flags() & std::ios_base::showbase) != 0)
-        {
-            os << '0';
-        }
-        return os << snapdev::to_string(x, 8);
+        --start;
+        *start = '-';
+    }
+    else if((os.flags() & std::ios_base::showpos) != 0)
+    {
+        --start;
+        *start = '+';
     }
 
-    if(fmt == std::ios_base::hex)
+    return os << start;
+}
+#pragma GCC diagnostic pop
+
+
+/** \brief Read an __int128 number.
+ *
+ * This function reads an __int128 number from this input stream. It
+ * respects the std::dec, std::hex, and std::oct base field. When no
+ * base is selected, the base is defined by the prefix ("0x" for
+ * hexadecimal, "0" for octal).
+ *
+ * On an error, the failbit is set. If the number is too large, the
+ * value is set to the minimum or maximum __int128, otherwise it is
+ * set to 0.
+ *
+ * \tparam _CharT  The character type of this stream.
+ * \tparam _Traits  The trait of this stream.
+ * \param[in] is  The input stream.
+ * \param[out] x  The variable receiving the number.
+ *
+ * \return A reference to \p is.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+template<class _CharT, class _Traits>
+std::basic_istream<_CharT, _Traits> & operator >> (std::basic_istream<_CharT, _Traits> & is, __int128 & x)
+{
+    std::string text;
+    int base(10);
+    if(snapdev::detail::read_int128(is, text, base, true))
     {
-        bool const uppercase((os.flags() & std::ios_base::uppercase) != 0);
-        if(x != 0
-        && (os.flags() & std::ios_base::showbase) != 0)
-        {
-            if(uppercase)
-            {
-                os << "0X";
-            }
-            else
-            {
-                os << "0x";
-            }
-        }
-        return os << snapdev::to_string(x, 16, uppercase);
+        snapdev::detail::save_int128(is, text, base, x);
     }
+    return is;
+}
+#pragma GCC diagnostic pop
 
-    // unsigned do not show the '+' sign at all
-    //
-    return os << snapdev::to_string(x, 10);
+
+/** \brief Read an unsigned __int128 number.
+ *
+ * This function reads an unsigned __int128 number from this input
+ * stream. It works like the signed version except that the '-' sign
+ * is not accepted.
+ *
+ * \tparam _CharT  The character type of this stream.
+ * \tparam _Traits  The trait of this stream.
+ * \param[in] is  The input stream.
+ * \param[out] x  The variable receiving the number.
+ *
+ * \return A reference to \p is.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+template<class _CharT, class _Traits>
+std::basic_istream<_CharT, _Traits> & operator >> (std::basic_istream<_CharT, _Traits> & is, unsigned __int128 & x)
+{
+    std::string text;
+    int base(10);
+    if(snapdev::detail::read_int128(is, text, base, false))
+    {
+        snapdev::detail::save_int128(is, text, base, x);
+    }
+    return is;
 }
 #pragma GCC diagnostic pop
 
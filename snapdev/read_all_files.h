@@ -0,0 +1,148 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Read many files at once.
+ *
+ * Reading thousands of small files one after the other is slow when
+ * they are not yet in the page cache since each read waits on the disk.
+ * The read_all_files() function reads the files from several threads
+ * so many reads are pending at the same time.
+ */
+
+// self
+//
+#include    <snapdev/file_contents.h>
+
+
+// C++
+//
+#include    <algorithm>
+#include    <atomic>
+#include    <string>
+#include    <system_error>
+#include    <thread>
+#include    <vector>
+
+
+
+namespace snapdev
+{
+
+
+
+/** \brief The default maximum number of threads used by read_all_files().
+ *
+ * Reading files is mostly waiting on the disk so we use more threads
+ * than there are processors.
+ */
+constexpr std::size_t const READ_ALL_FILES_DEFAULT_THREADS = 16;
+
+
+/** \brief Read a list of files concurrently.
+ *
+ * This function creates one file_contents object per filename and calls
+ * their read_all() function from a set of threads. The calling thread
+ * also reads files so the function works even if no thread can be
+ * created.
+ *
+ * The result is in the same order as \p filenames. Each file_contents
+ * carries its own error: a file which could not be read has an empty
+ * contents() and a non-empty last_error().
+ *
+ * \code
+ *     std::vector<snapdev::file_contents> const files(snapdev::read_all_files(filenames));
+ *     for(auto const & f : files)
+ *     {
+ *         if(!f.last_error().empty())
+ *         {
+ *             std::cerr << f.last_error() << "\n";
+ *             continue;
+ *         }
+ *         ...use f.contents()...
+ *     }
+ * \endcode
+ *
+ * \param[in] filenames  The names of the files to read.
+ * \param[in] thread_count  The maximum number of threads to use, 0 to
+ *            use READ_ALL_FILES_DEFAULT_THREADS.
+ * \param[in] mode  The size mode used to read all the files.
+ *
+ * \return The file_contents of each file in the order of \p filenames.
+ */
+inline std::vector<file_contents> read_all_files(
+          std::vector<std::string> const & filenames
+        , std::size_t thread_count = 0
+        , file_contents::size_mode_t mode = file_contents::size_mode_t::SIZE_MODE_SEEK)
+{
+    std::vector<file_contents> result;
+    result.reserve(filenames.size());
+    for(auto const & f : filenames)
+    {
+        result.emplace_back(f);
+        result.back().size_mode(mode);
+    }
+
+    std::atomic<std::size_t> next(0);
+    auto const worker([&result, &next]()
+        {
+            for(;;)
+            {
+                std::size_t const idx(next.fetch_add(1, std::memory_order_relaxed));
+                if(idx >= result.size())
+                {
+                    return;
+                }
+                result[idx].read_all();
+            }
+        });
+
+    if(thread_count == 0)
+    {
+        thread_count = READ_ALL_FILES_DEFAULT_THREADS;
+    }
+    thread_count = std::min(thread_count, result.size());
+
+    // the calling thread is one of the workers
+    //
+    std::vector<std::thread> threads;
+    for(std::size_t i(1); i < thread_count; ++i)
+    {
+        try
+        {
+            threads.emplace_back(worker);
+        }
+        catch(std::system_error const &)    // LCOV_EXCL_LINE
+        {
+            break;                          // LCOV_EXCL_LINE
+        }
+    }
+    worker();
+    for(auto & t : threads)
+    {
+        t.join();
+    }
+
+    return result;
+}
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
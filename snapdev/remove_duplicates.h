@@ -34,11 +34,22 @@
  * `std::set<T>` and `std::map<T,bool>`.
  * \li There are unsorted versions of containers that you may be able
  * to use for the purpose.
+ * \li The unsorted_remove_duplicates() function keeps the first occurrence
+ * of each element in its original order. When the elements can be hashed,
+ * it runs in O(n) using a hash table, otherwise it is O(n^2). A parallel
+ * version is available for very large vectors.
  */
 
 // C++
 //
 #include    <algorithm>
+#include    <exception>
+#include    <functional>
+#include    <iterator>
+#include    <thread>
+#include    <type_traits>
+#include    <unordered_set>
+#include    <vector>
 
 
 
@@ -149,14 +160,293 @@ ForwardIterator remove_duplicates(ForwardIterator first, ForwardIterator end)
 }
 
 
+/** \brief Below this number of elements, use the linear search.
+ *
+ * For tiny inputs, the O(n^2) search is faster than allocating and
+ * filling a hash table.
+ */
+constexpr std::size_t       REMOVE_DUPLICATES_LINEAR_THRESHOLD = 32;
+
+
+namespace detail
+{
+
+
+/** \brief Check whether std::hash<T> is available.
+ *
+ * A disabled std::hash<> specialization is not default constructible.
+ *
+ * \tparam T  The type to check.
+ */
+template<typename T>
+constexpr bool is_hashable_v = std::is_default_constructible_v<std::hash<T>>;
+
+
+/** \brief Move the elements marked to be kept to the front.
+ *
+ * \tparam ForwardIterator  The type of iterator from your container.
+ * \param[in] first  Forward iterator to the container's first element.
+ * \param[in] end  Forward iterator to the container's last element + 1.
+ * \param[in] keep  One flag per element, true for the elements to keep.
+ *
+ * \return The new end of your container.
+ */
+template<typename ForwardIterator, typename FlagT>
+ForwardIterator compact_duplicates(ForwardIterator first, ForwardIterator end, std::vector<FlagT> const & keep)
+{
+    auto new_end(first);
+    std::size_t idx(0);
+    for(auto current(first); current != end; ++current, ++idx)
+    {
+        if(keep[idx])
+        {
+            if(new_end != current)
+            {
+                *new_end = std::move(*current);
+            }
+            ++new_end;
+        }
+    }
+    return new_end;
+}
+
+
+} // namespace detail
+
+
+/** \brief Function to replace duplicate objects using a hash table.
+ *
+ * This function works like remove_duplicates(): it keeps the first
+ * occurrence of each element in the original order and returns the
+ * new end of the range. It does not erase anything.
+ *
+ * The elements are searched in a hash table so the function is O(n).
+ * Each element is hashed exactly once. For ranges of less than
+ * REMOVE_DUPLICATES_LINEAR_THRESHOLD elements, the linear search
+ * of remove_duplicates() is used instead.
+ *
+ * \tparam ForwardIterator  The type of iterator from your container.
+ * \tparam Hash  The hash function of the elements.
+ * \tparam KeyEqual  The function comparing two elements for equality.
+ * \param[in] first  Forward iterator to the container's first element.
+ * \param[in] end  Forward iterator to the container's last element + 1.
+ * \param[in] hash  The hash object.
+ * \param[in] equal  The equality object.
+ *
+ * \return The new end of your container.
+ *
+ * \sa parallel_remove_duplicates()
+ */
+template<
+      typename ForwardIterator
+    , typename Hash = std::hash<typename std::iterator_traits<ForwardIterator>::value_type>
+    , typename KeyEqual = std::equal_to<typename std::iterator_traits<ForwardIterator>::value_type>>
+ForwardIterator hashed_remove_duplicates(
+      ForwardIterator first
+    , ForwardIterator end
+    , Hash const & hash = Hash()
+    , KeyEqual const & equal = KeyEqual())
+{
+    std::size_t const size(std::distance(first, end));
+    if(size < REMOVE_DUPLICATES_LINEAR_THRESHOLD)
+    {
+        auto new_end(first);
+        for(auto current(first); current != end; ++current)
+        {
+            auto const found(std::find_if(
+                      first
+                    , new_end
+                    , [&equal, &current](auto const & item)
+                      {
+                          return equal(item, *current);
+                      }));
+            if(found == new_end)
+            {
+                if(new_end != current)
+                {
+                    *new_end = std::move(*current);
+                }
+                ++new_end;
+            }
+        }
+        return new_end;
+    }
+
+    // the set references the elements by iterator; the first pass does not
+    // move anything so those iterators remain valid
+    //
+    auto deref_hash = [&hash](ForwardIterator it)
+    {
+        return hash(*it);
+    };
+    auto deref_equal = [&equal](ForwardIterator lhs, ForwardIterator rhs)
+    {
+        return equal(*lhs, *rhs);
+    };
+    std::unordered_set<ForwardIterator, decltype(deref_hash), decltype(deref_equal)> seen(
+              size
+            , deref_hash
+            , deref_equal);
+    std::vector<bool> keep(size);
+    std::size_t idx(0);
+    for(auto current(first); current != end; ++current, ++idx)
+    {
+        keep[idx] = seen.insert(current).second;
+    }
+
+    return detail::compact_duplicates(first, end, keep);
+}
+
+
+/** \brief Function to replace duplicate objects using several threads.
+ *
+ * This function works like hashed_remove_duplicates() but uses up to
+ * \p thread_count threads. It is useful for very large ranges (100,000
+ * elements or more). Smaller ranges are processed in the current thread.
+ *
+ * The hashes are computed in parallel first. Then each thread handles
+ * the elements which hash to its own shard. Since equal elements have
+ * equal hashes, all the copies of an element are in the same shard and
+ * they are visited in their original order so the first occurrence is
+ * the one kept.
+ *
+ * \note
+ * The \p hash and \p equal objects get called from several threads
+ * at the same time.
+ *
+ * \tparam RandomAccessIterator  The type of iterator from your container.
+ * \tparam Hash  The hash function of the elements.
+ * \tparam KeyEqual  The function comparing two elements for equality.
+ * \param[in] first  Iterator to the container's first element.
+ * \param[in] end  Iterator to the container's last element + 1.
+ * \param[in] thread_count  The number of threads, 0 for one per CPU.
+ * \param[in] hash  The hash object.
+ * \param[in] equal  The equality object.
+ *
+ * \return The new end of your container.
+ *
+ * \sa hashed_remove_duplicates()
+ */
+template<
+      typename RandomAccessIterator
+    , typename Hash = std::hash<typename std::iterator_traits<RandomAccessIterator>::value_type>
+    , typename KeyEqual = std::equal_to<typename std::iterator_traits<RandomAccessIterator>::value_type>>
+RandomAccessIterator parallel_remove_duplicates(
+      RandomAccessIterator first
+    , RandomAccessIterator end
+    , std::size_t thread_count = 0
+    , Hash const & hash = Hash()
+    , KeyEqual const & equal = KeyEqual())
+{
+    constexpr std::size_t const minimum_per_thread = 10'000;
+
+    std::size_t const size(end - first);
+    if(thread_count == 0)
+    {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, size / minimum_per_thread);
+    if(thread_count <= 1)
+    {
+        return hashed_remove_duplicates(first, end, hash, equal);
+    }
+
+    std::vector<std::size_t> hashes(size);
+    std::vector<char> keep(size);     // not vector<bool>, each thread writes its own bytes
+    std::vector<std::exception_ptr> errors(thread_count);
+
+    auto run = [thread_count, &errors](auto const & worker)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for(std::size_t t(0); t < thread_count; ++t)
+        {
+            threads.emplace_back([t, &worker, &errors]()
+                {
+                    try
+                    {
+                        worker(t);
+                    }
+                    catch(...)
+                    {
+                        errors[t] = std::current_exception();
+                    }
+                });
+        }
+        for(auto & th : threads)
+        {
+            th.join();
+        }
+        for(auto const & e : errors)
+        {
+            if(e != nullptr)
+            {
+                std::rethrow_exception(e);
+            }
+        }
+    };
+
+    // 1. compute the hashes, one slice per thread
+    //
+    run([&](std::size_t t)
+        {
+            std::size_t const start(size * t / thread_count);
+            std::size_t const stop(size * (t + 1) / thread_count);
+            for(std::size_t idx(start); idx < stop; ++idx)
+            {
+                hashes[idx] = hash(first[idx]);
+            }
+        });
+
+    // 2. search for duplicates, one shard per thread
+    //
+    run([&](std::size_t t)
+        {
+            auto shard = [thread_count](std::size_t h)
+            {
+                // mix the bits so the shard does not correlate with the
+                // bucket used in the hash table
+                //
+                return ((h * 0x9E3779B97F4A7C15ULL) >> 32) % thread_count;
+            };
+            auto index_hash = [&hashes](std::size_t idx)
+            {
+                return hashes[idx];
+            };
+            auto index_equal = [&first, &equal](std::size_t lhs, std::size_t rhs)
+            {
+                return equal(first[lhs], first[rhs]);
+            };
+            std::unordered_set<std::size_t, decltype(index_hash), decltype(index_equal)> seen(
+                      size / thread_count + 1
+                    , index_hash
+                    , index_equal);
+            for(std::size_t idx(0); idx < size; ++idx)
+            {
+                if(shard(hashes[idx]) == t)
+                {
+                    keep[idx] = seen.insert(idx).second;
+                }
+            }
+        });
+
+    // 3. move the elements to keep
+    //
+    return detail::compact_duplicates(first, end, keep);
+}
+
+
 /** \brief Remove duplicates without sorting the container.
  *
  * This function goes through the elements of your container and eliminates
  * duplicates. The input does not have to be sorted and the returned function
- * does not change the order.
+ * does not change the order. The first occurrence of each element is kept.
  *
- * The algorithm is O(n^2). If sorting is okay, then use the
- * sort_and_remove_duplicates() directly.
+ * When std::hash<> is available for the elements, the algorithm is O(n)
+ * (see hashed_remove_duplicates()). Otherwise it is O(n^2) (see
+ * remove_duplicates()); in that case, if sorting is okay, then use the
+ * sort_and_remove_duplicates() directly or pass your own hash function
+ * to the other version of this function.
  *
  * \tparam ContainerT  The type of container to de-dup.
  * \param[in,out] container  The container where duplicates get removed.
@@ -164,13 +454,106 @@ ForwardIterator remove_duplicates(ForwardIterator first, ForwardIterator end)
  * \return The reference to the input container (NOT A COPY).
  *
  * \sa remove_duplicates()
+ * \sa hashed_remove_duplicates()
  */
 template<typename ContainerT>
 ContainerT & unsorted_remove_duplicates(ContainerT & container)
 {
-    container.erase(remove_duplicates(
+    if constexpr(detail::is_hashable_v<typename ContainerT::value_type>)
+    {
+        container.erase(hashed_remove_duplicates(
+                              container.begin()
+                            , container.end())
+                        , container.end());
+    }
+    else
+    {
+        container.erase(remove_duplicates(
+                              container.begin()
+                            , container.end())
+                        , container.end());
+    }
+
+    return container;
+}
+
+
+/** \brief Remove duplicates without sorting using your own hash function.
+ *
+ * This function is the same as unsorted_remove_duplicates() with
+ * a hash and an equality function of your choice.
+ *
+ * \code
+ *     // remove duplicate hostnames ignoring case
+ *     snapdev::unsorted_remove_duplicates(
+ *               hostnames
+ *             , snapdev::case_insensitive_hash()
+ *             , snapdev::case_insensitive_equal());
+ * \endcode
+ *
+ * \tparam ContainerT  The type of container to de-dup.
+ * \tparam Hash  The hash function of the elements.
+ * \tparam KeyEqual  The function comparing two elements for equality.
+ * \param[in,out] container  The container where duplicates get removed.
+ * \param[in] hash  The hash object.
+ * \param[in] equal  The equality object.
+ *
+ * \return The reference to the input container (NOT A COPY).
+ */
+template<
+      typename ContainerT
+    , typename Hash
+    , typename KeyEqual = std::equal_to<typename ContainerT::value_type>>
+ContainerT & unsorted_remove_duplicates(
+      ContainerT & container
+    , Hash const & hash
+    , KeyEqual const & equal = KeyEqual())
+{
+    container.erase(hashed_remove_duplicates(
                           container.begin()
-                        , container.end())
+                        , container.end()
+                        , hash
+                        , equal)
+                    , container.end());
+
+    return container;
+}
+
+
+/** \brief Remove duplicates without sorting using several threads.
+ *
+ * This function is the same as unsorted_remove_duplicates() except that
+ * the work is done by up to \p thread_count threads. The container
+ * must offer random access iterators (i.e. std::vector).
+ *
+ * \tparam ContainerT  The type of container to de-dup.
+ * \tparam Hash  The hash function of the elements.
+ * \tparam KeyEqual  The function comparing two elements for equality.
+ * \param[in,out] container  The container where duplicates get removed.
+ * \param[in] thread_count  The number of threads, 0 for one per CPU.
+ * \param[in] hash  The hash object.
+ * \param[in] equal  The equality object.
+ *
+ * \return The reference to the input container (NOT A COPY).
+ *
+ * \sa parallel_remove_duplicates()
+ */
+template<
+      typename ContainerT
+    , typename Hash = std::hash<typename ContainerT::value_type>
+    , typename KeyEqual = std::equal_to<typename ContainerT::value_type>>
+ContainerT & parallel_unsorted_remove_duplicates(
+      ContainerT & container
+    , std::size_t thread_count = 0
+    , Hash const & hash = Hash()
+    , KeyEqual const & equal = KeyEqual())
+{
+    container.erase(parallel_remove_duplicates(
+                          container.begin()
+                        , container.end()
+                        , thread_count
+                        , hash
+                        , equal)
                     , container.end());
 
     return container;
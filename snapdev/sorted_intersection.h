@@ -0,0 +1,465 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+/** \file
+ * \brief Intersection of sorted random access ranges.
+ *
+ * The functions found here compute the intersection of two sorted
+ * ranges such as vectors and spans, count the number of elements in
+ * that intersection, or check whether it is empty.
+ *
+ * The ranges are expected to be sorted with the specified comparator
+ * and not include duplicates (i.e. they represent sets).
+ *
+ * \li When one range is much smaller than the other, each element of the
+ * small range is searched in the large one with a galloping (exponential)
+ * search so the cost is O(n log(m / n)) instead of O(n + m).
+ * \li When both ranges are contiguous arrays of 32 bit integers sorted
+ * with std::less, the merge compares blocks of 4 by 4 elements with SSE2.
+ * \li Otherwise a standard merge is used.
+ *
+ * \code
+ *     std::vector<gid_t> const user_groups(...);   // sorted
+ *     std::vector<gid_t> const allowed_groups(...); // sorted
+ *     if(snapdev::sorted_intersection_empty(user_groups, allowed_groups))
+ *     {
+ *         ...access denied...
+ *     }
+ * \endcode
+ */
+
+// C++
+//
+#include    <algorithm>
+#include    <cstdint>
+#include    <functional>
+#include    <iterator>
+#include    <memory>
+#include    <type_traits>
+
+
+// C
+//
+#if defined(__SSE2__)
+#include    <emmintrin.h>
+#endif
+
+
+
+namespace snapdev
+{
+
+
+/** \brief Size ratio at which the galloping search is used.
+ *
+ * When one range is more than this many times larger than the other,
+ * the elements of the small range get searched in the large range
+ * instead of merging both ranges.
+ */
+constexpr std::size_t       SORTED_INTERSECTION_GALLOP_RATIO = 32;
+
+
+namespace detail
+{
+
+
+/** \brief Check whether the SSE2 merge can be used.
+ *
+ * The iterators must point to contiguous arrays of the same 32 bit
+ * integer type and the comparator must be std::less.
+ *
+ * \tparam It1  The iterator of the first range.
+ * \tparam It2  The iterator of the second range.
+ * \tparam Compare  The comparator.
+ */
+template<typename It1, typename It2, typename Compare>
+constexpr bool sorted_intersection_vectorizable()
+{
+    typedef std::remove_cv_t<typename std::iterator_traits<It1>::value_type> type1_t;
+    typedef std::remove_cv_t<typename std::iterator_traits<It2>::value_type> type2_t;
+
+    if constexpr(std::contiguous_iterator<It1>
+              && std::contiguous_iterator<It2>
+              && std::is_same_v<type1_t, type2_t>
+              && std::is_integral_v<type1_t>
+              && sizeof(type1_t) == 4)
+    {
+        return std::is_same_v<Compare, std::less<type1_t>>
+            || std::is_same_v<Compare, std::less<>>;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+
+/** \brief Search the first element not less than \p value.
+ *
+ * This function checks elements at offsets 1, 2, 4, 8, etc. and then
+ * does a binary search in the last interval. It is faster than
+ * std::lower_bound() when the result is close to \p first.
+ *
+ * \param[in] first  The start of the range.
+ * \param[in] last  The end of the range.
+ * \param[in] value  The value to search.
+ * \param[in] comp  The comparator.
+ *
+ * \return An iterator to the first element not less than \p value.
+ */
+template<typename It, typename T, typename Compare>
+It gallop_lower_bound(It first, It last, T const & value, Compare & comp)
+{
+    typedef typename std::iterator_traits<It>::difference_type difference_t;
+
+    difference_t const size(last - first);
+    if(size == 0
+    || !comp(*first, value))
+    {
+        return first;
+    }
+
+    // here first[bound / 2] < value
+    //
+    difference_t bound(1);
+    while(bound < size && comp(first[bound], value))
+    {
+        bound *= 2;
+    }
+    return std::lower_bound(
+              first + bound / 2 + 1
+            , first + std::min(bound, size)
+            , value
+            , comp);
+}
+
+
+/** \brief Intersect a small range with a large range.
+ *
+ * \param[in] first1  The start of the small range.
+ * \param[in] last1  The end of the small range.
+ * \param[in] first2  The start of the large range.
+ * \param[in] last2  The end of the large range.
+ * \param[in] comp  The comparator.
+ * \param[in] match  Called with each element found in both ranges; return
+ * false to stop the search.
+ */
+template<typename It1, typename It2, typename Compare, typename Match>
+void gallop_intersection(It1 first1, It1 last1, It2 first2, It2 last2, Compare & comp, Match & match)
+{
+    for(; first1 != last1; ++first1)
+    {
+        first2 = gallop_lower_bound(first2, last2, *first1, comp);
+        if(first2 == last2)
+        {
+            return;
+        }
+        if(!comp(*first1, *first2))
+        {
+            if(!match(*first1))
+            {
+                return;
+            }
+            ++first2;
+        }
+    }
+}
+
+
+#if defined(__SSE2__)
+/** \brief Merge two arrays of 32 bit integers 4 by 4.
+ *
+ * Each block of 4 elements of \p a is compared against the 4 rotations
+ * of a block of \p b. Then the block with the smallest last element
+ * is skipped.
+ *
+ * \param[in,out] a  The first array, on return, where the scalar merge
+ * has to continue.
+ * \param[in] a_end  The end of the first array.
+ * \param[in,out] b  The second array, on return, where the scalar merge
+ * has to continue.
+ * \param[in] b_end  The end of the second array.
+ * \param[in] match  Called with each element found in both arrays.
+ *
+ * \return false if \p match asked to stop.
+ */
+template<typename T, typename Match>
+bool simd_intersection(T const * & a, T const * a_end, T const * & b, T const * b_end, Match & match)
+{
+    while(a_end - a >= 4 && b_end - b >= 4)
+    {
+        __m128i const va(_mm_loadu_si128(reinterpret_cast<__m128i const *>(a)));
+        __m128i const vb(_mm_loadu_si128(reinterpret_cast<__m128i const *>(b)));
+        __m128i found(_mm_cmpeq_epi32(va, vb));
+        found = _mm_or_si128(found, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        found = _mm_or_si128(found, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        found = _mm_or_si128(found, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask(_mm_movemask_ps(_mm_castsi128_ps(found)));
+        while(mask != 0)
+        {
+            if(!match(a[__builtin_ctz(mask)]))
+            {
+                return false;
+            }
+            mask &= mask - 1;
+        }
+
+        T const a_max(a[3]);
+        T const b_max(b[3]);
+        if(a_max <= b_max)
+        {
+            a += 4;
+        }
+        if(b_max <= a_max)
+        {
+            b += 4;
+        }
+    }
+    return true;
+}
+#endif
+
+
+/** \brief Call \p match with each element found in both ranges.
+ *
+ * This function selects the galloping search, the SSE2 merge, or the
+ * standard merge.
+ *
+ * \param[in] first1  The start of the first range.
+ * \param[in] last1  The end of the first range.
+ * \param[in] first2  The start of the second range.
+ * \param[in] last2  The end of the second range.
+ * \param[in] comp  The comparator.
+ * \param[in] match  Called with each element found in both ranges; return
+ * false to stop the search.
+ */
+template<typename It1, typename It2, typename Compare, typename Match>
+void sorted_intersection_apply(It1 first1, It1 last1, It2 first2, It2 last2, Compare & comp, Match & match)
+{
+    std::size_t const size1(last1 - first1);
+    std::size_t const size2(last2 - first2);
+    if(size1 == 0
+    || size2 == 0)
+    {
+        return;
+    }
+
+    if(size1 * SORTED_INTERSECTION_GALLOP_RATIO < size2)
+    {
+        gallop_intersection(first1, last1, first2, last2, comp, match);
+        return;
+    }
+    if(size2 * SORTED_INTERSECTION_GALLOP_RATIO < size1)
+    {
+        gallop_intersection(first2, last2, first1, last1, comp, match);
+        return;
+    }
+
+#if defined(__SSE2__)
+    if constexpr(sorted_intersection_vectorizable<It1, It2, Compare>())
+    {
+        auto a(std::to_address(first1));
+        auto b(std::to_address(first2));
+        if(!simd_intersection(a, std::to_address(last1), b, std::to_address(last2), match))
+        {
+            return;
+        }
+        first1 += a - std::to_address(first1);
+        first2 += b - std::to_address(first2);
+    }
+#endif
+
+    while(first1 != last1 && first2 != last2)
+    {
+        if(comp(*first1, *first2))
+        {
+            ++first1;
+        }
+        else if(comp(*first2, *first1))
+        {
+            ++first2;
+        }
+        else
+        {
+            if(!match(*first1))
+            {
+                return;
+            }
+            ++first1;
+            ++first2;
+        }
+    }
+}
+
+
+} // namespace detail
+
+
+
+/** \brief Copy the intersection of two sorted ranges.
+ *
+ * This function copies the elements found in both ranges to \p out,
+ * in order. The ranges must be sorted with \p comp and not include
+ * duplicates.
+ *
+ * \tparam It1  The random access iterator of the first range.
+ * \tparam It2  The random access iterator of the second range.
+ * \tparam OutputIt  The output iterator.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] first1  The start of the first range.
+ * \param[in] last1  The end of the first range.
+ * \param[in] first2  The start of the second range.
+ * \param[in] last2  The end of the second range.
+ * \param[in] out  Where the intersection gets written.
+ * \param[in] comp  The comparator.
+ *
+ * \return The output iterator after the last element written.
+ */
+template<typename It1, typename It2, typename OutputIt, typename Compare = std::less<>>
+OutputIt sorted_intersection(It1 first1, It1 last1, It2 first2, It2 last2, OutputIt out, Compare comp = Compare())
+{
+    auto match = [&out](auto const & value)
+    {
+        *out = value;
+        ++out;
+        return true;
+    };
+    detail::sorted_intersection_apply(first1, last1, first2, last2, comp, match);
+    return out;
+}
+
+
+/** \brief Count the number of elements in the intersection of two ranges.
+ *
+ * The ranges must be sorted with \p comp and not include duplicates.
+ *
+ * \tparam It1  The random access iterator of the first range.
+ * \tparam It2  The random access iterator of the second range.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] first1  The start of the first range.
+ * \param[in] last1  The end of the first range.
+ * \param[in] first2  The start of the second range.
+ * \param[in] last2  The end of the second range.
+ * \param[in] comp  The comparator.
+ *
+ * \return The number of elements found in both ranges.
+ */
+template<typename It1, typename It2, typename Compare = std::less<>>
+std::size_t sorted_intersection_count(It1 first1, It1 last1, It2 first2, It2 last2, Compare comp = Compare())
+{
+    std::size_t count(0);
+    auto match = [&count](auto const &)
+    {
+        ++count;
+        return true;
+    };
+    detail::sorted_intersection_apply(first1, last1, first2, last2, comp, match);
+    return count;
+}
+
+
+/** \brief Check whether two sorted ranges have elements in common.
+ *
+ * The function returns as soon as one element is found in both ranges.
+ * The ranges must be sorted with \p comp and not include duplicates.
+ *
+ * \tparam It1  The random access iterator of the first range.
+ * \tparam It2  The random access iterator of the second range.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] first1  The start of the first range.
+ * \param[in] last1  The end of the first range.
+ * \param[in] first2  The start of the second range.
+ * \param[in] last2  The end of the second range.
+ * \param[in] comp  The comparator.
+ *
+ * \return true if the intersection is empty, false otherwise.
+ */
+template<typename It1, typename It2, typename Compare = std::less<>>
+bool sorted_intersection_empty(It1 first1, It1 last1, It2 first2, It2 last2, Compare comp = Compare())
+{
+    bool empty(true);
+    auto match = [&empty](auto const &)
+    {
+        empty = false;
+        return false;
+    };
+    detail::sorted_intersection_apply(first1, last1, first2, last2, comp, match);
+    return empty;
+}
+
+
+/** \brief Copy the intersection of two sorted containers.
+ *
+ * \tparam Range1  The type of the first container (i.e. std::vector).
+ * \tparam Range2  The type of the second container.
+ * \tparam OutputIt  The output iterator.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] lhs  The first container.
+ * \param[in] rhs  The second container.
+ * \param[in] out  Where the intersection gets written.
+ * \param[in] comp  The comparator.
+ *
+ * \return The output iterator after the last element written.
+ */
+template<typename Range1, typename Range2, typename OutputIt, typename Compare = std::less<>>
+OutputIt sorted_intersection(Range1 const & lhs, Range2 const & rhs, OutputIt out, Compare comp = Compare())
+{
+    return sorted_intersection(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), out, comp);
+}
+
+
+/** \brief Count the elements in the intersection of two sorted containers.
+ *
+ * \tparam Range1  The type of the first container (i.e. std::vector).
+ * \tparam Range2  The type of the second container.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] lhs  The first container.
+ * \param[in] rhs  The second container.
+ * \param[in] comp  The comparator.
+ *
+ * \return The number of elements found in both containers.
+ */
+template<typename Range1, typename Range2, typename Compare = std::less<>>
+std::size_t sorted_intersection_count(Range1 const & lhs, Range2 const & rhs, Compare comp = Compare())
+{
+    return sorted_intersection_count(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), comp);
+}
+
+
+/** \brief Check whether two sorted containers have elements in common.
+ *
+ * \tparam Range1  The type of the first container (i.e. std::vector).
+ * \tparam Range2  The type of the second container.
+ * \tparam Compare  The comparator, std::less<> by default.
+ * \param[in] lhs  The first container.
+ * \param[in] rhs  The second container.
+ * \param[in] comp  The comparator.
+ *
+ * \return true if the intersection is empty, false otherwise.
+ */
+template<typename Range1, typename Range2, typename Compare = std::less<>>
+bool sorted_intersection_empty(Range1 const & lhs, Range2 const & rhs, Compare comp = Compare())
+{
+    return sorted_intersection_empty(std::begin(lhs), std::end(lhs), std::begin(rhs), std::end(rhs), comp);
+}
+
+
+
+} // namespace snapdev
+// vim: ts=4 sw=4 et
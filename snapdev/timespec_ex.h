@@ -87,8 +87,14 @@ DECLARE_EXCEPTION(timespec_ex_exception, overflow);
  *
  * The ostream system makes use of a few internal variables and functions
  * which are defined here.
+ *
+ * \note
+ * These must not be placed in an unnamed namespace. The ostream index
+ * has to be shared by all the translation units of a program, otherwise
+ * a manipulator applied in one unit would be ignored by the operator<<()
+ * instantiated in another.
  */
-namespace
+namespace detail
 {
 
 
@@ -156,7 +162,7 @@ inline int get_ostream_index()
 
 
 
-} // no name namespace
+} // namespace detail
 
 
 class timespec_ex;
@@ -1479,16 +1485,16 @@ inline void basic_stream_event_callback(std::ios_base::event e, std::ios_base &
     switch(e)
     {
     case std::ios_base::erase_event:
-        delete static_cast<_ostream_info *>(out.pword(index));
+        delete static_cast<detail::_ostream_info *>(out.pword(index));
         out.pword(index) = nullptr;
         break;
 
     case std::ios_base::copyfmt_event:
         {
-            _ostream_info * info(static_cast<_ostream_info *>(out.pword(index)));
+            detail::_ostream_info * info(static_cast<detail::_ostream_info *>(out.pword(index)));
             if(info != nullptr)
             {
-                _ostream_info * new_info(new _ostream_info(*info));
+                detail::_ostream_info * new_info(new detail::_ostream_info(*info));
                 out.pword(index) = new_info;
             }
         }
@@ -1568,11 +1574,11 @@ template<typename _CharT, typename _Traits>
 inline std::basic_ostream<_CharT, _Traits> &
 operator << (std::basic_ostream<_CharT, _Traits> & os, _setremovetrailingzeroes removetrailingzeroes)
 {
-    int const index(get_ostream_index());
-    _ostream_info * info(static_cast<_ostream_info *>(os.pword(index)));
+    int const index(detail::get_ostream_index());
+    detail::_ostream_info * info(static_cast<detail::_ostream_info *>(os.pword(index)));
     if(info == nullptr)
     {
-        info = new _ostream_info;
+        info = new detail::_ostream_info;
         os.pword(index) = info;
         os.register_callback(basic_stream_event_callback, index);
     }
@@ -1613,8 +1619,8 @@ template<typename _CharT, typename _Traits>
 std::basic_ostream<_CharT, _Traits> & operator << (std::basic_ostream<_CharT, _Traits> & os, timespec const & t)
 {
     bool remove_trailing_zeroes(true);
-    int const index(get_ostream_index());
-    _ostream_info * info(static_cast<_ostream_info *>(os.pword(index)));
+    int const index(detail::get_ostream_index());
+    detail::_ostream_info * info(static_cast<detail::_ostream_info *>(os.pword(index)));
     if(info != nullptr)
     {
         remove_trailing_zeroes = info->f_remove_trailing_zeroes;
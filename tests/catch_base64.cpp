@@ -0,0 +1,283 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the base64 encoder and decoder.
+ *
+ * This file implements tests for the base64 and base64url functions
+ * and the chunked encoder and decoder classes.
+ */
+
+// self
+//
+#include    <snapdev/base64.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+// straightforward bit by bit implementation used to verify the library
+//
+std::string slow_base64(std::string const & binary, bool url)
+{
+    std::string const digits(url
+            ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+            : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+    std::string result;
+    int bits(0);
+    int count(0);
+    for(auto const c : binary)
+    {
+        bits = (bits << 8) | static_cast<std::uint8_t>(c);
+        count += 8;
+        while(count >= 6)
+        {
+            count -= 6;
+            result += digits[(bits >> count) & 0x3F];
+        }
+    }
+    if(count > 0)
+    {
+        result += digits[(bits << (6 - count)) & 0x3F];
+    }
+    if(!url)
+    {
+        while((result.length() & 3) != 0)
+        {
+            result += '=';
+        }
+    }
+    return result;
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("base64_rfc4648", "[base64][string]")
+{
+    CATCH_START_SECTION("base64: RFC 4648 test vectors")
+    {
+        char const * vectors[][2] = {
+            { "",       ""         },
+            { "f",      "Zg=="     },
+            { "fo",     "Zm8="     },
+            { "foo",    "Zm9v"     },
+            { "foob",   "Zm9vYg==" },
+            { "fooba",  "Zm9vYmE=" },
+            { "foobar", "Zm9vYmFy" },
+        };
+        for(auto const & v : vectors)
+        {
+            CATCH_REQUIRE(snapdev::base64_encode(std::string(v[0])) == v[1]);
+            CATCH_REQUIRE(snapdev::base64_decode(v[1]) == v[0]);
+            CATCH_REQUIRE(snapdev::base64_decoded_size(v[1]) == strlen(v[0]));
+            CATCH_REQUIRE(snapdev::base64_encoded_size(strlen(v[0])) == strlen(v[1]));
+
+            std::string unpadded(v[1]);
+            while(!unpadded.empty() && unpadded.back() == '=')
+            {
+                unpadded.pop_back();
+            }
+            CATCH_REQUIRE(snapdev::base64url_encode(std::string(v[0])) == unpadded);
+            CATCH_REQUIRE(snapdev::base64url_decode(unpadded) == v[0]);
+            CATCH_REQUIRE(snapdev::base64_decode(unpadded) == v[0]);
+            CATCH_REQUIRE(snapdev::base64_encoded_size(strlen(v[0]), false) == unpadded.length());
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("base64_random", "[base64][string]")
+{
+    CATCH_START_SECTION("base64: random data of all sizes")
+    {
+        for(std::size_t size(0); size < 200; ++size)
+        {
+            std::string const bin(SNAP_CATCH2_NAMESPACE::random_bytes(size));
+            std::string const expected(slow_base64(bin, false));
+            std::string const expected_url(slow_base64(bin, true));
+
+            CATCH_REQUIRE(snapdev::base64_encode(bin) == expected);
+            CATCH_REQUIRE(snapdev::base64url_encode(bin) == expected_url);
+            CATCH_REQUIRE(snapdev::base64_decode(expected) == bin);
+            CATCH_REQUIRE(snapdev::base64url_decode(expected_url) == bin);
+
+            std::vector<std::uint8_t> const vec(bin.begin(), bin.end());
+            CATCH_REQUIRE(snapdev::base64_encode(vec) == expected);
+            CATCH_REQUIRE(snapdev::base64url_encode(vec) == expected_url);
+
+            char buf[300];
+            CATCH_REQUIRE(snapdev::base64_encode(vec, buf) == buf + expected.length());
+            CATCH_REQUIRE(std::string(buf, expected.length()) == expected);
+
+            std::uint8_t out[200];
+            CATCH_REQUIRE(snapdev::base64_decode(expected, out) == out + size);
+            CATCH_REQUIRE(std::vector<std::uint8_t>(out, out + size) == vec);
+            CATCH_REQUIRE(snapdev::base64url_decode(expected_url, out) == out + size);
+            CATCH_REQUIRE(std::vector<std::uint8_t>(out, out + size) == vec);
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("base64_chunks", "[base64][string]")
+{
+    CATCH_START_SECTION("base64: encode and decode in chunks")
+    {
+        for(int count(0); count < 100; ++count)
+        {
+            bool const url((count & 1) != 0);
+            std::string const bin(SNAP_CATCH2_NAMESPACE::random_bytes(rand() % 1000));
+            std::string const expected(slow_base64(bin, url));
+
+            snapdev::base64_encoder encoder(url);
+            std::string encoded;
+            std::size_t pos(0);
+            while(pos < bin.length())
+            {
+                std::size_t const size(std::min<std::size_t>(rand() % 50, bin.length() - pos));
+                encoder.encode(std::span<std::uint8_t const>(
+                              reinterpret_cast<std::uint8_t const *>(bin.data()) + pos
+                            , size)
+                        , encoded);
+                pos += size;
+            }
+            encoder.finish(encoded);
+            CATCH_REQUIRE(encoded == expected);
+
+            snapdev::base64_decoder decoder(url);
+            std::string decoded;
+            pos = 0;
+            while(pos < encoded.length())
+            {
+                std::size_t const size(std::min<std::size_t>(rand() % 50, encoded.length() - pos));
+                decoder.decode(std::string_view(encoded).substr(pos, size), decoded);
+                pos += size;
+            }
+            decoder.finish(decoded);
+            CATCH_REQUIRE(decoded == bin);
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("base64_invalid_input", "[base64][string][error]")
+{
+    CATCH_START_SECTION("base64: invalid length")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::base64_decode("Zm9vY")
+                , snapdev::base64_invalid_parameter
+                , Catch::Matchers::ExceptionMessage(
+                          "base64_exception: the base64 parameter does not have a valid length."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::base64_decode("=")
+                , snapdev::base64_invalid_parameter
+                , Catch::Matchers::ExceptionMessage(
+                          "base64_exception: the base64 parameter does not have a valid length."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("base64: invalid characters at any position")
+    {
+        std::string const valid(slow_base64(SNAP_CATCH2_NAMESPACE::random_bytes(60), false));
+        for(std::size_t pos(0); pos < valid.length(); ++pos)
+        {
+            for(char const c : { '-', '_', '=', ' ', '\n', '*' })
+            {
+                std::string b64(valid);
+                b64[pos] = c;
+                if(c == '=' && pos >= valid.length() - 2)
+                {
+                    continue;
+                }
+                CATCH_REQUIRE_THROWS_MATCHES(
+                          snapdev::base64_decode(b64)
+                        , snapdev::base64_invalid_parameter
+                        , Catch::Matchers::ExceptionMessage(
+                                  c == '\n'
+                                    ? std::string("base64_exception: input character is not a base64 digit.")
+                                    : std::string("base64_exception: input character '") + c + "' is not a base64 digit."));
+            }
+
+            std::string url(slow_base64(SNAP_CATCH2_NAMESPACE::random_bytes(60), true));
+            url[pos] = '+';
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      snapdev::base64url_decode(url)
+                    , snapdev::base64_invalid_parameter
+                    , Catch::Matchers::ExceptionMessage(
+                              "base64_exception: input character '+' is not a base64 digit."));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("base64: unused bits of the last digit must be zero")
+    {
+        CATCH_REQUIRE(snapdev::base64_decode("QQ==") == "A");
+        CATCH_REQUIRE(snapdev::base64_decode("QUI=") == "AB");
+        for(char const * b64 : { "QR==", "QR", "QX==", "QUJ=", "QUJ", "Zm9vQR==" })
+        {
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      snapdev::base64_decode(b64)
+                    , snapdev::base64_invalid_parameter
+                    , Catch::Matchers::ExceptionMessage(
+                              "base64_exception: the last base64 digit has unused bits which are not zero."));
+        }
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::base64url_decode("QUJ")
+                , snapdev::base64_invalid_parameter
+                , Catch::Matchers::ExceptionMessage(
+                          "base64_exception: the last base64 digit has unused bits which are not zero."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("base64: padding in the middle of a chunked input")
+    {
+        snapdev::base64_decoder decoder;
+        std::string out;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  decoder.decode("Zg==Zm9v", out)
+                , snapdev::base64_invalid_parameter
+                , Catch::Matchers::ExceptionMessage(
+                          "base64_exception: found base64 padding before the end of the input."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
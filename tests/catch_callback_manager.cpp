@@ -36,8 +36,14 @@
 
 // C++ include
 //
+#include    <chrono>
+#include    <condition_variable>
+#include    <future>
+#include    <iomanip>
 #include    <list>
+#include    <mutex>
 #include    <set>
+#include    <thread>
 
 
 // last include
@@ -70,6 +76,34 @@ bool void_static_callback()
 }
 
 
+/** \brief Run \p call from \p thread_count threads at once.
+ *
+ * \return The number of calls per second.
+ */
+template<typename F>
+double dispatch_rate(int thread_count, int calls_per_thread, F call)
+{
+    std::vector<std::thread> threads;
+    auto const start(std::chrono::steady_clock::now());
+    for(int t(0); t < thread_count; ++t)
+    {
+        threads.emplace_back([calls_per_thread, &call]()
+            {
+                for(int i(0); i < calls_per_thread; ++i)
+                {
+                    call();
+                }
+            });
+    }
+    for(auto & t : threads)
+    {
+        t.join();
+    }
+    std::chrono::duration<double> const duration(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(thread_count) * calls_per_thread / duration.count();
+}
+
+
 
 
 }
@@ -282,6 +316,570 @@ CATCH_TEST_CASE("callback_manager", "[callback]")
         CATCH_REQUIRE(m.empty());
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("callback manager: add and remove callbacks while calling")
+    {
+        typedef std::function<bool()> callback_t;
+
+        snapdev::callback_manager<callback_t> m;
+        std::vector<int> order;
+        std::vector<bool> removed;
+        snapdev::callback_manager<callback_t>::callback_id_t third_id(snapdev::callback_manager<callback_t>::NULL_CALLBACK_ID);
+
+        m.add_callback([&order]()
+            {
+                order.push_back(1);
+                return true;
+            });
+        m.add_callback([&]()
+            {
+                order.push_back(2);
+
+                // changes are only visible on the next call()
+                //
+                removed.push_back(m.remove_callback(third_id));
+                m.add_callback([&order]()
+                    {
+                        order.push_back(4);
+                        return true;
+                    }, 10);
+                return true;
+            });
+        third_id = m.add_callback([&order]()
+            {
+                order.push_back(3);
+                return true;
+            });
+
+        CATCH_REQUIRE(m.call());
+        CATCH_REQUIRE(order == std::vector<int>({ 1, 2, 3 }));
+        CATCH_REQUIRE(m.size() == 3);
+
+        // the second callback removes nothing now and adds another 4
+        //
+        order.clear();
+        CATCH_REQUIRE(m.call());
+        CATCH_REQUIRE(order == std::vector<int>({ 4, 1, 2 }));
+        CATCH_REQUIRE(m.size() == 4);
+
+        order.clear();
+        CATCH_REQUIRE(m.call());
+        CATCH_REQUIRE(order == std::vector<int>({ 4, 4, 1, 2 }));
+        CATCH_REQUIRE(removed == std::vector<bool>({ true, false, false }));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("concurrent_callback_manager", "[callback][thread]")
+{
+    CATCH_START_SECTION("concurrent callback manager: call while adding and removing")
+    {
+        typedef std::function<bool(int)> callback_t;
+
+        snapdev::concurrent_callback_manager<callback_t> m;
+        std::atomic<int> total(0);
+
+        // two permanent callbacks
+        //
+        for(int i(0); i < 2; ++i)
+        {
+            m.add_callback([&total](int v)
+                {
+                    total += v;
+                    return true;
+                });
+        }
+
+        std::atomic<bool> done(false);
+        std::atomic<bool> all_removed(true);
+        std::thread writer([&]()
+            {
+                while(!done)
+                {
+                    auto const id(m.add_callback([](int)
+                        {
+                            return true;
+                        }, rand() % 3 - 1));
+                    std::this_thread::yield();
+                    if(!m.remove_callback(id))
+                    {
+                        all_removed = false;
+                    }
+                }
+            });
+
+        std::vector<std::thread> readers;
+        for(int t(0); t < 4; ++t)
+        {
+            readers.emplace_back([&m]()
+                {
+                    for(int i(0); i < 10'000; ++i)
+                    {
+                        m.call(1);
+                    }
+                });
+        }
+        for(auto & t : readers)
+        {
+            t.join();
+        }
+        done = true;
+        writer.join();
+
+        CATCH_REQUIRE(all_removed);
+        CATCH_REQUIRE(total == 2 * 4 * 10'000);
+        CATCH_REQUIRE(m.size() == 2);
+        CATCH_REQUIRE(m.clear());
+        CATCH_REQUIRE(m.empty());
+        CATCH_REQUIRE(m.call(1));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concurrent callback manager: removed callbacks get destroyed")
+    {
+        struct listener
+        {
+            bool event()
+            {
+                return true;
+            }
+        };
+        typedef std::shared_ptr<listener> listener_pointer_t;
+
+        listener_pointer_t obj(std::make_shared<listener>());
+        std::weak_ptr<listener> weak(obj);
+        {
+            snapdev::concurrent_callback_manager<listener_pointer_t> m;
+            auto const id(m.add_callback(obj));
+            obj.reset();
+            CATCH_REQUIRE(m.call(&listener::event));
+            CATCH_REQUIRE_FALSE(weak.expired());
+            CATCH_REQUIRE(m.remove_callback(id));
+            CATCH_REQUIRE(weak.expired());
+        }
+
+        // the manager destructor releases the callbacks
+        //
+        obj = std::make_shared<listener>();
+        weak = obj;
+        {
+            snapdev::concurrent_callback_manager<listener_pointer_t> m;
+            m.add_callback(obj);
+            obj.reset();
+            CATCH_REQUIRE(m.call(&listener::event));
+        }
+        CATCH_REQUIRE(weak.expired());
+
+        // a callback removed while another thread runs a call() gets
+        // destroyed when that call() returns
+        //
+        typedef std::function<bool()> callback_t;
+        snapdev::concurrent_callback_manager<callback_t> m;
+        std::shared_ptr<int> value(std::make_shared<int>(5));
+        std::weak_ptr<int> weak_value(value);
+        auto const id(m.add_callback([value]()
+            {
+                return *value == 5;
+            }));
+        value.reset();
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool entered(false);
+        bool release(false);
+        snapdev::concurrent_callback_manager<callback_t> blocker;
+        blocker.add_callback([&]()
+            {
+                std::unique_lock lock(mutex);
+                entered = true;
+                cond.notify_all();
+                cond.wait(lock, [&release]() { return release; });
+                return true;
+            });
+        std::thread reader([&blocker]()
+            {
+                blocker.call();
+            });
+        {
+            std::unique_lock lock(mutex);
+            cond.wait(lock, [&entered]() { return entered; });
+        }
+        CATCH_REQUIRE(m.call());
+        CATCH_REQUIRE(m.remove_callback(id));
+        CATCH_REQUIRE_FALSE(weak_value.expired());
+        {
+            std::lock_guard lock(mutex);
+            release = true;
+        }
+        cond.notify_all();
+        reader.join();
+        CATCH_REQUIRE(weak_value.expired());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concurrent callback manager: nested calls replacing the vectors")
+    {
+        typedef std::function<bool()> callback_t;
+
+        std::vector<std::unique_ptr<snapdev::concurrent_callback_manager<callback_t>>> managers;
+        for(int i(0); i < 40; ++i)
+        {
+            managers.push_back(std::make_unique<snapdev::concurrent_callback_manager<callback_t>>());
+        }
+
+        // each callback removes itself and calls the next manager so the
+        // vector being walked gets replaced while nested calls run
+        //
+        std::vector<int> order;
+        for(std::size_t i(0); i < managers.size(); ++i)
+        {
+            auto id(std::make_shared<snapdev::concurrent_callback_manager<callback_t>::callback_id_t>());
+            *id = managers[i]->add_callback([&managers, &order, i, id]()
+                {
+                    order.push_back(static_cast<int>(i));
+                    CATCH_REQUIRE(managers[i]->remove_callback(*id));
+                    managers[i]->add_callback([]()
+                        {
+                            return true;
+                        });
+                    if(i + 1 < managers.size())
+                    {
+                        managers[i + 1]->call();
+                    }
+                    return true;
+                });
+        }
+
+        CATCH_REQUIRE(managers[0]->call());
+        CATCH_REQUIRE(order.size() == managers.size());
+        for(std::size_t i(0); i < managers.size(); ++i)
+        {
+            CATCH_REQUIRE(order[i] == static_cast<int>(i));
+            CATCH_REQUIRE(managers[i]->size() == 1);
+        }
+
+        // the next calls see the new vectors
+        //
+        order.clear();
+        for(auto & m : managers)
+        {
+            CATCH_REQUIRE(m->call());
+        }
+        CATCH_REQUIRE(order.empty());
+
+        // a new manager allocated where a deleted one was starts empty
+        //
+        managers.clear();
+        snapdev::concurrent_callback_manager<callback_t> m;
+        CATCH_REQUIRE(m.call());
+        m.add_callback([&order]()
+            {
+                order.push_back(-1);
+                return true;
+            });
+        CATCH_REQUIRE(m.call());
+        CATCH_REQUIRE(order == std::vector<int>({ -1 }));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("concurrent_callback_manager_benchmark", "[.][callback][thread][benchmark]")
+{
+    CATCH_START_SECTION("concurrent callback manager benchmark: lock free call() against a mutex")
+    {
+        typedef std::function<bool()> callback_t;
+
+        // the callback does not touch shared memory so only the
+        // dispatching itself is measured
+        //
+        auto const callback([]()
+            {
+                return true;
+            });
+
+        snapdev::concurrent_callback_manager<callback_t> concurrent;
+        snapdev::callback_manager<callback_t> locked;
+        std::mutex mutex;
+        for(int i(0); i < 8; ++i)
+        {
+            concurrent.add_callback(callback);
+            locked.add_callback(callback);
+        }
+
+        unsigned int const max_threads(std::max(2U, std::min(16U, std::thread::hardware_concurrency())));
+        for(unsigned int thread_count(1); thread_count <= max_threads; thread_count *= 2)
+        {
+            double const lock_free(dispatch_rate(thread_count, 20'000, [&concurrent]()
+                {
+                    concurrent.call();
+                }));
+            double const with_mutex(dispatch_rate(thread_count, 20'000, [&locked, &mutex]()
+                {
+                    std::lock_guard lock(mutex);
+                    locked.call();
+                }));
+            std::cout << "--- " << std::setw(2) << thread_count << " threads: "
+                      << std::fixed << std::setprecision(0)
+                      << lock_free << " calls/s concurrent, "
+                      << with_mutex << " calls/s with a mutex\n";
+        }
+        CATCH_REQUIRE(concurrent.size() == 8);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("callback_manager_async", "[callback][thread]")
+{
+    CATCH_START_SECTION("callback manager async: run callbacks on the dispatcher")
+    {
+        typedef std::function<bool(std::string const &)> callback_t;
+
+        snapdev::callback_manager<callback_t> m;
+        std::vector<std::string> order;
+        std::thread::id worker;
+        m.add_callback([&order, &worker](std::string const & name)
+            {
+                worker = std::this_thread::get_id();
+                order.push_back("low:" + name);
+                return true;
+            }, -5);
+        m.add_callback([&order](std::string const & name)
+            {
+                order.push_back("high:" + name);
+                return name != "stop";
+            }, 5);
+
+        std::shared_future<bool> const result(m.call_async(std::string("event")));
+        CATCH_REQUIRE(result.get());
+        CATCH_REQUIRE(worker != std::this_thread::get_id());
+        CATCH_REQUIRE(order == std::vector<std::string>({ "high:event", "low:event" }));
+
+        order.clear();
+        CATCH_REQUIRE_FALSE(m.call_async("stop").get());
+        CATCH_REQUIRE(order == std::vector<std::string>({ "high:stop" }));
+
+        snapdev::callback_manager<callback_t> empty;
+        CATCH_REQUIRE(empty.call_async("nothing").get());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("callback manager async: coalesce identical events")
+    {
+        typedef std::function<bool(int)> callback_t;
+
+        snapdev::callback_dispatcher::pointer_t dispatcher(std::make_shared<snapdev::callback_dispatcher>());
+        CATCH_REQUIRE(dispatcher->thread_count() == 1);
+
+        // block the worker thread until all the events are posted
+        //
+        std::promise<void> gate;
+        std::shared_future<void> const open(gate.get_future().share());
+        dispatcher->post([open]()
+            {
+                open.wait();
+            });
+
+        snapdev::callback_manager<callback_t> m;
+        m.set_dispatcher(dispatcher);
+        std::vector<int> received;
+        m.add_callback([&received](int value)
+            {
+                received.push_back(value);
+                return value >= 0;
+            });
+
+        std::vector<std::shared_future<bool>> results;
+        for(int i(0); i < 5; ++i)
+        {
+            results.push_back(m.call_async_coalesced(1));
+            results.push_back(m.call_async_coalesced(2));
+        }
+        results.push_back(m.call_async_coalesced(-3));
+        results.push_back(m.call_async(1));
+        gate.set_value();
+
+        for(std::size_t idx(0); idx < results.size() - 2; ++idx)
+        {
+            CATCH_REQUIRE(results[idx].get());
+        }
+        CATCH_REQUIRE_FALSE(results[results.size() - 2].get());
+        CATCH_REQUIRE(results.back().get());
+        CATCH_REQUIRE(received == std::vector<int>({ 1, 2, -3, 1 }));
+
+        // once started, an event is not merged anymore
+        //
+        CATCH_REQUIRE(m.call_async_coalesced(1).get());
+        CATCH_REQUIRE(received == std::vector<int>({ 1, 2, -3, 1, 1 }));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("callback manager async: member functions, exceptions, and lifetime")
+    {
+        struct listener
+        {
+            bool on_value(int value)
+            {
+                if(value < 0)
+                {
+                    throw std::out_of_range("negative value");
+                }
+                f_total += value;
+                return true;
+            }
+
+            std::atomic<int> f_total = 0;
+        };
+
+        std::shared_ptr<listener> l(std::make_shared<listener>());
+        snapdev::callback_dispatcher::pointer_t dispatcher(std::make_shared<snapdev::callback_dispatcher>(3));
+        std::vector<std::shared_future<bool>> results;
+        {
+            snapdev::concurrent_callback_manager<std::shared_ptr<listener>> m;
+            m.set_dispatcher(dispatcher);
+            m.add_callback(l);
+            m.add_callback(l);
+            for(int i(1); i <= 100; ++i)
+            {
+                results.push_back(m.call_async(&listener::on_value, i));
+            }
+            results.push_back(m.call_async(&listener::on_value, -1));
+
+            // the manager goes away before the invocations are done
+        }
+        for(std::size_t idx(0); idx < results.size() - 1; ++idx)
+        {
+            CATCH_REQUIRE(results[idx].get());
+        }
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  results.back().get()
+                , std::out_of_range
+                , Catch::Matchers::ExceptionMessage("negative value"));
+        CATCH_REQUIRE(l->f_total == 2 * 5050);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("callback manager async: a callback destroys its manager")
+    {
+        typedef std::function<bool()> callback_t;
+        typedef snapdev::callback_manager<callback_t> manager_t;
+
+        // the manager holds the only reference to its dispatcher so the
+        // dispatcher gets destroyed from its own worker thread
+        //
+        std::shared_ptr<manager_t> m(std::make_shared<manager_t>());
+        int count(0);
+        m->add_callback([&m, &count]()
+            {
+                ++count;
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                m.reset();
+                return true;
+            });
+        m->add_callback([&count]()
+            {
+                ++count;
+                return true;
+            });
+        std::shared_future<bool> result(m->call_async());
+        CATCH_REQUIRE(result.get());
+        CATCH_REQUIRE(count == 2);
+        CATCH_REQUIRE(m == nullptr);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("callback_manager_profiling", "[callback]")
+{
+    CATCH_START_SECTION("callback manager profiling: statistics per callback")
+    {
+        typedef std::function<bool(int)> callback_t;
+        typedef snapdev::callback_manager<callback_t> manager_t;
+
+        manager_t m;
+        manager_t::callback_id_t const slow(m.add_callback([](int value)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(value == 0 ? 5 : 1));
+                return true;
+            }));
+        manager_t::callback_id_t const stop(m.add_callback([](int value)
+            {
+                return value % 2 == 0;
+            }));
+        manager_t::callback_id_t const last(m.add_callback([](int)
+            {
+                return true;
+            }));
+
+        // off by default, nothing gets recorded
+        //
+        CATCH_REQUIRE_FALSE(m.is_profiling());
+        CATCH_REQUIRE(m.call(1) == false);
+        CATCH_REQUIRE(m.get_statistics(slow).f_id == slow);
+        CATCH_REQUIRE(m.get_statistics(slow).f_calls == 0);
+
+        m.set_profiling(true);
+        CATCH_REQUIRE(m.is_profiling());
+        for(int i(0); i < 10; ++i)
+        {
+            CATCH_REQUIRE(m.call(i) == (i % 2 == 0));
+        }
+        CATCH_REQUIRE(m.call_async(2).get());
+
+        // the statistics survive changes to the list of callbacks
+        //
+        manager_t::callback_id_t const added(m.add_callback([](int)
+            {
+                return true;
+            }, 100));
+        CATCH_REQUIRE(m.remove_callback(added));
+
+        manager_t::statistics_t const s(m.get_statistics(slow));
+        CATCH_REQUIRE(s.f_calls == 11);
+        CATCH_REQUIRE(s.f_stopped == 0);
+        CATCH_REQUIRE(s.f_max_duration >= snapdev::timespec_ex(0, 5'000'000));
+        CATCH_REQUIRE(s.f_total_duration >= snapdev::timespec_ex(0, 15'000'000));
+        CATCH_REQUIRE(s.f_total_duration >= s.f_max_duration);
+
+        CATCH_REQUIRE(m.get_statistics(stop).f_calls == 11);
+        CATCH_REQUIRE(m.get_statistics(stop).f_stopped == 5);
+        CATCH_REQUIRE(m.get_statistics(last).f_calls == 6);
+        CATCH_REQUIRE(m.get_statistics(last).f_stopped == 0);
+        CATCH_REQUIRE(m.get_statistics(last).f_max_duration < s.f_max_duration);
+
+        // a callback added while profiling gets its own counters
+        //
+        manager_t::callback_id_t const late(m.add_callback([](int)
+            {
+                return true;
+            }, 100));
+        CATCH_REQUIRE(m.get_statistics(late).f_calls == 0);
+        CATCH_REQUIRE(m.call(4));
+        CATCH_REQUIRE(m.get_statistics(late).f_calls == 1);
+        CATCH_REQUIRE(m.get_statistics(slow).f_calls == 12);
+        CATCH_REQUIRE(m.remove_callback(late));
+        CATCH_REQUIRE(m.get_statistics(late).f_id == manager_t::NULL_CALLBACK_ID);
+
+        std::vector<manager_t::statistics_t> const all(m.get_statistics());
+        CATCH_REQUIRE(all.size() == 3);
+        CATCH_REQUIRE(all[0].f_id == slow);
+        CATCH_REQUIRE(all[1].f_id == stop);
+        CATCH_REQUIRE(all[2].f_id == last);
+
+        CATCH_REQUIRE(m.get_statistics(added).f_id == manager_t::NULL_CALLBACK_ID);
+
+        m.set_profiling(false);
+        CATCH_REQUIRE(m.call(0));
+        CATCH_REQUIRE(m.get_statistics(slow).f_calls == 12);
+
+        m.reset_statistics();
+        CATCH_REQUIRE(m.get_statistics(slow).f_calls == 0);
+        CATCH_REQUIRE(m.get_statistics(slow).f_total_duration == snapdev::timespec_ex());
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -0,0 +1,183 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the case_insensitive_string and its functors.
+ *
+ * This file implements tests to verify that the case insensitive compare
+ * gives the same results with and without the ASCII fast path and that
+ * the hash and equal functors can be used with unordered containers.
+ */
+
+// self
+//
+#include    <snapdev/case_insensitive_string.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <unordered_map>
+#include    <unordered_set>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+int slow_compare(std::string const & s1, std::string const & s2)
+{
+    std::size_t const n(std::min(s1.length(), s2.length()));
+    for(std::size_t idx(0); idx < n; ++idx)
+    {
+        int const c1(toupper(s1[idx]));
+        int const c2(toupper(s2[idx]));
+        if(c1 < c2)
+        {
+            return -1;
+        }
+        if(c1 > c2)
+        {
+            return 1;
+        }
+    }
+    return s1.length() < s2.length() ? -1 : (s1.length() > s2.length() ? 1 : 0);
+}
+
+
+int sign(int r)
+{
+    return r < 0 ? -1 : (r > 0 ? 1 : 0);
+}
+
+
+char random_char(bool ascii)
+{
+    char const set[] = "aAbBzZ_@[`{09 ";
+    if(ascii || (rand() & 7) != 0)
+    {
+        return set[rand() % (sizeof(set) - 1)];
+    }
+    return static_cast<char>(rand() | 0x80);
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("case_insensitive_string", "[string]")
+{
+    CATCH_START_SECTION("case_insensitive_string: compare with fast path")
+    {
+        for(int count(0); count < 10000; ++count)
+        {
+            bool const ascii((count & 1) == 0);
+            std::size_t const size(rand() % 50);
+            std::string s1;
+            for(std::size_t idx(0); idx < size; ++idx)
+            {
+                s1 += random_char(ascii);
+            }
+            std::string s2(s1);
+            if(!s2.empty() && (count & 2) != 0)
+            {
+                s2[rand() % s2.length()] = random_char(ascii);
+            }
+            if((count & 4) != 0)
+            {
+                s2 += random_char(ascii);
+            }
+            snapdev::case_insensitive_string const c1(snapdev::to_case_insensitive_string(s1));
+            snapdev::case_insensitive_string const c2(snapdev::to_case_insensitive_string(s2));
+            CATCH_REQUIRE(sign(c1.compare(c2)) == slow_compare(s1, s2));
+            CATCH_REQUIRE(sign(c2.compare(c1)) == slow_compare(s2, s1));
+            CATCH_REQUIRE((c1 == c2) == (slow_compare(s1, s2) == 0));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("case_insensitive_string: long strings")
+    {
+        snapdev::case_insensitive_string const a("Content-Type: Application/JSON; Charset=UTF-8");
+        snapdev::case_insensitive_string const b("content-type: application/json; charset=utf-8");
+        snapdev::case_insensitive_string const c("content-type: application/json; charset=utf-9");
+        CATCH_REQUIRE(a == b);
+        CATCH_REQUIRE(a < c);
+        CATCH_REQUIRE(c > b);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("case_insensitive_hash", "[string]")
+{
+    CATCH_START_SECTION("case_insensitive_hash: equal strings have equal hashes")
+    {
+        snapdev::case_insensitive_hash const h;
+        CATCH_REQUIRE(h(std::string("Host")) == h(std::string_view("HOST")));
+        CATCH_REQUIRE(h(std::string("X-Forwarded-For")) == h(std::string("x-forwarded-for")));
+        CATCH_REQUIRE(h(snapdev::case_insensitive_string("X-Forwarded-For")) == h(std::string("x-FORWARDED-for")));
+        CATCH_REQUIRE(h(std::string("abc")) != h(std::string("abd")));
+        CATCH_REQUIRE(h(std::string("")) != h(std::string("a")));
+
+        CATCH_REQUIRE(std::hash<snapdev::case_insensitive_string>()("Accept-Encoding")
+                        == h(std::string("ACCEPT-ENCODING")));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("case_insensitive_hash: unordered_map with std::string keys")
+    {
+        std::unordered_map<
+                  std::string
+                , int
+                , snapdev::case_insensitive_hash
+                , snapdev::case_insensitive_equal> headers;
+        headers["Content-Length"] = 1;
+        headers["Content-Type"] = 2;
+        headers["content-length"] = 3;
+        CATCH_REQUIRE(headers.size() == 2);
+        CATCH_REQUIRE(headers.find(std::string_view("CONTENT-LENGTH"))->second == 3);
+        CATCH_REQUIRE(headers.find(std::string_view("content-type"))->second == 2);
+        CATCH_REQUIRE(headers.find(std::string_view("content-types")) == headers.end());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("case_insensitive_hash: unordered_set of case_insensitive_string")
+    {
+        std::unordered_set<snapdev::case_insensitive_string> keywords;
+        keywords.insert("SELECT");
+        keywords.insert("select");
+        keywords.insert("From");
+        CATCH_REQUIRE(keywords.size() == 2);
+        CATCH_REQUIRE(keywords.count("from") == 1);
+        CATCH_REQUIRE(keywords.count("where") == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,163 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the concat_to_string() and append_to() templates.
+ *
+ * This file implements tests for the runtime concatenation of strings,
+ * numbers, and timestamps.
+ */
+
+// self
+//
+#include    <snapdev/concat_to_string.h>
+
+#include    <snapdev/ostream_int128.h>
+#include    <snapdev/timespec_ex.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <limits>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("concat_to_string", "[string]")
+{
+    CATCH_START_SECTION("concat_to_string: strings of all kinds")
+    {
+        std::string const a("std::string");
+        std::string_view const b("string_view");
+        char const * c("char const *");
+        char d[] = "char []";
+
+        std::string const r(snapdev::concat_to_string(a, ' ', b, ' ', c, ' ', d, " literal"));
+        CATCH_REQUIRE(r == "std::string string_view char const * char [] literal");
+        CATCH_REQUIRE(r.capacity() >= r.length());
+
+        CATCH_REQUIRE(snapdev::concat_to_string().empty());
+        CATCH_REQUIRE(snapdev::concat_to_string(std::string()) == "");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concat_to_string: integers")
+    {
+        CATCH_REQUIRE(snapdev::concat_to_string("port: ", 4040) == "port: 4040");
+        CATCH_REQUIRE(snapdev::concat_to_string(0) == "0");
+        CATCH_REQUIRE(snapdev::concat_to_string(-1) == "-1");
+        CATCH_REQUIRE(snapdev::concat_to_string(true, '/', false) == "true/false");
+        CATCH_REQUIRE(snapdev::concat_to_string(static_cast<unsigned char>(200)) == "200");
+        CATCH_REQUIRE(snapdev::concat_to_string(std::numeric_limits<std::int64_t>::min())
+                                == std::to_string(std::numeric_limits<std::int64_t>::min()));
+        CATCH_REQUIRE(snapdev::concat_to_string(std::numeric_limits<std::uint64_t>::max())
+                                == std::to_string(std::numeric_limits<std::uint64_t>::max()));
+
+        for(int idx(0); idx < 1000; ++idx)
+        {
+            std::int64_t const v(SNAP_CATCH2_NAMESPACE::rand_int64());
+            CATCH_REQUIRE(snapdev::concat_to_string('[', v, ']') == "[" + std::to_string(v) + "]");
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concat_to_string: 128 bit integers")
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+        __int128 const zero(0);
+        CATCH_REQUIRE(snapdev::concat_to_string(zero) == "0");
+
+        __int128 const smallest(static_cast<unsigned __int128>(1) << 127);
+        CATCH_REQUIRE(snapdev::concat_to_string(smallest) == "-170141183460469231731687303715884105728");
+
+        unsigned __int128 const largest(~static_cast<unsigned __int128>(0));
+        CATCH_REQUIRE(snapdev::concat_to_string(largest) == "340282366920938463463374607431768211455");
+
+        for(int idx(0); idx < 1000; ++idx)
+        {
+            __int128 const v((static_cast<__int128>(SNAP_CATCH2_NAMESPACE::rand_int64()) << 64)
+                             ^ static_cast<std::uint64_t>(SNAP_CATCH2_NAMESPACE::rand_int64()));
+            CATCH_REQUIRE(snapdev::concat_to_string(v) == snapdev::to_string(v));
+        }
+#pragma GCC diagnostic pop
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concat_to_string: floating points")
+    {
+        CATCH_REQUIRE(snapdev::concat_to_string(1.5) == "1.5");
+        CATCH_REQUIRE(snapdev::concat_to_string(-0.25f) == "-0.25");
+        CATCH_REQUIRE(snapdev::concat_to_string(0.1) == "0.1");
+        CATCH_REQUIRE(snapdev::concat_to_string(1e300) == "1e+300");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("concat_to_string: timespec")
+    {
+        timespec const t{ 1234, 5678 };
+        CATCH_REQUIRE(snapdev::concat_to_string("t=", t) == "t=1234.000005678");
+
+        snapdev::timespec_ex const u(1'700'000'000, 999'999'999);
+        CATCH_REQUIRE(snapdev::concat_to_string(u) == u.to_timestamp());
+
+        snapdev::timespec_ex const z;
+        CATCH_REQUIRE(snapdev::concat_to_string(z) == z.to_timestamp());
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("append_to", "[string]")
+{
+    CATCH_START_SECTION("append_to: append to an existing string")
+    {
+        std::string s("error: ");
+        std::string & r(snapdev::append_to(s, "code ", 404, ", path \"", std::string("/index.html"), "\"."));
+        CATCH_REQUIRE(&r == &s);
+        CATCH_REQUIRE(s == "error: code 404, path \"/index.html\".");
+
+        snapdev::append_to(s);
+        CATCH_REQUIRE(s == "error: code 404, path \"/index.html\".");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("append_to: only one allocation")
+    {
+        std::string s;
+        snapdev::append_to(
+                  s
+                , "a rather long string so the small string optimization does not apply"
+                , 123456789
+                , std::string(100, '*')
+                , 3.14159);
+        std::string::size_type const capacity(s.capacity());
+        CATCH_REQUIRE(capacity == s.length());
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,229 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the table driven escaper.
+ *
+ * This file implements tests to verify the escaper actions and the
+ * JSON, CSV, shell, and regex presets.
+ */
+
+// self
+//
+#include    <snapdev/escaper.h>
+
+#include    <snapdev/escape_special_regex_characters.h>
+
+#include    "catch_main.h"
+
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+// the straightforward one character at a time version
+//
+std::string slow_escape(snapdev::escaper const & e, std::string const & s)
+{
+    std::string result;
+    for(char const c : s)
+    {
+        result += e.get_sequence(c);
+    }
+    return result;
+}
+
+
+std::string random_string(std::size_t size, char const * alphabet)
+{
+    std::size_t const max(strlen(alphabet));
+    std::string result;
+    for(std::size_t idx(0); idx < size; ++idx)
+    {
+        result += alphabet[rand() % max];
+    }
+    return result;
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("escaper", "[string]")
+{
+    CATCH_START_SECTION("escaper: default copies everything")
+    {
+        snapdev::escaper const e;
+        std::string all;
+        for(int c(0); c < 256; ++c)
+        {
+            all += static_cast<char>(c);
+            CATCH_REQUIRE(e.get_action(static_cast<char>(c)) == snapdev::escape_action_t::ESCAPE_ACTION_PASS);
+        }
+        CATCH_REQUIRE(e.escaped_size(all) == 256);
+        CATCH_REQUIRE(e.escape(all) == all);
+        CATCH_REQUIRE(e.escape(std::string()).empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper: prefix, replace, and pass actions")
+    {
+        snapdev::escaper e('%');
+        e.prefix("ab");
+        e.replace('c', "<C>");
+        e.replace('d', "");
+        CATCH_REQUIRE(e.get_action('a') == snapdev::escape_action_t::ESCAPE_ACTION_PREFIX);
+        CATCH_REQUIRE(e.get_action('c') == snapdev::escape_action_t::ESCAPE_ACTION_REPLACE);
+        CATCH_REQUIRE(e.get_sequence('b') == "%b");
+        CATCH_REQUIRE(e.get_sequence('c') == "<C>");
+        CATCH_REQUIRE(e.get_sequence('d') == "");
+        CATCH_REQUIRE(e.escape("abcdefabcdef") == "%a%b<C>ef%a%b<C>ef");
+        CATCH_REQUIRE(e.escaped_size("abcdefabcdef") == 18);
+
+        e.pass("ac");
+        CATCH_REQUIRE(e.get_action('a') == snapdev::escape_action_t::ESCAPE_ACTION_PASS);
+        CATCH_REQUIRE(e.escape("abcdefabcdef") == "a%bcefa%bcef");
+
+        std::string out("start:");
+        e.escape_append("bd", out);
+        CATCH_REQUIRE(out == "start:%b");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper: caller buffer")
+    {
+        snapdev::escaper e;
+        e.prefix("'");
+        std::string const in("it's Bob's");
+        char buf[32];
+        CATCH_REQUIRE(e.escaped_size(in) == 12);
+        char * end(e.escape(in, buf));
+        CATCH_REQUIRE(end == buf + 12);
+        CATCH_REQUIRE(std::string(buf, end) == "it\\'s Bob\\'s");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper: long sequence")
+    {
+        snapdev::escaper e;
+        e.replace('x', std::string(255, '*'));
+        CATCH_REQUIRE(e.escape("x") == std::string(255, '*'));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  e.replace('y', std::string(256, '*'))
+                , std::length_error
+                , Catch::Matchers::ExceptionMessage("escaper sequences are limited to 255 characters."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper: random strings against the slow version")
+    {
+        // a range at the start, a range at the end, and few characters
+        //
+        snapdev::escaper ranges;
+        for(int c(0); c < 0x20; ++c)
+        {
+            ranges.replace(static_cast<char>(c), "^" + std::string(1, static_cast<char>(c + '@')));
+        }
+        for(int c(0xF0); c < 0x100; ++c)
+        {
+            ranges.prefix(std::string(1, static_cast<char>(c)));
+        }
+        ranges.prefix("\\\"");
+
+        // too many characters to be vectorized
+        //
+        snapdev::escaper many;
+        many.prefix("abcdefghijklmnopqrstuvwxyz");
+
+        std::string all;
+        for(int c(1); c < 256; ++c)
+        {
+            all += static_cast<char>(c);
+        }
+
+        snapdev::escaper const * escapers[] =
+        {
+            &ranges,
+            &many,
+            &snapdev::json_escaper(),
+            &snapdev::csv_escaper(),
+            &snapdev::shell_escaper(),
+            &snapdev::regex_escaper(),
+        };
+        CATCH_REQUIRE_FALSE(many.is_vectorized());
+        for(auto const * e : escapers)
+        {
+            for(int i(0); i < 200; ++i)
+            {
+                // mostly plain text with a few special characters
+                //
+                std::string const s(random_string(
+                          rand() % 100
+                        , (i & 1) != 0 ? "Plain text with words.\n\t\"'$" : all.c_str()));
+                std::string const expected(slow_escape(*e, s));
+                CATCH_REQUIRE(e->escaped_size(s) == expected.length());
+                CATCH_REQUIRE(e->escape(s) == expected);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("escaper_presets", "[string]")
+{
+    CATCH_START_SECTION("escaper_presets: json")
+    {
+        snapdev::escaper const & e(snapdev::json_escaper());
+        CATCH_REQUIRE(e.escape("say \"hi\"\\\n") == "say \\\"hi\\\"\\\\\\n");
+        CATCH_REQUIRE(e.escape(std::string("\0\x1f\b\f\r\t/", 7)) == "\\u0000\\u001F\\b\\f\\r\\t/");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper_presets: csv")
+    {
+        CATCH_REQUIRE(snapdev::csv_escaper().escape("a \"b\", c") == "a \"\"b\"\", c");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper_presets: shell")
+    {
+        CATCH_REQUIRE(snapdev::shell_escaper().escape("my file (1).txt") == "my\\ file\\ \\(1\\).txt");
+        CATCH_REQUIRE(snapdev::shell_escaper().escape("a\nb") == "a'\n'b");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("escaper_presets: regex")
+    {
+        CATCH_REQUIRE(snapdev::regex_escaper().escape("a.b*c") == "a\\.b\\*c");
+        CATCH_REQUIRE(snapdev::regex_escaper().is_vectorized() == snapdev::json_escaper().is_vectorized());
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,266 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify that the file_chunk_reader class works.
+ *
+ * This file implements tests reading files one chunk and one line at
+ * a time, with and without the read-ahead thread, using chunk sizes
+ * which force lines to straddle chunks.
+ */
+
+// self
+//
+#include    <snapdev/file_chunk_reader.h>
+
+#include    <snapdev/file_contents.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+std::string create_file(std::string const & name, std::string const & content)
+{
+    std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/chunks/" + name);
+    snapdev::file_contents out(filename, true);
+    out.contents(content);
+    CATCH_REQUIRE(out.write_all());
+    return filename;
+}
+
+
+std::vector<std::string> split_lines(std::string const & content)
+{
+    std::vector<std::string> result;
+    std::string::size_type start(0);
+    while(start < content.length())
+    {
+        std::string::size_type const pos(content.find('\n', start));
+        if(pos == std::string::npos)
+        {
+            result.push_back(content.substr(start));
+            break;
+        }
+        result.push_back(content.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return result;
+}
+
+
+std::string random_lines(int count)
+{
+    std::string result;
+    for(int i(0); i < count; ++i)
+    {
+        int const length(rand() % 200);
+        for(int j(0); j < length; ++j)
+        {
+            result += static_cast<char>(rand() % 95 + ' ');
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("file_chunk_reader", "[os]")
+{
+    CATCH_START_SECTION("file_chunk_reader: read chunks")
+    {
+        std::string const content(random_lines(1000));
+        std::string const filename(create_file("chunks.txt", content));
+
+        for(int read_ahead(0); read_ahead < 2; ++read_ahead)
+        {
+            for(std::size_t const chunk_size : { 1UL, 7UL, 4096UL, content.length(), content.length() + 1 })
+            {
+                snapdev::file_chunk_reader in(filename, chunk_size, read_ahead != 0);
+                CATCH_REQUIRE(in.filename() == filename);
+                CATCH_REQUIRE(in.chunk_size() == chunk_size);
+
+                std::string result;
+                std::string_view chunk;
+                while(in.next_chunk(chunk))
+                {
+                    CATCH_REQUIRE(chunk.length() <= chunk_size);
+                    result += chunk;
+                    if(chunk.length() < chunk_size)
+                    {
+                        CATCH_REQUIRE(result.length() == content.length());
+                    }
+                }
+                CATCH_REQUIRE(in.last_error().empty());
+                CATCH_REQUIRE(result == content);
+
+                // at the end, we keep getting false
+                //
+                CATCH_REQUIRE_FALSE(in.next_chunk(chunk));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader: read lines")
+    {
+        std::string const content(random_lines(2000));
+        std::vector<std::string> const expected(split_lines(content));
+        std::string const filename(create_file("lines.txt", content));
+
+        for(int read_ahead(0); read_ahead < 2; ++read_ahead)
+        {
+            for(std::size_t const chunk_size : { 1UL, 13UL, 150UL, 4096UL, snapdev::file_chunk_reader::DEFAULT_CHUNK_SIZE })
+            {
+                snapdev::file_chunk_reader in(filename, chunk_size, read_ahead != 0);
+
+                std::vector<std::string> lines;
+                std::string_view line;
+                while(in.next_line(line))
+                {
+                    lines.emplace_back(line);
+                }
+                CATCH_REQUIRE(in.last_error().empty());
+                CATCH_REQUIRE(lines == expected);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader: last line without a newline and empty lines")
+    {
+        std::string const content("first\n\n\nfourth line\nno newline");
+        std::string const filename(create_file("no-newline.txt", content));
+
+        for(int read_ahead(0); read_ahead < 2; ++read_ahead)
+        {
+            for(std::size_t const chunk_size : { 1UL, 3UL, 6UL, 100UL })
+            {
+                snapdev::file_chunk_reader in(filename, chunk_size, read_ahead != 0);
+
+                std::vector<std::string> lines;
+                std::string_view line;
+                while(in.next_line(line))
+                {
+                    lines.emplace_back(line);
+                }
+                CATCH_REQUIRE(lines == std::vector<std::string>({ "first", "", "", "fourth line", "no newline" }));
+                CATCH_REQUIRE_FALSE(in.next_line(line));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader: empty file")
+    {
+        std::string const filename(create_file("empty.txt", std::string()));
+
+        for(int read_ahead(0); read_ahead < 2; ++read_ahead)
+        {
+            snapdev::file_chunk_reader chunks(filename, 16, read_ahead != 0);
+            std::string_view chunk;
+            CATCH_REQUIRE_FALSE(chunks.next_chunk(chunk));
+            CATCH_REQUIRE(chunks.last_error().empty());
+
+            snapdev::file_chunk_reader lines(filename, 16, read_ahead != 0);
+            std::string_view line;
+            CATCH_REQUIRE_FALSE(lines.next_line(line));
+            CATCH_REQUIRE(lines.last_error().empty());
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader: stop reading early with the read-ahead thread")
+    {
+        std::string const content(random_lines(1000));
+        std::string const filename(create_file("early.txt", content));
+
+        snapdev::file_chunk_reader in(filename, 100, true);
+        std::string_view chunk;
+        CATCH_REQUIRE(in.next_chunk(chunk));
+        CATCH_REQUIRE(chunk == std::string_view(content).substr(0, 100));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("file_chunk_reader_errors", "[os]")
+{
+    CATCH_START_SECTION("file_chunk_reader_errors: invalid parameters")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::file_chunk_reader(std::string())
+                , std::invalid_argument
+                , Catch::Matchers::ExceptionMessage(
+                          "snapdev::file_chunk_reader: the filename of a file_chunk_reader object cannot be the empty string."));
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::file_chunk_reader("/etc/passwd", 0)
+                , std::invalid_argument
+                , Catch::Matchers::ExceptionMessage(
+                          "snapdev::file_chunk_reader: the chunk size cannot be zero."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader_errors: missing file")
+    {
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/chunks/missing.txt");
+        snapdev::file_chunk_reader in(filename);
+        std::string_view line;
+        CATCH_REQUIRE_FALSE(in.next_line(line));
+        CATCH_REQUIRE(in.last_error() == "could not open file \"" + filename + "\" for reading.");
+        CATCH_REQUIRE_FALSE(in.next_line(line));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_chunk_reader_errors: reading a directory fails")
+    {
+        create_file("in-directory.txt", "make sure the directory exists\n");
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/chunks");
+
+        for(int read_ahead(0); read_ahead < 2; ++read_ahead)
+        {
+            snapdev::file_chunk_reader in(filename, 1024, read_ahead != 0);
+            std::string_view line;
+            CATCH_REQUIRE_FALSE(in.next_line(line));
+            CATCH_REQUIRE(in.last_error() == "an I/O error occurred reading \"" + filename + "\".");
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -29,12 +29,67 @@
 #include    "catch_main.h"
 
 
+// C++
+//
+#include    <chrono>
+#include    <fstream>
+#include    <iomanip>
+
+
+// C
+//
+#include    <dirent.h>
+#include    <sys/resource.h>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
 
 
 
+namespace
+{
+
+
+std::size_t count_temporary_files(std::string const & directory)
+{
+    std::size_t result(0);
+    DIR * d(opendir(directory.c_str()));
+    CATCH_REQUIRE(d != nullptr);
+    for(struct dirent * e(readdir(d)); e != nullptr; e = readdir(d))
+    {
+        if(strstr(e->d_name, ".tmp-") != nullptr)
+        {
+            ++result;
+        }
+    }
+    closedir(d);
+    return result;
+}
+
+
+template<typename F>
+std::chrono::duration<double> run_duration(int count, F run)
+{
+    // one untimed run so both functions start with a warm cache
+    //
+    std::size_t total(run());
+    auto const start(std::chrono::steady_clock::now());
+    for(int i(0); i < count; ++i)
+    {
+        total += run();
+    }
+    std::chrono::duration<double> const duration(std::chrono::steady_clock::now() - start);
+    CATCH_REQUIRE(total > 0);
+    return duration;
+}
+
+
+} // no name namespace
+
+
+
 
 CATCH_TEST_CASE("file_contents", "[os]")
 {
@@ -152,6 +207,338 @@ CATCH_TEST_CASE("file_contents", "[os]")
         CATCH_REQUIRE(static_cast<snapdev::file_contents const &>(comm).contents() == "unittest\n");
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents: read a large file in both size modes")
+    {
+        std::string const content(SNAP_CATCH2_NAMESPACE::random_bytes(1024 * 1024 + 17));
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/contents/large-file.bin");
+        {
+            snapdev::file_contents out(filename, true);
+            out.contents(content);
+            CATCH_REQUIRE(out.write_all());
+        }
+
+        snapdev::file_contents seek(filename);
+        CATCH_REQUIRE(seek.read_all());
+        CATCH_REQUIRE(seek.contents() == content);
+
+        // reading again replaces the previous contents
+        //
+        CATCH_REQUIRE(seek.read_all());
+        CATCH_REQUIRE(seek.contents() == content);
+
+        snapdev::file_contents read(filename);
+        read.size_mode(snapdev::file_contents::size_mode_t::SIZE_MODE_READ);
+        CATCH_REQUIRE(read.size_mode() == snapdev::file_contents::size_mode_t::SIZE_MODE_READ);
+        CATCH_REQUIRE(read.read_all());
+        CATCH_REQUIRE(read.contents() == content);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents: reading a directory fails")
+    {
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/contents");
+        snapdev::file_contents dir(filename);
+        CATCH_REQUIRE(dir.exists());
+        CATCH_REQUIRE_FALSE(dir.read_all());
+        CATCH_REQUIRE(dir.last_error() == "an I/O error occurred reading \"" + filename + "\".");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("file_contents_atomic_write", "[os]")
+{
+    CATCH_START_SECTION("file_contents_atomic_write: atomic and durable modes")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/atomic");
+        std::string const filename(directory + "/state.txt");
+
+        snapdev::file_contents out(filename, true);
+        CATCH_REQUIRE(out.write_mode() == snapdev::file_contents::write_mode_t::WRITE_MODE_TRUNCATE);
+        out.contents("original contents\n");
+        CATCH_REQUIRE(out.write_all());
+        CATCH_REQUIRE(chmod(filename.c_str(), 0640) == 0);
+
+        for(auto const mode : {
+                      snapdev::file_contents::write_mode_t::WRITE_MODE_ATOMIC
+                    , snapdev::file_contents::write_mode_t::WRITE_MODE_DURABLE })
+        {
+            std::string const content(SNAP_CATCH2_NAMESPACE::random_bytes(rand() % 10'000 + 1));
+            out.write_mode(mode);
+            CATCH_REQUIRE(out.write_mode() == mode);
+            out.contents(content);
+            CATCH_REQUIRE(out.write_all());
+            CATCH_REQUIRE(out.last_error().empty());
+
+            snapdev::file_contents in(filename);
+            CATCH_REQUIRE(in.read_all());
+            CATCH_REQUIRE(in.contents() == content);
+
+            // the permissions of the existing file are kept
+            //
+            struct stat st = {};
+            CATCH_REQUIRE(stat(filename.c_str(), &st) == 0);
+            CATCH_REQUIRE((st.st_mode & 0777) == 0640);
+
+            CATCH_REQUIRE(count_temporary_files(directory) == 0);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_atomic_write: symbolic links are kept")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/atomic");
+        std::string const filename(directory + "/target.txt");
+        std::string const link(directory + "/link.txt");
+
+        snapdev::file_contents out(filename, true);
+        out.contents("original target\n");
+        CATCH_REQUIRE(out.write_all());
+        unlink(link.c_str());
+        CATCH_REQUIRE(symlink("target.txt", link.c_str()) == 0);
+
+        snapdev::file_contents file(link);
+        file.write_mode(snapdev::file_contents::write_mode_t::WRITE_MODE_DURABLE);
+        file.contents("new target\n");
+        CATCH_REQUIRE(file.write_all());
+
+        struct stat st = {};
+        CATCH_REQUIRE(lstat(link.c_str(), &st) == 0);
+        CATCH_REQUIRE(S_ISLNK(st.st_mode));
+
+        snapdev::file_contents in(filename);
+        CATCH_REQUIRE(in.read_all());
+        CATCH_REQUIRE(in.contents() == "new target\n");
+        CATCH_REQUIRE(count_temporary_files(directory) == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_atomic_write: missing directory")
+    {
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/atomic/missing-directory/state.txt");
+
+        snapdev::file_contents out(filename);
+        out.write_mode(snapdev::file_contents::write_mode_t::WRITE_MODE_DURABLE);
+        out.contents("cannot be saved\n");
+        CATCH_REQUIRE_FALSE(out.write_all());
+        CATCH_REQUIRE(out.last_error() == "could not open file \"" + filename + "\" for writing.");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_atomic_write: batch commit")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/batch");
+        mkdir(directory.c_str(), 0700);
+
+        std::vector<std::string> contents;
+        snapdev::file_contents_batch batch;
+        CATCH_REQUIRE(batch.empty());
+        for(int i(0); i < 50; ++i)
+        {
+            std::string const filename(directory + "/file-" + std::to_string(i) + ".txt");
+            snapdev::file_contents old(filename);
+            old.contents("old contents\n");
+            CATCH_REQUIRE(old.write_all());
+
+            contents.push_back(SNAP_CATCH2_NAMESPACE::random_bytes(rand() % 1'000 + 1));
+            if((i & 1) == 0)
+            {
+                CATCH_REQUIRE(batch.add(filename, contents.back()));
+            }
+            else
+            {
+                snapdev::file_contents file(filename);
+                file.contents(contents.back());
+                CATCH_REQUIRE(batch.add(file));
+            }
+        }
+        CATCH_REQUIRE(batch.size() == 50);
+        CATCH_REQUIRE(count_temporary_files(directory) == 50);
+
+        // nothing changes until the commit
+        //
+        {
+            snapdev::file_contents in(directory + "/file-7.txt");
+            CATCH_REQUIRE(in.read_all());
+            CATCH_REQUIRE(in.contents() == "old contents\n");
+        }
+
+        CATCH_REQUIRE(batch.commit());
+        CATCH_REQUIRE(batch.empty());
+        CATCH_REQUIRE(batch.last_error().empty());
+        CATCH_REQUIRE(count_temporary_files(directory) == 0);
+
+        for(int i(0); i < 50; ++i)
+        {
+            snapdev::file_contents in(directory + "/file-" + std::to_string(i) + ".txt");
+            CATCH_REQUIRE(in.read_all());
+            CATCH_REQUIRE(in.contents() == contents[i]);
+        }
+
+        // an empty batch commits nothing
+        //
+        CATCH_REQUIRE(batch.commit());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_atomic_write: batch larger than the file descriptor limit")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/batch-limit");
+        mkdir(directory.c_str(), 0700);
+
+        rlimit saved = {};
+        CATCH_REQUIRE(getrlimit(RLIMIT_NOFILE, &saved) == 0);
+        rlimit limit(saved);
+        limit.rlim_cur = 128;
+        CATCH_REQUIRE(setrlimit(RLIMIT_NOFILE, &limit) == 0);
+
+        bool added(true);
+        bool committed(false);
+        {
+            snapdev::file_contents_batch batch;
+            for(int i(0); i < 200 && added; ++i)
+            {
+                added = batch.add(directory + "/file-" + std::to_string(i) + ".txt", std::to_string(i) + "\n");
+            }
+            committed = added && batch.commit();
+        }
+        CATCH_REQUIRE(setrlimit(RLIMIT_NOFILE, &saved) == 0);
+
+        CATCH_REQUIRE(added);
+        CATCH_REQUIRE(committed);
+        for(int i(0); i < 200; ++i)
+        {
+            snapdev::file_contents in(directory + "/file-" + std::to_string(i) + ".txt");
+            CATCH_REQUIRE(in.read_all());
+            CATCH_REQUIRE(in.contents() == std::to_string(i) + "\n");
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_atomic_write: batch rollback")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/batch");
+        std::string const filename(directory + "/rollback.txt");
+        {
+            snapdev::file_contents old(filename, true);
+            old.contents("kept\n");
+            CATCH_REQUIRE(old.write_all());
+        }
+
+        {
+            snapdev::file_contents_batch batch;
+            CATCH_REQUIRE(batch.add(filename, "dropped\n"));
+            CATCH_REQUIRE(count_temporary_files(directory) == 1);
+
+            std::string const missing(directory + "/missing-directory/file.txt");
+            CATCH_REQUIRE_FALSE(batch.add(missing, "cannot be saved\n"));
+            CATCH_REQUIRE(batch.last_error() == "could not open file \"" + missing + "\" for writing.");
+            CATCH_REQUIRE(batch.size() == 1);
+
+            batch.rollback();
+            CATCH_REQUIRE(batch.empty());
+            CATCH_REQUIRE(count_temporary_files(directory) == 0);
+
+            // the destructor also removes the temporary files
+            //
+            CATCH_REQUIRE(batch.add(filename, "dropped again\n"));
+        }
+        CATCH_REQUIRE(count_temporary_files(directory) == 0);
+
+        snapdev::file_contents in(filename);
+        CATCH_REQUIRE(in.read_all());
+        CATCH_REQUIRE(in.contents() == "kept\n");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("file_contents_batch_benchmark", "[.][os][benchmark]")
+{
+    CATCH_START_SECTION("file_contents_batch benchmark: durable writes one by one against a batch")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/batch-benchmark");
+        mkdir(directory.c_str(), 0700);
+        std::string const content(SNAP_CATCH2_NAMESPACE::random_bytes(512));
+
+        std::chrono::duration<double> const one_by_one(run_duration(1, [&directory, &content]()
+            {
+                for(int i(0); i < 100; ++i)
+                {
+                    snapdev::file_contents out(directory + "/state-" + std::to_string(i) + ".txt");
+                    out.write_mode(snapdev::file_contents::write_mode_t::WRITE_MODE_DURABLE);
+                    out.contents(content);
+                    CATCH_REQUIRE(out.write_all());
+                }
+                return 100;
+            }));
+        std::chrono::duration<double> const batched(run_duration(1, [&directory, &content]()
+            {
+                snapdev::file_contents_batch batch;
+                for(int i(0); i < 100; ++i)
+                {
+                    CATCH_REQUIRE(batch.add(directory + "/state-" + std::to_string(i) + ".txt", content));
+                }
+                CATCH_REQUIRE(batch.commit());
+                return 100;
+            }));
+        std::cout << "--- 100 files: "
+                  << std::fixed << std::setprecision(6)
+                  << one_by_one.count() << "s with WRITE_MODE_DURABLE, "
+                  << batched.count() << "s with a file_contents_batch\n";
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("file_contents_benchmark", "[.][os][benchmark]")
+{
+    CATCH_START_SECTION("file_contents benchmark: read_all() against std::ifstream")
+    {
+        struct size_t_and_count
+        {
+            std::size_t     f_size = 0;
+            int             f_count = 0;
+        };
+        size_t_and_count const sizes[] =
+        {
+            { 1024, 2000 },
+            { 64 * 1024, 500 },
+            { 16 * 1024 * 1024, 5 },
+        };
+        for(auto const & s : sizes)
+        {
+            std::string const content(SNAP_CATCH2_NAMESPACE::random_bytes(s.f_size));
+            std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/contents/benchmark.bin");
+            {
+                snapdev::file_contents out(filename, true);
+                out.contents(content);
+                CATCH_REQUIRE(out.write_all());
+            }
+
+            std::chrono::duration<double> const posix(run_duration(s.f_count, [&filename]()
+                {
+                    snapdev::file_contents in(filename);
+                    CATCH_REQUIRE(in.read_all());
+                    return in.contents().size();
+                }));
+            std::chrono::duration<double> const stream(run_duration(s.f_count, [&filename]()
+                {
+                    std::ifstream in(filename, std::ios::in | std::ios::binary);
+                    in.seekg(0, std::ios::end);
+                    std::string buffer(in.tellg(), '\0');
+                    in.seekg(0, std::ios::beg);
+                    in.read(buffer.data(), buffer.size());
+                    return buffer.size();
+                }));
+            std::cout << "--- " << std::setw(8) << s.f_size << " bytes x " << std::setw(4) << s.f_count << ": "
+                      << std::fixed << std::setprecision(6)
+                      << posix.count() << "s with read_all(), "
+                      << stream.count() << "s with std::ifstream\n";
+        }
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -0,0 +1,341 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the file_contents_cache class.
+ *
+ * This file implements tests checking that the cache returns the same
+ * buffer while a file does not change, reads it again when it does,
+ * enforces its memory budget, and invalidates entries from inotify.
+ */
+
+// self
+//
+#include    <snapdev/file_contents_cache.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <chrono>
+#include    <thread>
+
+
+// C
+//
+#include    <fcntl.h>
+#include    <sys/stat.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+std::string cache_filename(std::string const & name)
+{
+    return SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/cache/" + name;
+}
+
+
+void save(std::string const & filename, std::string const & content)
+{
+    snapdev::file_contents out(filename, true);
+    out.contents(content);
+    CATCH_REQUIRE(out.write_all());
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("file_contents_cache", "[os]")
+{
+    CATCH_START_SECTION("file_contents_cache: cached until the file changes")
+    {
+        std::string const filename(cache_filename("changes.txt"));
+        save(filename, "first version\n");
+
+        snapdev::file_contents_cache cache;
+        CATCH_REQUIRE(cache.get_memory_budget() == snapdev::file_contents_cache::DEFAULT_MEMORY_BUDGET);
+        CATCH_REQUIRE_FALSE(cache.is_watching());
+
+        snapdev::file_contents_cache::buffer_t const first(cache.get(filename));
+        CATCH_REQUIRE(first != nullptr);
+        CATCH_REQUIRE(*first == "first version\n");
+        CATCH_REQUIRE(cache.size() == 1);
+        CATCH_REQUIRE(cache.memory_usage() == first->length());
+
+        // same buffer while the file does not change
+        //
+        CATCH_REQUIRE(cache.get(filename) == first);
+
+        save(filename, "second, longer version\n");
+        snapdev::file_contents_cache::buffer_t const second(cache.get(filename));
+        CATCH_REQUIRE(second != first);
+        CATCH_REQUIRE(*second == "second, longer version\n");
+        CATCH_REQUIRE(cache.size() == 1);
+        CATCH_REQUIRE(cache.memory_usage() == second->length());
+
+        // the old buffer is still valid
+        //
+        CATCH_REQUIRE(*first == "first version\n");
+
+        // a new inode (atomic write) is also detected
+        //
+        {
+            snapdev::file_contents out(filename);
+            out.write_mode(snapdev::file_contents::write_mode_t::WRITE_MODE_ATOMIC);
+            out.contents("third version!!!!!!!!!\n");
+            CATCH_REQUIRE(out.write_all());
+        }
+        snapdev::file_contents_cache::buffer_t const third(cache.get(filename));
+        CATCH_REQUIRE(*third == "third version!!!!!!!!!\n");
+
+        cache.invalidate(filename);
+        CATCH_REQUIRE(cache.size() == 0);
+        CATCH_REQUIRE(cache.memory_usage() == 0);
+        snapdev::file_contents_cache::buffer_t const fourth(cache.get(filename));
+        CATCH_REQUIRE(fourth != third);
+        CATCH_REQUIRE(*fourth == *third);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_cache: missing and deleted files")
+    {
+        snapdev::file_contents_cache cache;
+
+        std::string const missing(cache_filename("missing.txt"));
+        std::string error_msg;
+        CATCH_REQUIRE(cache.get(missing, error_msg) == nullptr);
+        CATCH_REQUIRE(error_msg == "could not open file \"" + missing + "\" for reading.");
+        CATCH_REQUIRE(cache.size() == 0);
+
+        std::string const filename(cache_filename("deleted.txt"));
+        save(filename, "to be deleted\n");
+        CATCH_REQUIRE(*cache.get(filename) == "to be deleted\n");
+        CATCH_REQUIRE(cache.size() == 1);
+
+        CATCH_REQUIRE(unlink(filename.c_str()) == 0);
+        CATCH_REQUIRE(cache.get(filename) == nullptr);
+        CATCH_REQUIRE(cache.size() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_cache: memory budget")
+    {
+        snapdev::file_contents_cache cache(3'000);
+        CATCH_REQUIRE(cache.get_memory_budget() == 3'000);
+
+        for(int i(0); i < 5; ++i)
+        {
+            save(cache_filename("budget-" + std::to_string(i) + ".txt"), std::string(1'000, 'a' + i));
+        }
+
+        for(int i(0); i < 3; ++i)
+        {
+            CATCH_REQUIRE(cache.get(cache_filename("budget-" + std::to_string(i) + ".txt")) != nullptr);
+        }
+        CATCH_REQUIRE(cache.size() == 3);
+        CATCH_REQUIRE(cache.memory_usage() == 3'000);
+
+        // use file 0 so file 1 is the least recently used
+        //
+        snapdev::file_contents_cache::buffer_t const zero(cache.get(cache_filename("budget-0.txt")));
+        snapdev::file_contents_cache::buffer_t const two(cache.get(cache_filename("budget-2.txt")));
+        CATCH_REQUIRE(cache.get(cache_filename("budget-3.txt")) != nullptr);
+        CATCH_REQUIRE(cache.size() == 3);
+        CATCH_REQUIRE(cache.memory_usage() == 3'000);
+        CATCH_REQUIRE(cache.get(cache_filename("budget-0.txt")) == zero);
+        CATCH_REQUIRE(cache.get(cache_filename("budget-2.txt")) == two);
+
+        // a file larger than the budget is returned but not cached
+        //
+        std::string const large(cache_filename("large.txt"));
+        save(large, std::string(3'001, 'L'));
+        snapdev::file_contents_cache::buffer_t const l(cache.get(large));
+        CATCH_REQUIRE(l != nullptr);
+        CATCH_REQUIRE(l->length() == 3'001);
+        CATCH_REQUIRE(cache.size() == 3);
+        CATCH_REQUIRE(cache.get(large) != l);
+
+        cache.set_memory_budget(1'500);
+        CATCH_REQUIRE(cache.size() == 1);
+        CATCH_REQUIRE(cache.memory_usage() == 1'000);
+        CATCH_REQUIRE(cache.get(cache_filename("budget-2.txt")) == two);
+
+        cache.clear();
+        CATCH_REQUIRE(cache.size() == 0);
+        CATCH_REQUIRE(cache.memory_usage() == 0);
+
+        // buffers are shared so they survive the eviction
+        //
+        CATCH_REQUIRE(*zero == std::string(1'000, 'a'));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_cache: process wide instance")
+    {
+        CATCH_REQUIRE(&snapdev::file_contents_cache::instance() == &snapdev::file_contents_cache::instance());
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("file_contents_cache_watch", "[os][thread]")
+{
+    CATCH_START_SECTION("file_contents_cache_watch: inotify invalidates modified files")
+    {
+        std::string const filename(cache_filename("watched.txt"));
+        save(filename, "watched version 1\n");
+
+        snapdev::file_contents_cache cache;
+        CATCH_REQUIRE(cache.start_watching());
+        CATCH_REQUIRE(cache.start_watching());
+        CATCH_REQUIRE(cache.is_watching());
+
+        snapdev::file_contents_cache::buffer_t const first(cache.get(filename));
+        CATCH_REQUIRE(*first == "watched version 1\n");
+        CATCH_REQUIRE(cache.get(filename) == first);
+
+        struct stat st = {};
+        CATCH_REQUIRE(stat(filename.c_str(), &st) == 0);
+
+        // same size and restore the modification time so the stat()
+        // key does not change, only inotify can see this modification
+        //
+        save(filename, "watched version 2\n");
+        timespec const times[2] = { st.st_atim, st.st_mtim };
+        CATCH_REQUIRE(utimensat(AT_FDCWD, filename.c_str(), times, 0) == 0);
+
+        snapdev::file_contents_cache::buffer_t current;
+        for(int i(0); i < 500; ++i)
+        {
+            current = cache.get(filename);
+            if(*current != *first)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CATCH_REQUIRE(*current == "watched version 2\n");
+
+        // an event only invalidates the entries it concerns
+        //
+        std::string const other(cache_filename("other.txt"));
+        save(other, "other\n");
+        cache.get(other);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // let the creation events go through
+        snapdev::file_contents_cache::buffer_t const other_buffer(cache.get(other));
+        save(filename, "watched version 4\n");
+        for(int i(0); i < 500; ++i)
+        {
+            current = cache.get(filename);
+            if(*current == "watched version 4\n")
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CATCH_REQUIRE(*current == "watched version 4\n");
+        CATCH_REQUIRE(cache.get(other) == other_buffer);
+        cache.invalidate(other);
+
+        // replacing the file with a rename() is also seen
+        //
+        {
+            snapdev::file_contents out(filename);
+            out.write_mode(snapdev::file_contents::write_mode_t::WRITE_MODE_ATOMIC);
+            out.contents("watched version 3\n");
+            CATCH_REQUIRE(out.write_all());
+        }
+        for(int i(0); i < 500; ++i)
+        {
+            current = cache.get(filename);
+            if(*current == "watched version 3\n")
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CATCH_REQUIRE(*current == "watched version 3\n");
+        CATCH_REQUIRE(cache.size() == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("file_contents_cache_watch: symbolic links and renamed directories")
+    {
+        // the watches only apply to canonical paths
+        //
+        char * real(realpath(SNAP_CATCH2_NAMESPACE::g_tmp_dir().c_str(), nullptr));
+        CATCH_REQUIRE(real != nullptr);
+        std::string const dir(std::string(real) + "/cache/deploy");
+        free(real);
+        CATCH_REQUIRE(system(("rm -rf " + dir + " && mkdir -p " + dir + "/a " + dir + "/b").c_str()) == 0);
+        save(dir + "/a/page.html", "deploy a\n");
+        save(dir + "/b/page.html", "deploy b\n");
+        CATCH_REQUIRE(symlink("a", (dir + "/cur").c_str()) == 0);
+
+        snapdev::file_contents_cache cache;
+        CATCH_REQUIRE(cache.start_watching());
+
+        // retarget the symbolic link atomically
+        //
+        std::string const link(dir + "/cur/page.html");
+        CATCH_REQUIRE(*cache.get(link) == "deploy a\n");
+        CATCH_REQUIRE(symlink("b", (dir + "/cur.new").c_str()) == 0);
+        CATCH_REQUIRE(rename((dir + "/cur.new").c_str(), (dir + "/cur").c_str()) == 0);
+        CATCH_REQUIRE(*cache.get(link) == "deploy b\n");
+
+        // the non-canonical path keeps being verified with stat()
+        //
+        CATCH_REQUIRE(symlink("a", (dir + "/cur.new").c_str()) == 0);
+        CATCH_REQUIRE(rename((dir + "/cur.new").c_str(), (dir + "/cur").c_str()) == 0);
+        CATCH_REQUIRE(*cache.get(link) == "deploy a\n");
+
+        // swap the parent directories
+        //
+        std::string const filename(dir + "/a/page.html");
+        CATCH_REQUIRE(*cache.get(filename) == "deploy a\n");
+        CATCH_REQUIRE(rename((dir + "/a").c_str(), (dir + "/old").c_str()) == 0);
+        CATCH_REQUIRE(rename((dir + "/b").c_str(), (dir + "/a").c_str()) == 0);
+        snapdev::file_contents_cache::buffer_t current;
+        for(int i(0); i < 500; ++i)
+        {
+            current = cache.get(filename);
+            if(*current == "deploy b\n")
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        CATCH_REQUIRE(*current == "deploy b\n");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
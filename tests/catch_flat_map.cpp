@@ -0,0 +1,174 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the flat_map container.
+ *
+ * This file implements tests comparing the flat_map against an std::map.
+ */
+
+// self
+//
+#include    <snapdev/flat_map.h>
+
+#include    <snapdev/map_keyset.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <map>
+#include    <set>
+#include    <string_view>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+template<typename K, typename T>
+bool same(snapdev::flat_map<K, T> const & fm, std::map<K, T> const & m)
+{
+    return std::equal(
+              fm.begin()
+            , fm.end()
+            , m.begin()
+            , m.end()
+            , [](auto const & a, auto const & b)
+              {
+                  return a.first == b.first && a.second == b.second;
+              });
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("flat_map", "[map][container]")
+{
+    CATCH_START_SECTION("flat_map: operations against std::map")
+    {
+        snapdev::flat_map<int, int> fm;
+        std::map<int, int> m;
+        for(int i(0); i < 2'000; ++i)
+        {
+            int const key(rand() % 300);
+            switch(rand() % 4)
+            {
+            case 0:
+                fm[key] = i;
+                m[key] = i;
+                break;
+
+            case 1:
+                CATCH_REQUIRE(fm.insert({ key, i }).second == m.insert({ key, i }).second);
+                break;
+
+            case 2:
+                CATCH_REQUIRE(fm.insert_or_assign(key, i).second == m.insert_or_assign(key, i).second);
+                break;
+
+            default:
+                CATCH_REQUIRE(fm.erase(key) == m.erase(key));
+                break;
+
+            }
+            CATCH_REQUIRE(fm.contains(key) == (m.count(key) == 1));
+        }
+        CATCH_REQUIRE(fm.size() == m.size());
+        CATCH_REQUIRE(same(fm, m));
+
+        for(auto & p : fm)
+        {
+            p.second *= 2;
+        }
+        for(auto const & p : m)
+        {
+            CATCH_REQUIRE(fm.at(p.first) == p.second * 2);
+        }
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  fm.at(-1)
+                , std::out_of_range
+                , Catch::Matchers::ExceptionMessage("flat_map::at(): key not found."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_map: bulk construction keeps the first value")
+    {
+        std::vector<std::pair<int, int>> pairs;
+        std::map<int, int> m;
+        for(int i(0); i < 5'000; ++i)
+        {
+            int const key(rand() % 1'000);
+            pairs.emplace_back(key, i);
+            m.insert({ key, i });
+        }
+        snapdev::flat_map<int, int> fm(pairs);
+        CATCH_REQUIRE(same(fm, m));
+
+        // existing values win over the new ones
+        //
+        fm.insert({ { 0, -1 }, { 1'000, -2 }, { 1'001, -3 } });
+        m.insert({ { 0, -1 }, { 1'000, -2 }, { 1'001, -3 } });
+        CATCH_REQUIRE(same(fm, m));
+
+        snapdev::flat_map<int, int> hinted;
+        for(auto const & p : m)
+        {
+            hinted.insert(hinted.end(), p);
+        }
+        CATCH_REQUIRE(hinted == fm);
+
+        std::vector<std::pair<int, int>> const extracted(hinted.extract());
+        CATCH_REQUIRE(hinted.empty());
+        hinted.replace(std::vector<std::pair<int, int>>(extracted));
+        CATCH_REQUIRE(hinted == fm);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_map: string keys")
+    {
+        snapdev::flat_map<std::string, int> fm{ { "zebra", 1 }, { "apple", 2 } };
+        CATCH_REQUIRE(fm.try_emplace("mango", 3).second);
+        CATCH_REQUIRE_FALSE(fm.try_emplace("apple", 4).second);
+        CATCH_REQUIRE(fm.at(std::string_view("apple")) == 2);
+        CATCH_REQUIRE(fm.find(std::string_view("mango"))->second == 3);
+        CATCH_REQUIRE(fm.find(std::string_view("kiwi")) == fm.end());
+        CATCH_REQUIRE(fm.begin()->first == "apple");
+        CATCH_REQUIRE(fm.rbegin()->first == "zebra");
+        CATCH_REQUIRE(fm.lower_bound("b")->first == "mango");
+        CATCH_REQUIRE(fm.upper_bound("mango")->first == "zebra");
+
+        std::set<std::string> keys;
+        snapdev::map_keyset(keys, fm);
+        CATCH_REQUIRE(keys == std::set<std::string>({ "apple", "mango", "zebra" }));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,223 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the flat_set container.
+ *
+ * This file implements tests comparing the flat_set against an std::set
+ * and verifies that it works with the other set functions of snapdev.
+ */
+
+// self
+//
+#include    <snapdev/flat_set.h>
+
+#include    <snapdev/empty_set_intersection.h>
+#include    <snapdev/map_keyset.h>
+#include    <snapdev/remove_duplicates.h>
+#include    <snapdev/sorted_intersection.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <map>
+#include    <set>
+#include    <string_view>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+CATCH_TEST_CASE("flat_set", "[set][container]")
+{
+    CATCH_START_SECTION("flat_set: insert and erase against std::set")
+    {
+        snapdev::flat_set<int> fs;
+        std::set<int> s;
+        for(int i(0); i < 2'000; ++i)
+        {
+            int const value(rand() % 500);
+            switch(rand() % 3)
+            {
+            case 0:
+            case 1:
+                {
+                    auto const a(fs.insert(value));
+                    auto const b(s.insert(value));
+                    CATCH_REQUIRE(a.second == b.second);
+                    CATCH_REQUIRE(*a.first == value);
+                }
+                break;
+
+            default:
+                CATCH_REQUIRE(fs.erase(value) == s.erase(value));
+                break;
+
+            }
+            CATCH_REQUIRE(fs.contains(value) == (s.count(value) == 1));
+        }
+        CATCH_REQUIRE(fs.size() == s.size());
+        CATCH_REQUIRE(std::equal(fs.begin(), fs.end(), s.begin(), s.end()));
+
+        auto const lb(fs.lower_bound(250));
+        CATCH_REQUIRE(std::distance(fs.begin(), lb) == std::distance(s.begin(), s.lower_bound(250)));
+        auto const ub(fs.upper_bound(250));
+        CATCH_REQUIRE(std::distance(fs.begin(), ub) == std::distance(s.begin(), s.upper_bound(250)));
+
+        std::size_t const removed(fs.erase_if([](int v) { return (v & 1) != 0; }));
+        CATCH_REQUIRE(removed + fs.size() == s.size());
+        CATCH_REQUIRE(std::all_of(fs.begin(), fs.end(), [](int v) { return (v & 1) == 0; }));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set: bulk construction and insertion")
+    {
+        std::vector<int> values;
+        for(int i(0); i < 10'000; ++i)
+        {
+            values.push_back(rand() % 3'000);
+        }
+        std::set<int> const s(values.begin(), values.end());
+
+        snapdev::flat_set<int> const fs(values);
+        CATCH_REQUIRE(std::equal(fs.begin(), fs.end(), s.begin(), s.end()));
+        CATCH_REQUIRE(std::is_sorted(fs.begin(), fs.end()));
+
+        snapdev::flat_set<int> more{ 5, -3, 5, 10'000 };
+        CATCH_REQUIRE(more.size() == 3);
+        more.insert(values.begin(), values.end());
+        std::set<int> s2(s);
+        s2.insert({ -3, 10'000 });
+        CATCH_REQUIRE(std::equal(more.begin(), more.end(), s2.begin(), s2.end()));
+
+        std::vector<int> sorted(fs.begin(), fs.end());
+        snapdev::flat_set<int> const from_sorted(snapdev::sorted_unique, sorted);
+        CATCH_REQUIRE(from_sorted == fs);
+
+        snapdev::flat_set<int> copy(fs);
+        std::vector<int> const extracted(copy.extract());
+        CATCH_REQUIRE(copy.empty());
+        CATCH_REQUIRE(extracted == sorted);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set: hint insertion")
+    {
+        snapdev::flat_set<int> fs;
+        for(int i(0); i < 100; ++i)
+        {
+            fs.insert(fs.end(), i * 2);
+        }
+        CATCH_REQUIRE(fs.size() == 100);
+
+        // wrong hints still work
+        //
+        fs.insert(fs.begin(), 51);
+        fs.insert(fs.end(), 3);
+        fs.insert(fs.begin() + 10, 0);
+        CATCH_REQUIRE(fs.size() == 102);
+        CATCH_REQUIRE(std::is_sorted(fs.begin(), fs.end()));
+        CATCH_REQUIRE(fs.contains(3));
+        CATCH_REQUIRE(fs.contains(51));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set: heterogeneous lookups")
+    {
+        snapdev::flat_set<std::string> const fs{ "users", "admin", "staff", "admin" };
+        CATCH_REQUIRE(fs.size() == 3);
+        CATCH_REQUIRE(fs.contains(std::string_view("staff")));
+        CATCH_REQUIRE(fs.contains("admin"));
+        CATCH_REQUIRE_FALSE(fs.contains(std::string_view("video")));
+        CATCH_REQUIRE(*fs.find(std::string_view("users")) == "users");
+        CATCH_REQUIRE(fs.count("users") == 1);
+
+        auto const range(fs.equal_range(std::string_view("staff")));
+        CATCH_REQUIRE(std::distance(range.first, range.second) == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set: custom comparator")
+    {
+        snapdev::flat_set<int, std::greater<int>> const fs{ 1, 5, 3, 5, 9 };
+        CATCH_REQUIRE(std::vector<int>(fs.begin(), fs.end()) == std::vector<int>({ 9, 5, 3, 1 }));
+        CATCH_REQUIRE(fs.contains(3));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("flat_set_helpers", "[set][container]")
+{
+    CATCH_START_SECTION("flat_set_helpers: map_keyset()")
+    {
+        std::map<std::string, int> m;
+        for(int i(0); i < 100; ++i)
+        {
+            m[std::to_string(rand() % 1'000)] = i;
+        }
+        snapdev::flat_set<std::string> keys;
+        snapdev::map_keyset(keys, m);
+        CATCH_REQUIRE(keys.size() == m.size());
+        for(auto const & p : m)
+        {
+            CATCH_REQUIRE(keys.contains(p.first));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set_helpers: intersections")
+    {
+        snapdev::flat_set<int> const a{ 1, 3, 5, 7, 9 };
+        snapdev::flat_set<int> const b{ 2, 4, 6, 8 };
+        snapdev::flat_set<int> const c{ 4, 5, 6, 7 };
+        CATCH_REQUIRE(snapdev::empty_set_intersection(a, b));
+        CATCH_REQUIRE_FALSE(snapdev::empty_set_intersection(a, c));
+        CATCH_REQUIRE(snapdev::sorted_intersection_count(a, c) == 2);
+
+        std::vector<int> result;
+        snapdev::sorted_intersection(b, c, std::back_inserter(result));
+        CATCH_REQUIRE(result == std::vector<int>({ 4, 6 }));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("flat_set_helpers: remove duplicates first")
+    {
+        std::vector<int> values;
+        for(int i(0); i < 1'000; ++i)
+        {
+            values.push_back(rand() % 100);
+        }
+        std::set<int> const s(values.begin(), values.end());
+        snapdev::unsorted_remove_duplicates(values);
+        CATCH_REQUIRE(values.size() == s.size());
+
+        snapdev::flat_set<int> const fs(values);
+        CATCH_REQUIRE(std::equal(fs.begin(), fs.end(), s.begin(), s.end()));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -30,10 +30,11 @@
 
 
 
-// C++ lib
+// C++
 //
-//#include    <iomanip>
-//#include    <set>
+#include    <cstring>
+#include    <limits>
+#include    <random>
 
 
 // last include
@@ -143,6 +144,146 @@ CATCH_TEST_CASE("floating_point_to_string", "[float][string]")
         }
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("floating_point_to_string: shortest representation")
+    {
+        CATCH_REQUIRE(snapdev::floating_point_to_string(0.1) == "0.1");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(-2.5) == "-2.5");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(100.0) == "100.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(100.0, false) == "100");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(-0.0) == "0.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(-0.0, false) == "0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e300) == "1.0e+300");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e300, false) == "1e+300");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(0.1f) == "0.1");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(0.5L) == "0.5");
+
+        // std::to_string() returned "0.000000" for these
+        //
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1.5e-7) == "1.5e-07");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(0.0000123) == "0.0000123");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(std::numeric_limits<double>::denorm_min()) == "5.0e-324");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(std::numeric_limits<double>::denorm_min(), false) == "5e-324");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("floating_point_to_string: fixed notation from 1e-5 to 1e16")
+    {
+        // round numbers do not switch to the shorter scientific notation
+        //
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e5) == "100000.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e5, false) == "100000");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(100001.0) == "100001.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e6) == "1000000.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e6, false) == "1000000");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(-1e6) == "-1000000.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e15) == "1000000000000000.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e15, false) == "1000000000000000");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e-4) == "0.0001");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e-4, false) == "0.0001");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e-5) == "0.00001");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e5f) == "100000.0");
+
+        // outside of the range, the scientific notation is used and the
+        // period is added to the mantissa
+        //
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e16) == "1.0e+16");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(1e16, false) == "1e+16");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(-1.25e20) == "-1.25e+20");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(9e-6) == "9.0e-06");
+        CATCH_REQUIRE(snapdev::floating_point_to_string(9e-6, false) == "9e-06");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("floating_point_to_string: round trip")
+    {
+        std::mt19937_64 generator(SNAP_CATCH2_NAMESPACE::rand_int64());
+        for(int i(0); i < 10'000; ++i)
+        {
+            // random bits give numbers of all magnitudes
+            //
+            std::uint64_t const bits(generator());
+            double value(0.0);
+            memcpy(&value, &bits, sizeof(value));
+            if(std::isnan(value))
+            {
+                continue;
+            }
+
+            std::string const str(snapdev::floating_point_to_string(value));
+            CATCH_REQUIRE(str.length() < snapdev::floating_point_to_chars_max_size);
+            if(std::isinf(value))
+            {
+                CATCH_REQUIRE(str == (value < 0.0 ? "-Infinity" : "Infinity"));
+            }
+            else
+            {
+                double const back(std::strtod(str.c_str(), nullptr));
+                CATCH_REQUIRE(memcmp(&back, &value, sizeof(value)) == 0);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("floating_point_to_string: fixed precision")
+    {
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(3.14159, 2) == "3.14");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(2.5, 0) == "2");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(-1.0, 3) == "-1.000");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(-0.0, 1) == "0.0");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(0.000001234, 8) == "0.00000123");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(1.5, -3) == "2");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(std::numeric_limits<double>::quiet_NaN(), 2) == "NaN");
+        CATCH_REQUIRE(snapdev::floating_point_to_string_fixed(-std::numeric_limits<double>::infinity(), 2) == "-Infinity");
+
+        // larger than the default buffer
+        //
+        std::string const large(snapdev::floating_point_to_string_fixed(1e300, 2));
+        CATCH_REQUIRE(large.length() == 301 + 3);
+        CATCH_REQUIRE(large.substr(0, 2) == "10");
+        CATCH_REQUIRE(large.substr(large.length() - 3) == ".00");
+
+        std::string const max(snapdev::floating_point_to_string_fixed(-std::numeric_limits<double>::max(), 0));
+        CATCH_REQUIRE(max.length() == 310);
+        CATCH_REQUIRE(max.substr(0, 5) == "-1797");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("floating_point_to_chars", "[float][string]")
+{
+    CATCH_START_SECTION("floating_point_to_chars: caller buffer")
+    {
+        char buf[snapdev::floating_point_to_chars_max_size];
+        char * end(snapdev::floating_point_to_chars(buf, buf + sizeof(buf), 12.75));
+        CATCH_REQUIRE(std::string(buf, end) == "12.75");
+
+        end = snapdev::floating_point_to_chars(buf, buf + sizeof(buf), -std::numeric_limits<float>::infinity());
+        CATCH_REQUIRE(std::string(buf, end) == "-Infinity");
+
+        // the ".0" must fit too
+        //
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 4, 12.0) == buf + 4);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 3, 12.0) == nullptr);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 2, 12.0, false) == buf + 2);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 4, 12.75) == nullptr);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 2, 0.0) == nullptr);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars(buf, buf + 2, std::numeric_limits<double>::quiet_NaN()) == nullptr);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("floating_point_to_chars: fixed precision")
+    {
+        char buf[snapdev::floating_point_to_chars_max_size];
+        char * end(snapdev::floating_point_to_chars_fixed(buf, buf + sizeof(buf), 1.0 / 3.0, 5));
+        CATCH_REQUIRE(std::string(buf, end) == "0.33333");
+
+        CATCH_REQUIRE(snapdev::floating_point_to_chars_fixed(buf, buf + 7, 1.0 / 3.0, 5) == buf + 7);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars_fixed(buf, buf + 6, 1.0 / 3.0, 5) == nullptr);
+        CATCH_REQUIRE(snapdev::floating_point_to_chars_fixed(buf, buf + sizeof(buf), 1e300, 0) == nullptr);
+    }
+    CATCH_END_SECTION()
 }
 
 
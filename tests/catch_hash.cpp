@@ -0,0 +1,210 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the hash functions.
+ *
+ * This file implements tests to verify the hash64() and hash128()
+ * functions, the streaming hashers, and compares their speed against
+ * std::hash<std::string>.
+ */
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+// snapdev
+//
+#include    <snapdev/math.h>
+
+
+// C++
+//
+#include    <chrono>
+#include    <iomanip>
+#include    <set>
+#include    <unordered_set>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+// __int128 is not ISO C++ yet
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+
+
+namespace
+{
+
+
+// make sure the hash is computed at compile time
+//
+constexpr std::uint64_t g_hello_hash = snapdev::hash64("hello");
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("hash", "[math][hash]")
+{
+    CATCH_START_SECTION("hash: all the interfaces agree")
+    {
+        for(std::size_t size(0); size < 300; ++size)
+        {
+            std::string const data(SNAP_CATCH2_NAMESPACE::random_bytes(size));
+            std::uint64_t const seed(rand() % 3 == 0 ? 0 : SNAP_CATCH2_NAMESPACE::rand_int64());
+            std::uint64_t const h(snapdev::hash64(data, seed));
+            CATCH_REQUIRE(snapdev::hash64(data.data(), data.length(), seed) == h);
+            CATCH_REQUIRE(snapdev::hash64(std::as_bytes(std::span<char const>(data)), seed) == h);
+
+            unsigned __int128 const h128(snapdev::hash128(data, seed));
+            CATCH_REQUIRE(static_cast<std::uint64_t>(h128) == h);
+            CATCH_REQUIRE(snapdev::hash128(data.data(), data.length(), seed) == h128);
+
+            // streaming with random steps
+            //
+            for(int repeat(0); repeat < 5; ++repeat)
+            {
+                snapdev::hasher64 h64(seed);
+                snapdev::hasher128 h2(seed);
+                std::size_t pos(0);
+                while(pos < size)
+                {
+                    std::size_t const step(std::min(size - pos, static_cast<std::size_t>(rand() % (repeat * 30 + 1) + 1)));
+                    h64.update(data.data() + pos, step);
+                    h2.update(std::string_view(data).substr(pos, step));
+                    pos += step;
+                }
+                CATCH_REQUIRE(h64.digest() == h);
+                CATCH_REQUIRE(h2.digest() == h128);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hash: compile time")
+    {
+        static_assert(snapdev::hash64("hello") != snapdev::hash64("hellp"));
+        static_assert(static_cast<std::uint64_t>(snapdev::hash128("hello")) == snapdev::hash64("hello"));
+
+        std::string const hello("hello");
+        CATCH_REQUIRE(snapdev::hash64(hello.data(), hello.length()) == g_hello_hash);
+
+        std::string const data(SNAP_CATCH2_NAMESPACE::random_bytes(200));
+        std::string_view const v(data);
+        constexpr std::string_view const long_string("The quick brown fox jumps over the lazy dog and then runs away.");
+        constexpr std::uint64_t const long_hash(snapdev::hash64(long_string, 123));
+        CATCH_REQUIRE(snapdev::hash64(std::string(long_string), 123) == long_hash);
+        CATCH_REQUIRE(snapdev::hash64(v) == snapdev::hash64(data.data(), data.length()));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hash: stable values")
+    {
+        // these values may be saved on disk, they must never change
+        //
+        CATCH_REQUIRE(snapdev::hash64("") == 0x93228a4de0eec5a2ULL);
+        CATCH_REQUIRE(snapdev::hash64("a") == 0xaced12527fe5bff8ULL);
+        CATCH_REQUIRE(snapdev::hash64("snapdev") == 0xfcc0ac081ba5d78dULL);
+        CATCH_REQUIRE(snapdev::hash64("The quick brown fox jumps over the lazy dog and then runs away.") == 0x1fbd12376ad982dbULL);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hash: no collisions and good avalanche")
+    {
+        std::unordered_set<std::uint64_t> hashes;
+        std::set<unsigned __int128> hashes128;
+        for(int i(0); i < 100'000; ++i)
+        {
+            std::string const key("key" + std::to_string(i));
+            CATCH_REQUIRE(hashes.insert(snapdev::hash64(key)).second);
+            CATCH_REQUIRE(hashes128.insert(snapdev::hash128(key)).second);
+        }
+
+        // flipping any one bit of the input changes about half the bits
+        //
+        for(std::size_t size : { 3, 8, 16, 40, 100 })
+        {
+            std::string data(SNAP_CATCH2_NAMESPACE::random_bytes(size));
+            std::uint64_t const h(snapdev::hash64(data));
+            std::size_t total(0);
+            for(std::size_t bit(0); bit < size * 8; ++bit)
+            {
+                data[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+                total += __builtin_popcountll(snapdev::hash64(data) ^ h);
+                data[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            }
+            double const average(static_cast<double>(total) / static_cast<double>(size * 8));
+            CATCH_REQUIRE(average > 28.0);
+            CATCH_REQUIRE(average < 36.0);
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("hash_benchmark", "[.][math][hash][benchmark]")
+{
+    CATCH_START_SECTION("hash_benchmark: hash64() against std::hash<std::string>")
+    {
+        for(std::size_t size : { 8, 32, 256, 4096 })
+        {
+            std::vector<std::string> strings;
+            for(int i(0); i < 256; ++i)
+            {
+                strings.push_back(SNAP_CATCH2_NAMESPACE::random_bytes(size));
+            }
+            std::size_t const count(std::max(static_cast<std::size_t>(1'000), (8UL << 20) / size));
+
+            std::uint64_t std_sum(0);
+            auto const std_start(std::chrono::steady_clock::now());
+            for(std::size_t i(0); i < count; ++i)
+            {
+                std_sum += std::hash<std::string>()(strings[i & 255]);
+            }
+            auto const std_end(std::chrono::steady_clock::now());
+
+            std::uint64_t snap_sum(0);
+            auto const snap_start(std::chrono::steady_clock::now());
+            for(std::size_t i(0); i < count; ++i)
+            {
+                snap_sum += snapdev::hash64(strings[i & 255]);
+            }
+            auto const snap_end(std::chrono::steady_clock::now());
+
+            std::chrono::duration<double, std::nano> const std_duration(std_end - std_start);
+            std::chrono::duration<double, std::nano> const snap_duration(snap_end - snap_start);
+            std::cout << "--- hash of " << std::setw(4) << size << " bytes: std::hash "
+                      << std::fixed << std::setprecision(1) << std_duration.count() / count
+                      << " ns, hash64() " << snap_duration.count() / count
+                      << " ns (sums: " << std_sum << " / " << snap_sum << ")\n";
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
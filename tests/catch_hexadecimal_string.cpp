@@ -35,6 +35,7 @@
 //
 #include    <iomanip>
 #include    <set>
+#include    <vector>
 
 
 // last include
@@ -242,6 +243,76 @@ CATCH_TEST_CASE("hexadecimal_string_16_bit_values", "[hexadecimal][string]")
 }
 
 
+CATCH_TEST_CASE("hexadecimal_string_buffers", "[hexadecimal][string]")
+{
+    CATCH_START_SECTION("hexadecimal_string: bin_to_hex & hex_to_bin with spans and buffers of all sizes")
+    {
+        for(std::size_t size(0); size < 100; ++size)
+        {
+            std::vector<std::uint8_t> bin(size);
+            std::string expected;
+            std::string expected_upper;
+            for(std::size_t idx(0); idx < size; ++idx)
+            {
+                bin[idx] = rand();
+                std::stringstream ss;
+                ss << std::setw(2) << std::setfill('0') << std::hex << static_cast<int>(bin[idx]);
+                expected += ss.str();
+                std::stringstream su;
+                su << std::setw(2) << std::setfill('0') << std::hex << std::uppercase << static_cast<int>(bin[idx]);
+                expected_upper += su.str();
+            }
+
+            CATCH_REQUIRE(snapdev::bin_to_hex(bin) == expected);
+            CATCH_REQUIRE(snapdev::bin_to_hex(bin, true) == expected_upper);
+            CATCH_REQUIRE(snapdev::bin_to_hex(std::string(bin.begin(), bin.end())) == expected);
+
+            char buf[200];
+            CATCH_REQUIRE(snapdev::bin_to_hex(bin, buf, true) == buf + size * 2);
+            CATCH_REQUIRE(std::string(buf, size * 2) == expected_upper);
+
+            std::uint8_t out[100];
+            CATCH_REQUIRE(snapdev::hex_to_bin(expected, out) == out + size);
+            CATCH_REQUIRE(std::vector<std::uint8_t>(out, out + size) == bin);
+            CATCH_REQUIRE(snapdev::hex_to_bin(expected_upper, out) == out + size);
+            CATCH_REQUIRE(std::vector<std::uint8_t>(out, out + size) == bin);
+            CATCH_REQUIRE(snapdev::hex_to_bin(expected) == std::string(bin.begin(), bin.end()));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hexadecimal_string: invalid digit at any position of a long string")
+    {
+        std::string const valid("0123456789abcdefABCDEF0123456789abcdefABCDEF0123456789");
+        char const invalid[] = { 'g', 'G', '/', ':', '@', '`', ' ' };
+        for(std::size_t pos(0); pos < valid.length(); ++pos)
+        {
+            for(auto const c : invalid)
+            {
+                std::string hex(valid);
+                hex[pos] = c;
+                CATCH_REQUIRE_THROWS_MATCHES(
+                          snapdev::hex_to_bin(hex)
+                        , snapdev::hexadecimal_string_invalid_parameter
+                        , Catch::Matchers::ExceptionMessage(
+                                    std::string("hexadecimal_string_exception: input character '")
+                                  + c
+                                  + "' is not an hexadecimal digit."));
+            }
+
+            std::string hex(valid);
+            hex[pos] = '\xE9';
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      snapdev::hex_to_bin(hex)
+                    , snapdev::hexadecimal_string_invalid_parameter
+                    , Catch::Matchers::ExceptionMessage(
+                                "hexadecimal_string_exception: input character is not an hexadecimal digit."));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
 CATCH_TEST_CASE("hexadecimal_string_invalid_input", "[hexadecimal][string][error]")
 {
     CATCH_START_SECTION("hexadecimal_string: invalid length")
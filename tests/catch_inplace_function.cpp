@@ -0,0 +1,222 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the inplace_function class.
+ *
+ * This file implements tests for the inplace_function class and its use
+ * as the callback type of a callback_manager.
+ */
+
+// self
+//
+#include    <snapdev/inplace_function.h>
+
+#include    <snapdev/callback_manager.h>
+
+#include    "catch_main.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+/** \brief Count the number of copies and live objects.
+ */
+struct counter
+{
+    counter(int & live, int & copies)
+        : f_live(&live)
+        , f_copies(&copies)
+    {
+        ++*f_live;
+    }
+
+    counter(counter const & rhs)
+        : f_live(rhs.f_live)
+        , f_copies(rhs.f_copies)
+    {
+        ++*f_live;
+        ++*f_copies;
+    }
+
+    ~counter()
+    {
+        --*f_live;
+    }
+
+    int * f_live = nullptr;
+    int * f_copies = nullptr;
+};
+
+
+int add(int a, int b)
+{
+    return a + b;
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("inplace_function", "[callback]")
+{
+    CATCH_START_SECTION("inplace_function: call functions and lambdas")
+    {
+        snapdev::inplace_function<int(int, int)> f;
+        CATCH_REQUIRE_FALSE(f);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  f(1, 2)
+                , std::bad_function_call
+                , Catch::Matchers::ExceptionMessage("bad_function_call"));
+
+        f = add;
+        CATCH_REQUIRE(f);
+        CATCH_REQUIRE(f(3, 4) == 7);
+
+        int total(0);
+        f = [&total](int a, int b)
+            {
+                total += a * b;
+                return total;
+            };
+        CATCH_REQUIRE(f(3, 4) == 12);
+        CATCH_REQUIRE(f(2, 2) == 16);
+
+        // a mutable lambda keeps its state in the buffer
+        //
+        snapdev::inplace_function<int()> next([n = 0]() mutable
+            {
+                return ++n;
+            });
+        CATCH_REQUIRE(next() == 1);
+        CATCH_REQUIRE(next() == 2);
+        snapdev::inplace_function<int()> copy(next);
+        CATCH_REQUIRE(copy() == 3);
+        CATCH_REQUIRE(next() == 3);
+
+        snapdev::inplace_function<void(std::string &)> append([](std::string & s)
+            {
+                s += "!";
+            });
+        std::string s("hi");
+        append(s);
+        CATCH_REQUIRE(s == "hi!");
+
+        f = nullptr;
+        CATCH_REQUIRE_FALSE(f);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("inplace_function: copy, move, and destroy the callable")
+    {
+        int live(0);
+        int copies(0);
+        {
+            counter c(live, copies);
+            snapdev::inplace_function<int(), 64> f([c]()
+                {
+                    return *c.f_live;
+                });
+            CATCH_REQUIRE(live == 2);
+            CATCH_REQUIRE(f() == 2);
+
+            snapdev::inplace_function<int(), 64> g(f);
+            CATCH_REQUIRE(live == 3);
+
+            snapdev::inplace_function<int(), 64> h(std::move(g));
+            CATCH_REQUIRE(live == 4);
+
+            g = nullptr;
+            CATCH_REQUIRE(live == 3);
+
+            g.swap(h);
+            CATCH_REQUIRE(live == 3);
+            CATCH_REQUIRE_FALSE(h);
+            CATCH_REQUIRE(g() == 3);
+
+            f = g;
+            CATCH_REQUIRE(live == 3);
+        }
+        CATCH_REQUIRE(live == 0);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("inplace_function_callback_manager", "[callback]")
+{
+    CATCH_START_SECTION("inplace_function_callback_manager: arguments are not copied")
+    {
+        typedef snapdev::inplace_function<bool(counter const &, std::string &)> callback_t;
+
+        snapdev::callback_manager<callback_t> m;
+        int calls(0);
+        for(int i(0); i < 5; ++i)
+        {
+            m.add_callback([&calls, i](counter const & c, std::string & log)
+                {
+                    ++calls;
+                    log += std::to_string(i);
+                    return *c.f_live == 1;
+                });
+        }
+
+        int live(0);
+        int copies(0);
+        counter const c(live, copies);
+        std::string log;
+        CATCH_REQUIRE(m.call(c, log));
+        CATCH_REQUIRE(calls == 5);
+        CATCH_REQUIRE(copies == 0);
+        CATCH_REQUIRE(log == "01234");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("inplace_function_callback_manager: member functions with forwarded arguments")
+    {
+        struct object
+        {
+            bool on_event(std::string const & name, int & count)
+            {
+                count += static_cast<int>(name.length());
+                return true;
+            }
+        };
+
+        snapdev::callback_manager<std::shared_ptr<object>> m;
+        m.add_callback(std::make_shared<object>());
+        m.add_callback(std::make_shared<object>());
+
+        int count(0);
+        CATCH_REQUIRE(m.call(&object::on_event, std::string("event"), count));
+        CATCH_REQUIRE(count == 10);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
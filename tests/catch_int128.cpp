@@ -22,6 +22,7 @@
  * This file implements tests to verify:
  *
  * * support printing out 128 bit numbers
+ * * support parsing 128 bit numbers
  * * support of 128 bit literals
  * * support of 128 bit powers
  */
@@ -39,6 +40,11 @@
 #include    <snapdev/math.h>
 
 
+// C++
+//
+#include    <iomanip>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -48,6 +54,49 @@
 #pragma GCC diagnostic ignored "-Wpedantic"
 
 
+
+namespace
+{
+
+
+unsigned __int128 random_uint128()
+{
+    return (static_cast<unsigned __int128>(SNAP_CATCH2_NAMESPACE::rand_int64()) << 64)
+         ^ static_cast<std::uint64_t>(SNAP_CATCH2_NAMESPACE::rand_int64());
+}
+
+
+// the straightforward one digit at a time conversion
+//
+std::string slow_uint128_to_string(unsigned __int128 value, int base, bool uppercase = false)
+{
+    char const * digits(uppercase
+                ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                : "0123456789abcdefghijklmnopqrstuvwxyz");
+    std::string result;
+    do
+    {
+        result.insert(result.begin(), digits[static_cast<int>(value % base)]);
+        value /= base;
+    }
+    while(value != 0);
+    return result;
+}
+
+
+std::string slow_int128_to_string(__int128 value, int base, bool uppercase = false)
+{
+    if(value < 0)
+    {
+        return '-' + slow_uint128_to_string(-static_cast<unsigned __int128>(value), base, uppercase);
+    }
+    return slow_uint128_to_string(value, base, uppercase);
+}
+
+
+} // no name namespace
+
+
 CATCH_TEST_CASE("ostream_int128", "[stream][int128]")
 {
     CATCH_START_SECTION("ostream_int128: small numbers (-10 to +10)")
@@ -193,6 +242,22 @@ CATCH_TEST_CASE("ostream_int128", "[stream][int128]")
     }
     CATCH_END_SECTION()
 
+    CATCH_START_SECTION("ostream_int128: width and fill")
+    {
+        __int128 const l(-1234);
+        {
+            std::stringstream ss;
+            ss << std::setw(8) << std::setfill('.') << l;
+            CATCH_REQUIRE(ss.str() == "...-1234");
+        }
+        {
+            std::stringstream ss;
+            ss << std::left << std::setw(8) << std::setfill('.') << std::hex << std::showbase << static_cast<unsigned __int128>(255);
+            CATCH_REQUIRE(ss.str() == "0xff....");
+        }
+    }
+    CATCH_END_SECTION()
+
     CATCH_START_SECTION("ostream_int128: most negative number")
     {
         __int128 l(1);
@@ -212,6 +277,318 @@ CATCH_TEST_CASE("ostream_int128", "[stream][int128]")
 }
 
 
+CATCH_TEST_CASE("int128_to_chars", "[string][int128]")
+{
+    CATCH_START_SECTION("int128_to_chars: random numbers in all bases")
+    {
+        for(int base(2); base <= 36; ++base)
+        {
+            for(int i(0); i < 200; ++i)
+            {
+                unsigned __int128 u(random_uint128());
+                u >>= rand() % 128;
+                __int128 const s(static_cast<__int128>(random_uint128()) >> (rand() % 128));
+                bool const uppercase((i & 1) != 0);
+
+                CATCH_REQUIRE(snapdev::to_string(u, base, uppercase) == slow_uint128_to_string(u, base, uppercase));
+                CATCH_REQUIRE(snapdev::to_string(s, base, uppercase) == slow_int128_to_string(s, base, uppercase));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_to_chars: chunk boundaries in base 10")
+    {
+        // 10^19 and 10^38 are the boundaries of the 64 bit chunks
+        //
+        unsigned __int128 power(1);
+        for(int p(0); p <= 38; ++p)
+        {
+            for(int delta(-1); delta <= 1; ++delta)
+            {
+                unsigned __int128 const v(power + delta);
+                CATCH_REQUIRE(snapdev::to_string(v) == slow_uint128_to_string(v, 10));
+                CATCH_REQUIRE(snapdev::to_string(static_cast<__int128>(v)) == slow_int128_to_string(v, 10));
+                CATCH_REQUIRE(snapdev::to_string(-static_cast<__int128>(v)) == slow_int128_to_string(-static_cast<__int128>(v), 10));
+            }
+            power *= 10;
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_to_chars: limits")
+    {
+        unsigned __int128 const largest(~static_cast<unsigned __int128>(0));
+        __int128 const smallest(static_cast<__int128>(static_cast<unsigned __int128>(1) << 127));
+        __int128 const positive(static_cast<__int128>(largest >> 1));
+
+        CATCH_REQUIRE(snapdev::to_string(largest) == "340282366920938463463374607431768211455");
+        CATCH_REQUIRE(snapdev::to_string(smallest) == "-170141183460469231731687303715884105728");
+        CATCH_REQUIRE(snapdev::to_string(positive) == "170141183460469231731687303715884105727");
+        CATCH_REQUIRE(snapdev::to_string(largest, 2) == std::string(128, '1'));
+        CATCH_REQUIRE(snapdev::to_string(smallest, 2) == '-' + std::string("1") + std::string(127, '0'));
+        CATCH_REQUIRE(snapdev::to_string(largest, 36) == "f5lxx1zz5pnorynqglhzmsp33");
+        CATCH_REQUIRE(snapdev::to_string(largest, 36, true) == "F5LXX1ZZ5PNORYNQGLHZMSP33");
+        CATCH_REQUIRE(snapdev::to_string(static_cast<__int128>(0)) == "0");
+        CATCH_REQUIRE(snapdev::to_string(static_cast<unsigned __int128>(0), 7) == "0");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_to_chars: caller buffer")
+    {
+        char buf[snapdev::int128_to_chars_max_size];
+        __int128 const v(-1234567890);
+        char * end(snapdev::int128_to_chars(buf, buf + sizeof(buf), v));
+        CATCH_REQUIRE(std::string(buf, end) == "-1234567890");
+
+        // exactly the right size
+        //
+        end = snapdev::int128_to_chars(buf, buf + 11, v);
+        CATCH_REQUIRE(end == buf + 11);
+
+        // one too small
+        //
+        CATCH_REQUIRE(snapdev::int128_to_chars(buf, buf + 10, v) == nullptr);
+        CATCH_REQUIRE(snapdev::int128_to_chars(buf, buf + 1, static_cast<unsigned __int128>(10)) == nullptr);
+
+        unsigned __int128 const largest(~static_cast<unsigned __int128>(0));
+        end = snapdev::int128_to_chars(buf, buf + sizeof(buf), largest, 16, true);
+        CATCH_REQUIRE(std::string(buf, end) == std::string(32, 'F'));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_to_chars: invalid base")
+    {
+        char buf[snapdev::int128_to_chars_max_size];
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::int128_to_chars(buf, buf + sizeof(buf), static_cast<__int128>(5), 1)
+                , std::range_error
+                , Catch::Matchers::ExceptionMessage("base is out of range in int128_to_chars()."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::to_string(static_cast<unsigned __int128>(5), 37)
+                , std::range_error
+                , Catch::Matchers::ExceptionMessage("base is out of range in int128_to_chars()."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("int128_from_chars", "[string][int128]")
+{
+    CATCH_START_SECTION("int128_from_chars: round trip in all bases")
+    {
+        for(int base(2); base <= 36; ++base)
+        {
+            for(int i(0); i < 200; ++i)
+            {
+                unsigned __int128 const u(random_uint128() >> (rand() % 128));
+                __int128 const s(static_cast<__int128>(random_uint128()) >> (rand() % 128));
+
+                std::string const us(snapdev::to_string(u, base, (i & 1) != 0));
+                unsigned __int128 ur(0);
+                std::from_chars_result r(snapdev::int128_from_chars(us.data(), us.data() + us.length(), ur, base));
+                CATCH_REQUIRE(r.ec == std::errc());
+                CATCH_REQUIRE(r.ptr == us.data() + us.length());
+                CATCH_REQUIRE(ur == u);
+
+                std::string const ss(snapdev::to_string(s, base));
+                __int128 sr(0);
+                r = snapdev::int128_from_chars(ss.data(), ss.data() + ss.length(), sr, base);
+                CATCH_REQUIRE(r.ec == std::errc());
+                CATCH_REQUIRE(r.ptr == ss.data() + ss.length());
+                CATCH_REQUIRE(sr == s);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_from_chars: limits and overflow")
+    {
+        unsigned __int128 const largest(~static_cast<unsigned __int128>(0));
+        __int128 const smallest(static_cast<__int128>(static_cast<unsigned __int128>(1) << 127));
+        __int128 const positive(static_cast<__int128>(largest >> 1));
+
+        std::string str("340282366920938463463374607431768211455");
+        unsigned __int128 u(0);
+        std::from_chars_result r(snapdev::int128_from_chars(str.data(), str.data() + str.length(), u));
+        CATCH_REQUIRE(r.ec == std::errc());
+        CATCH_REQUIRE(u == largest);
+
+        str = "340282366920938463463374607431768211456";
+        u = 123;
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), u);
+        CATCH_REQUIRE(r.ec == std::errc::result_out_of_range);
+        CATCH_REQUIRE(r.ptr == str.data() + str.length());
+        CATCH_REQUIRE(u == 123);
+
+        str = "1" + std::string(129, '0') + "xyz";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), u, 2);
+        CATCH_REQUIRE(r.ec == std::errc::result_out_of_range);
+        CATCH_REQUIRE(r.ptr == str.data() + 130);
+
+        __int128 s(0);
+        str = "-170141183460469231731687303715884105728";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), s);
+        CATCH_REQUIRE(r.ec == std::errc());
+        CATCH_REQUIRE(s == smallest);
+
+        str = "-170141183460469231731687303715884105729";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), s);
+        CATCH_REQUIRE(r.ec == std::errc::result_out_of_range);
+        CATCH_REQUIRE(s == smallest);
+
+        str = "170141183460469231731687303715884105727";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), s);
+        CATCH_REQUIRE(r.ec == std::errc());
+        CATCH_REQUIRE(s == positive);
+
+        str = "170141183460469231731687303715884105728";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), s);
+        CATCH_REQUIRE(r.ec == std::errc::result_out_of_range);
+        CATCH_REQUIRE(s == positive);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_from_chars: stops on invalid characters")
+    {
+        std::string str("1234 rest");
+        __int128 s(0);
+        std::from_chars_result r(snapdev::int128_from_chars(str.data(), str.data() + str.length(), s));
+        CATCH_REQUIRE(r.ec == std::errc());
+        CATCH_REQUIRE(r.ptr == str.data() + 4);
+        CATCH_REQUIRE(s == 1234);
+
+        str = "-FfZ";
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), s, 16);
+        CATCH_REQUIRE(r.ec == std::errc());
+        CATCH_REQUIRE(r.ptr == str.data() + 3);
+        CATCH_REQUIRE(s == -255);
+
+        for(char const * invalid : { "", "-", "+1", " 1", "z", "-x" })
+        {
+            s = 77;
+            unsigned __int128 u(77);
+            char const * end(invalid + strlen(invalid));
+            r = snapdev::int128_from_chars(invalid, end, s);
+            CATCH_REQUIRE(r.ec == std::errc::invalid_argument);
+            CATCH_REQUIRE(r.ptr == invalid);
+            CATCH_REQUIRE(s == 77);
+            r = snapdev::int128_from_chars(invalid, end, u);
+            CATCH_REQUIRE(r.ec == std::errc::invalid_argument);
+            CATCH_REQUIRE(r.ptr == invalid);
+            CATCH_REQUIRE(u == 77);
+        }
+
+        // the unsigned version does not accept a sign
+        //
+        str = "-1";
+        unsigned __int128 u(0);
+        r = snapdev::int128_from_chars(str.data(), str.data() + str.length(), u);
+        CATCH_REQUIRE(r.ec == std::errc::invalid_argument);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("int128_from_chars: invalid base")
+    {
+        char const * str("10");
+        __int128 s(0);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::int128_from_chars(str, str + 2, s, 0)
+                , std::range_error
+                , Catch::Matchers::ExceptionMessage("base is out of range in int128_from_chars()."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("istream_int128", "[stream][int128]")
+{
+    CATCH_START_SECTION("istream_int128: read numbers in all stream bases")
+    {
+        std::stringstream ss("  12345 -987654321098765432109876543210 0x1f ff 0777 -0X10 017");
+        __int128 s(0);
+        unsigned __int128 u(0);
+
+        ss >> s;
+        CATCH_REQUIRE(s == 12345);
+        ss >> s;
+        CATCH_REQUIRE(snapdev::to_string(s) == "-987654321098765432109876543210");
+        ss >> std::hex >> u;
+        CATCH_REQUIRE(u == 0x1f);
+        ss >> u;
+        CATCH_REQUIRE(u == 0xff);
+        ss >> std::oct >> s;
+        CATCH_REQUIRE(s == 0777);
+        ss.unsetf(std::ios_base::basefield);
+        ss >> s;
+        CATCH_REQUIRE(s == -16);
+        ss >> s;
+        CATCH_REQUIRE(s == 017);
+        CATCH_REQUIRE(ss.eof());
+        CATCH_REQUIRE_FALSE(ss.fail());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("istream_int128: round trip with ostream")
+    {
+        for(int i(0); i < 1000; ++i)
+        {
+            __int128 const s(static_cast<__int128>(random_uint128()));
+            unsigned __int128 const u(random_uint128());
+
+            std::stringstream ss;
+            ss << s << ' ' << u;
+            __int128 sr(0);
+            unsigned __int128 ur(0);
+            ss >> sr >> ur;
+            CATCH_REQUIRE(sr == s);
+            CATCH_REQUIRE(ur == u);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("istream_int128: errors")
+    {
+        {
+            std::stringstream ss("abc");
+            __int128 s(55);
+            ss >> s;
+            CATCH_REQUIRE(ss.fail());
+            CATCH_REQUIRE(s == 0);
+        }
+        {
+            std::stringstream ss("-5");
+            unsigned __int128 u(55);
+            ss >> u;
+            CATCH_REQUIRE(ss.fail());
+            CATCH_REQUIRE(u == 0);
+        }
+        {
+            std::stringstream ss("340282366920938463463374607431768211456");
+            unsigned __int128 u(0);
+            ss >> u;
+            CATCH_REQUIRE(ss.fail());
+            CATCH_REQUIRE(u == ~static_cast<unsigned __int128>(0));
+        }
+        {
+            std::stringstream ss("-170141183460469231731687303715884105729");
+            __int128 s(0);
+            ss >> s;
+            CATCH_REQUIRE(ss.fail());
+            CATCH_REQUIRE(s == static_cast<__int128>(static_cast<unsigned __int128>(1) << 127));
+        }
+        {
+            std::stringstream ss("170141183460469231731687303715884105728");
+            __int128 s(0);
+            ss >> s;
+            CATCH_REQUIRE(ss.fail());
+            CATCH_REQUIRE(s == static_cast<__int128>(~static_cast<unsigned __int128>(0) >> 1));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
 CATCH_TEST_CASE("int128_literal", "[literal][int128]")
 {
     CATCH_START_SECTION("int128_literal: zero and powers of two")
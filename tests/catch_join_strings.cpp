@@ -37,6 +37,18 @@
 #include    "catch_main.h"
 
 
+// C++
+//
+#include    <fstream>
+#include    <list>
+#include    <sstream>
+
+
+// C
+//
+#include    <fcntl.h>
+
+
 
 namespace
 {
@@ -126,4 +138,92 @@ CATCH_TEST_CASE("join_strings", "[string]")
 }
 
 
+CATCH_TEST_CASE("join_strings_streaming", "[string]")
+{
+    CATCH_START_SECTION("join_strings_streaming: join strings in an ostream")
+    {
+        std::vector<std::string> const list = { "Item 1", "Item 2", "Item 3" };
+        std::stringstream ss;
+        CATCH_REQUIRE(&snapdev::join_strings(ss, list, ", ") == &ss);
+        CATCH_REQUIRE(ss.str() == "Item 1, Item 2, Item 3");
+        CATCH_REQUIRE(snapdev::join_strings_size(list, ", ") == ss.str().length());
+
+        std::stringstream empty;
+        snapdev::join_strings(empty, std::vector<std::string>(), ", ");
+        CATCH_REQUIRE(empty.str().empty());
+        CATCH_REQUIRE(snapdev::join_strings_size(std::vector<std::string>(), ", ") == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("join_strings_streaming: join strings with an output iterator")
+    {
+        std::list<std::string_view> const list = { "a", "bc", "", "def" };
+        std::string result;
+        snapdev::join_strings_to(std::back_inserter(result), list, std::string_view("/"));
+        CATCH_REQUIRE(result == "a/bc//def");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("join_strings_streaming: join strings in a caller buffer")
+    {
+        std::vector<std::string> const list = { "127.0.0.1", "4040" };
+        std::size_t const size(snapdev::join_strings_size(list, ":"));
+        CATCH_REQUIRE(size == 14);
+
+        char buffer[32];
+        char * end(snapdev::join_strings_to(buffer, list, ":"));
+        CATCH_REQUIRE(end == buffer + size);
+        CATCH_REQUIRE(std::string(buffer, end) == snapdev::join_strings(list, ":"));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("join_strings_iovec", "[string]")
+{
+    CATCH_START_SECTION("join_strings_iovec: describe the joined strings with iovec")
+    {
+        std::vector<std::string> const list = { "Item 1", "", "Item 3" };
+        snapdev::join_strings_iovec const v(list, ", ");
+        CATCH_REQUIRE(v.size() == 4);   // the empty token is skipped
+        CATCH_REQUIRE(v.total_size() == snapdev::join_strings(list, std::string(", ")).length());
+        CATCH_REQUIRE(v.data()[0].iov_base == list[0].data());
+        CATCH_REQUIRE(v.data()[0].iov_len == list[0].length());
+
+        snapdev::join_strings_iovec const e(std::vector<std::string>(), ", ");
+        CATCH_REQUIRE(e.size() == 0);
+        CATCH_REQUIRE(e.total_size() == 0);
+
+        // the separator is not copied so a temporary string is refused
+        //
+        static_assert(!std::is_constructible_v<snapdev::join_strings_iovec, std::vector<std::string> const &, std::string>);
+        static_assert(std::is_constructible_v<snapdev::join_strings_iovec, std::vector<std::string> const &, std::string const &>);
+        static_assert(std::is_constructible_v<snapdev::join_strings_iovec, std::vector<std::string> const &, char const *>);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("join_strings_iovec: write more than IOV_MAX strings to a file")
+    {
+        std::vector<std::string> list;
+        for(int idx(0); idx < IOV_MAX * 2 + 7; ++idx)
+        {
+            list.push_back(std::to_string(idx));
+        }
+        std::string const expected(snapdev::join_strings(list, std::string("\n")));
+        snapdev::join_strings_iovec const v(list, "\n");
+
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/join_strings_iovec.txt");
+        int const fd(open(filename.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600));
+        CATCH_REQUIRE(fd != -1);
+        CATCH_REQUIRE(v.write(fd) == static_cast<ssize_t>(expected.length()));
+        close(fd);
+
+        std::ifstream in(filename);
+        std::string const written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CATCH_REQUIRE(written == expected);
+    }
+    CATCH_END_SECTION()
+}
+
+
 // vim: ts=4 sw=4 et
@@ -97,6 +97,18 @@ inline std::int64_t rand_int64()
 }
 
 
+inline std::string random_bytes(std::size_t size)
+{
+    std::string result;
+    result.reserve(size);
+    for(std::size_t idx(0); idx < size; ++idx)
+    {
+        result += static_cast<char>(rand());
+    }
+    return result;
+}
+
+
 
 }
 // unittest namespace
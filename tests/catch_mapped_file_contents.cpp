@@ -0,0 +1,164 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify that the mapped_file_contents class works.
+ *
+ * This file implements tests for the mapped_file_contents class, with
+ * regular files which get mapped and "/proc" files which get read.
+ */
+
+// self
+//
+#include    <snapdev/mapped_file_contents.h>
+
+#include    "catch_main.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+
+CATCH_TEST_CASE("mapped_file_contents", "[os]")
+{
+    CATCH_START_SECTION("mapped_file_contents: map a regular file")
+    {
+        std::string content;
+        for(int i(0); i < 100'000; ++i)
+        {
+            content += static_cast<char>(rand());
+        }
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/mapped/large.bin");
+        {
+            snapdev::file_contents out(filename, true);
+            out.contents(content);
+            CATCH_REQUIRE(out.write_all());
+        }
+
+        snapdev::mapped_file_contents in(filename);
+        CATCH_REQUIRE(in.filename() == filename);
+        CATCH_REQUIRE_FALSE(in.is_mapped());
+        CATCH_REQUIRE(in.empty());
+        CATCH_REQUIRE_FALSE(in.advise(snapdev::mapped_file_contents::ADVICE_RANDOM));
+
+        CATCH_REQUIRE(in.read_all(
+                  snapdev::mapped_file_contents::ADVICE_SEQUENTIAL
+                | snapdev::mapped_file_contents::ADVICE_WILLNEED
+                | snapdev::mapped_file_contents::ADVICE_HUGEPAGES));
+        CATCH_REQUIRE(in.is_mapped());
+        CATCH_REQUIRE(in.size() == content.size());
+        CATCH_REQUIRE(in.contents() == content);
+        CATCH_REQUIRE(in.data().size() == content.size());
+        CATCH_REQUIRE(memcmp(in.data().data(), content.data(), content.size()) == 0);
+        CATCH_REQUIRE(in.advise(snapdev::mapped_file_contents::ADVICE_RANDOM));
+
+        snapdev::mapped_file_contents moved(std::move(in));
+        CATCH_REQUIRE(moved.is_mapped());
+        CATCH_REQUIRE(moved.contents() == content);
+        CATCH_REQUIRE_FALSE(in.is_mapped());
+        CATCH_REQUIRE(in.empty());
+
+        moved.unmap();
+        CATCH_REQUIRE_FALSE(moved.is_mapped());
+        CATCH_REQUIRE(moved.contents().empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("mapped_file_contents: empty file")
+    {
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/mapped/empty.txt");
+        {
+            snapdev::file_contents out(filename, true);
+            CATCH_REQUIRE(out.write_all());
+        }
+
+        snapdev::mapped_file_contents in(filename);
+        CATCH_REQUIRE(in.read_all());
+        CATCH_REQUIRE_FALSE(in.is_mapped());
+        CATCH_REQUIRE(in.empty());
+        CATCH_REQUIRE(in.last_error().empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("mapped_file_contents: /proc files are read")
+    {
+        snapdev::file_contents comm("/proc/self/comm");
+        comm.size_mode(snapdev::file_contents::size_mode_t::SIZE_MODE_READ);
+        CATCH_REQUIRE(comm.read_all());
+
+        snapdev::mapped_file_contents in("/proc/self/comm");
+        CATCH_REQUIRE(in.read_all(snapdev::mapped_file_contents::ADVICE_SEQUENTIAL));
+        CATCH_REQUIRE_FALSE(in.is_mapped());
+        CATCH_REQUIRE_FALSE(in.empty());
+        CATCH_REQUIRE(in.contents() == comm.contents());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("mapped_file_contents: move assignment")
+    {
+        std::string const content("short file to be mapped\n");
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/mapped/short.txt");
+        {
+            snapdev::file_contents out(filename, true);
+            out.contents(content);
+            CATCH_REQUIRE(out.write_all());
+        }
+
+        snapdev::mapped_file_contents a(filename);
+        CATCH_REQUIRE(a.read_all());
+        snapdev::mapped_file_contents b("/proc/self/comm");
+        CATCH_REQUIRE(b.read_all());
+
+        b = std::move(a);
+        CATCH_REQUIRE(b.is_mapped());
+        CATCH_REQUIRE(b.filename() == filename);
+        CATCH_REQUIRE(b.contents() == content);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("mapped_file_contents_errors", "[os]")
+{
+    CATCH_START_SECTION("mapped_file_contents_errors: empty filename is not accepted")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::mapped_file_contents(std::string())
+                , std::invalid_argument
+                , Catch::Matchers::ExceptionMessage(
+                          "snapdev::mapped_file_contents: the filename of a mapped_file_contents object cannot be the empty string."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("mapped_file_contents_errors: missing file")
+    {
+        std::string const filename(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/mapped/missing.txt");
+        snapdev::mapped_file_contents in(filename);
+        CATCH_REQUIRE_FALSE(in.read_all());
+        CATCH_REQUIRE_FALSE(in.is_mapped());
+        CATCH_REQUIRE(in.last_error() == "could not open file \"" + filename + "\" for reading.");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -24,6 +24,7 @@
  * The supported functions are:
  *
  * \li integer_to_string()
+ * \li integer_to_chars()
  */
 
 // self
@@ -37,6 +38,11 @@
 #include    <snapdev/number_to_string.h>
 
 
+// C++
+//
+#include    <limits>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -46,6 +52,39 @@
 #pragma GCC diagnostic ignored "-Wpedantic"
 
 
+
+namespace
+{
+
+
+// the simplest possible implementation, used as a reference
+//
+template<typename T>
+std::string slow_integer_to_string(T value, int base, bool uppercase)
+{
+    typedef std::make_unsigned_t<T> unsigned_t;
+    bool const neg(value < 0);
+    unsigned_t u(neg ? -static_cast<unsigned_t>(value) : static_cast<unsigned_t>(value));
+    std::string result;
+    do
+    {
+        int const digit(u % base);
+        result.insert(result.begin(), static_cast<char>(digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10));
+        u /= base;
+    }
+    while(u != 0);
+    if(neg)
+    {
+        result.insert(result.begin(), '-');
+    }
+    return result;
+}
+
+
+} // no name namespace
+
+
+
 CATCH_TEST_CASE("number_to_string(int)", "[string]")
 {
     CATCH_START_SECTION("number_to_string(int): convert integers (int) to a string")
@@ -97,5 +136,93 @@ CATCH_TEST_CASE("number_to_string(int)", "[string]")
 }
 
 
+CATCH_TEST_CASE("number_to_string(all bases)", "[string]")
+{
+    CATCH_START_SECTION("number_to_string(all bases): convert 64 bit integers in all bases")
+    {
+        for(int i(0); i < 1000; ++i)
+        {
+            std::int64_t const n(SNAP_CATCH2_NAMESPACE::rand_int64() >> (rand() % 64));
+            std::uint64_t const u(static_cast<std::uint64_t>(SNAP_CATCH2_NAMESPACE::rand_int64()) >> (rand() % 64));
+            for(int base(2); base <= 36; ++base)
+            {
+                CATCH_REQUIRE(snapdev::integer_to_string(n, base) == slow_integer_to_string(n, base, false));
+                CATCH_REQUIRE(snapdev::integer_to_string(n, base, true) == slow_integer_to_string(n, base, true));
+                CATCH_REQUIRE(snapdev::integer_to_string(u, base) == slow_integer_to_string(u, base, false));
+            }
+            CATCH_REQUIRE(snapdev::integer_to_string(n) == std::to_string(n));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("number_to_string(all bases): limits")
+    {
+        for(int base(2); base <= 36; ++base)
+        {
+            CATCH_REQUIRE(snapdev::integer_to_string(0, base) == "0");
+            CATCH_REQUIRE(snapdev::integer_to_string(std::numeric_limits<std::int8_t>::min(), base)
+                    == slow_integer_to_string(std::numeric_limits<std::int8_t>::min(), base, false));
+            CATCH_REQUIRE(snapdev::integer_to_string(std::numeric_limits<std::int64_t>::min(), base)
+                    == slow_integer_to_string(std::numeric_limits<std::int64_t>::min(), base, false));
+            CATCH_REQUIRE(snapdev::integer_to_string(std::numeric_limits<std::uint64_t>::max(), base)
+                    == slow_integer_to_string(std::numeric_limits<std::uint64_t>::max(), base, false));
+        }
+        CATCH_REQUIRE(snapdev::integer_to_string(std::numeric_limits<std::int64_t>::min())
+                    == "-9223372036854775808");
+        CATCH_REQUIRE(snapdev::integer_to_string(std::numeric_limits<std::int64_t>::min(), 2)
+                    == "-1" + std::string(63, '0'));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("number_to_string(all bases): invalid base")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::integer_to_string(123, 1)
+                , std::range_error
+                , Catch::Matchers::ExceptionMessage(
+                          "base is out of range in integer_to_string()"));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::integer_to_string(123, 37)
+                , std::range_error
+                , Catch::Matchers::ExceptionMessage(
+                          "base is out of range in integer_to_string()"));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("integer_to_chars", "[string]")
+{
+    CATCH_START_SECTION("integer_to_chars: write to a caller buffer")
+    {
+        char buf[snapdev::integer_to_chars_max_size<int>];
+        char * end(snapdev::integer_to_chars(buf, buf + sizeof(buf), -1234));
+        CATCH_REQUIRE(std::string(buf, end) == "-1234");
+
+        end = snapdev::integer_to_chars(buf, buf + sizeof(buf), 0xCAFE, 16, true);
+        CATCH_REQUIRE(std::string(buf, end) == "CAFE");
+
+        end = snapdev::integer_to_chars(buf, buf + sizeof(buf), std::numeric_limits<int>::min(), 2);
+        CATCH_REQUIRE(end == buf + sizeof(buf));
+
+        char16_t buf16[10];
+        char16_t * end16(snapdev::integer_to_chars(buf16, buf16 + 10, 987));
+        CATCH_REQUIRE(std::u16string(buf16, end16) == u"987");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("integer_to_chars: buffer too small")
+    {
+        char buf[5] = { 'x', 'x', 'x', 'x', 'x' };
+        CATCH_REQUIRE(snapdev::integer_to_chars(buf, buf + 4, 12345) == nullptr);
+        CATCH_REQUIRE(snapdev::integer_to_chars(buf, buf + 4, -1234) == nullptr);
+        CATCH_REQUIRE(std::string(buf, 5) == "xxxxx");
+        CATCH_REQUIRE(snapdev::integer_to_chars(buf, buf + 5, -1234) == buf + 5);
+        CATCH_REQUIRE(std::string(buf, 5) == "-1234");
+    }
+    CATCH_END_SECTION()
+}
+
+
 
 // vim: ts=4 sw=4 et
@@ -0,0 +1,112 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the read_all_files() function.
+ *
+ * This file implements tests reading many files at once with various
+ * numbers of threads, including files which do not exist.
+ */
+
+// self
+//
+#include    <snapdev/read_all_files.h>
+
+#include    "catch_main.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+
+CATCH_TEST_CASE("read_all_files", "[os][thread]")
+{
+    CATCH_START_SECTION("read_all_files: no files")
+    {
+        CATCH_REQUIRE(snapdev::read_all_files(std::vector<std::string>()).empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("read_all_files: results are in input order with their own errors")
+    {
+        std::string const directory(SNAP_CATCH2_NAMESPACE::g_tmp_dir() + "/read-all-files");
+        std::vector<std::string> filenames;
+        std::vector<std::string> contents;
+        for(int i(0); i < 300; ++i)
+        {
+            std::string const filename(directory + "/file-" + std::to_string(i) + ".txt");
+            filenames.push_back(filename);
+            if(i % 7 == 3)
+            {
+                // missing file
+                //
+                contents.push_back(std::string());
+                continue;
+            }
+            contents.push_back("file #" + std::to_string(i) + "\n" + std::string(rand() % 2'000, 'x'));
+            snapdev::file_contents out(filename, true);
+            out.contents(contents.back());
+            CATCH_REQUIRE(out.write_all());
+        }
+
+        for(std::size_t const thread_count : { 0UL, 1UL, 3UL, 1'000UL })
+        {
+            std::vector<snapdev::file_contents> const files(snapdev::read_all_files(filenames, thread_count));
+            CATCH_REQUIRE(files.size() == filenames.size());
+            for(std::size_t i(0); i < files.size(); ++i)
+            {
+                CATCH_REQUIRE(files[i].filename() == filenames[i]);
+                if(i % 7 == 3)
+                {
+                    CATCH_REQUIRE(files[i].last_error() == "could not open file \"" + filenames[i] + "\" for reading.");
+                    CATCH_REQUIRE(files[i].contents().empty());
+                }
+                else
+                {
+                    CATCH_REQUIRE(files[i].last_error().empty());
+                    CATCH_REQUIRE(files[i].contents() == contents[i]);
+                }
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("read_all_files: size mode applies to all the files")
+    {
+        std::vector<std::string> const filenames{ "/proc/self/comm", "/proc/self/comm" };
+        std::vector<snapdev::file_contents> const files(snapdev::read_all_files(
+                  filenames
+                , 2
+                , snapdev::file_contents::size_mode_t::SIZE_MODE_READ));
+        CATCH_REQUIRE(files.size() == 2);
+        for(auto const & f : files)
+        {
+            CATCH_REQUIRE(f.size_mode() == snapdev::file_contents::size_mode_t::SIZE_MODE_READ);
+            CATCH_REQUIRE(f.last_error().empty());
+            CATCH_REQUIRE_FALSE(f.contents().empty());
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -26,6 +26,8 @@
 //
 #include    <snapdev/remove_duplicates.h>
 
+#include    <snapdev/case_insensitive_string.h>
+
 #include    "catch_main.h"
 
 
@@ -44,7 +46,35 @@ namespace
 {
 
 
+// a type without std::hash<> to verify the O(n^2) fallback
+//
+struct no_hash
+{
+    bool operator == (no_hash const & rhs) const
+    {
+        return f_value == rhs.f_value;
+    }
 
+    int         f_value = 0;
+};
+
+
+// generate numbers with many duplicates and the expected result
+//
+void generate_numbers(std::vector<int> & numbers, std::vector<int> & expected, std::size_t size, int range)
+{
+    std::vector<bool> found(range);
+    for(std::size_t idx(0); idx < size; ++idx)
+    {
+        int const n(rand() % range);
+        numbers.push_back(n);
+        if(!found[n])
+        {
+            found[n] = true;
+            expected.push_back(n);
+        }
+    }
+}
 
 
 }
@@ -362,4 +392,132 @@ CATCH_TEST_CASE("unsorted_remove_duplicates", "[remove_duplicates][container]")
 
 
 
+CATCH_TEST_CASE("hashed_remove_duplicates", "[remove_duplicates][container]")
+{
+    CATCH_START_SECTION("hashed_remove_duplicates: small and large inputs keep the first occurrence")
+    {
+        for(std::size_t size : { 0UL, 1UL, 5UL, snapdev::REMOVE_DUPLICATES_LINEAR_THRESHOLD - 1, snapdev::REMOVE_DUPLICATES_LINEAR_THRESHOLD, 1000UL, 100'000UL })
+        {
+            std::vector<int> numbers;
+            std::vector<int> expected;
+            generate_numbers(numbers, expected, size, static_cast<int>(size / 3 + 1));
+
+            if(size <= 1000)
+            {
+                std::vector<int> linear(numbers);
+                linear.erase(snapdev::remove_duplicates(linear.begin(), linear.end()), linear.end());
+                CATCH_REQUIRE(linear == expected);
+            }
+
+            std::vector<int> hashed(numbers);
+            hashed.erase(snapdev::hashed_remove_duplicates(hashed.begin(), hashed.end()), hashed.end());
+            CATCH_REQUIRE(hashed == expected);
+
+            std::list<int> list(numbers.begin(), numbers.end());
+            snapdev::unsorted_remove_duplicates(list);
+            CATCH_REQUIRE(std::vector<int>(list.begin(), list.end()) == expected);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hashed_remove_duplicates: custom hash")
+    {
+        std::vector<std::string> hostnames;
+        for(int i(0); i < 100; ++i)
+        {
+            hostnames.push_back("host" + std::to_string(i) + ".example.com");
+        }
+        std::vector<std::string> const expected(hostnames);
+        for(int i(0); i < 100; ++i)
+        {
+            hostnames.push_back("HOST" + std::to_string(i) + ".Example.COM");
+        }
+
+        std::vector<std::string> copy(hostnames);
+        snapdev::unsorted_remove_duplicates(copy);
+        CATCH_REQUIRE(copy == hostnames);
+
+        snapdev::unsorted_remove_duplicates(
+                  hostnames
+                , snapdev::case_insensitive_hash()
+                , snapdev::case_insensitive_equal());
+        CATCH_REQUIRE(hostnames == expected);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("hashed_remove_duplicates: type without std::hash")
+    {
+        std::vector<no_hash> values;
+        for(int i(0); i < 100; ++i)
+        {
+            values.push_back(no_hash{ i % 10 });
+        }
+        snapdev::unsorted_remove_duplicates(values);
+        CATCH_REQUIRE(values.size() == 10);
+        for(int i(0); i < 10; ++i)
+        {
+            CATCH_REQUIRE(values[i].f_value == i);
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("parallel_remove_duplicates", "[remove_duplicates][container]")
+{
+    CATCH_START_SECTION("parallel_remove_duplicates: compare with the sequential version")
+    {
+        for(std::size_t threads : { 0UL, 1UL, 2UL, 3UL, 8UL })
+        {
+            std::vector<int> numbers;
+            std::vector<int> expected;
+            generate_numbers(numbers, expected, 200'000, 50'000);
+
+            snapdev::parallel_unsorted_remove_duplicates(numbers, threads);
+            CATCH_REQUIRE(numbers == expected);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parallel_remove_duplicates: strings")
+    {
+        std::vector<std::string> values;
+        std::vector<std::string> expected;
+        for(int i(0); i < 100'000; ++i)
+        {
+            std::string const s("id-" + std::to_string(rand() % 30'000));
+            values.push_back(s);
+        }
+        expected = values;
+        snapdev::unsorted_remove_duplicates(expected);
+
+        snapdev::parallel_unsorted_remove_duplicates(values, 4);
+        CATCH_REQUIRE(values == expected);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parallel_remove_duplicates: exception in the hash function")
+    {
+        std::vector<int> numbers;
+        std::vector<int> expected;
+        generate_numbers(numbers, expected, 100'000, 10);
+        numbers[75'000] = 13;
+        auto bad_hash = [](int value)
+        {
+            if(value == 13)
+            {
+                throw std::runtime_error("bad hash");
+            }
+            return static_cast<std::size_t>(value);
+        };
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  snapdev::parallel_unsorted_remove_duplicates(numbers, 4, bad_hash)
+                , std::runtime_error
+                , Catch::Matchers::ExceptionMessage("bad hash"));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
 // vim: ts=4 sw=4 et
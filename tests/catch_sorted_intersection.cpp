@@ -0,0 +1,209 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the intersection functions of sorted ranges.
+ *
+ * This file implements tests comparing the sorted_intersection()
+ * functions against std::set_intersection() with balanced and skewed
+ * ranges of integers and strings.
+ */
+
+// self
+//
+#include    <snapdev/sorted_intersection.h>
+
+#include    <snapdev/empty_set_intersection.h>
+
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <span>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+template<typename T>
+std::vector<T> random_set(std::size_t size, std::uint64_t range)
+{
+    std::set<T> values;
+    while(values.size() < size)
+    {
+        values.insert(static_cast<T>(static_cast<std::uint64_t>(SNAP_CATCH2_NAMESPACE::rand_int64()) % range));
+    }
+    return std::vector<T>(values.begin(), values.end());
+}
+
+
+template<typename T>
+void verify_intersection(std::vector<T> const & lhs, std::vector<T> const & rhs)
+{
+    std::vector<T> expected;
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(expected));
+
+    std::vector<T> result;
+    snapdev::sorted_intersection(lhs, rhs, std::back_inserter(result));
+    CATCH_REQUIRE(result == expected);
+
+    CATCH_REQUIRE(snapdev::sorted_intersection_count(lhs, rhs) == expected.size());
+    CATCH_REQUIRE(snapdev::sorted_intersection_count(rhs, lhs) == expected.size());
+    CATCH_REQUIRE(snapdev::sorted_intersection_empty(lhs, rhs) == expected.empty());
+    CATCH_REQUIRE(snapdev::sorted_intersection_empty(rhs, lhs) == expected.empty());
+    CATCH_REQUIRE(snapdev::empty_set_intersection(lhs, rhs) == expected.empty());
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("sorted_intersection", "[set][container]")
+{
+    CATCH_START_SECTION("sorted_intersection: empty ranges")
+    {
+        std::vector<int> const empty;
+        std::vector<int> const one{ 1 };
+        verify_intersection(empty, empty);
+        verify_intersection(empty, one);
+        verify_intersection(one, one);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("sorted_intersection: balanced 32 bit integers (vectorized)")
+    {
+        for(int i(0); i < 100; ++i)
+        {
+            verify_intersection(
+                      random_set<std::uint32_t>(rand() % 500, 1000)
+                    , random_set<std::uint32_t>(rand() % 500, 1000));
+            verify_intersection(
+                      random_set<std::int32_t>(rand() % 500, 0x100000000ULL)
+                    , random_set<std::int32_t>(rand() % 500, 0x100000000ULL));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("sorted_intersection: skewed sizes (galloping)")
+    {
+        for(int i(0); i < 50; ++i)
+        {
+            std::vector<std::uint32_t> const large(random_set<std::uint32_t>(20'000, 100'000));
+            std::vector<std::uint32_t> const small(random_set<std::uint32_t>(rand() % 20 + 1, 100'000));
+            verify_intersection(small, large);
+
+            // the small set is a subset of the large set
+            //
+            std::vector<std::uint32_t> subset;
+            for(std::size_t idx(rand() % 1000); idx < large.size(); idx += rand() % 5000 + 1)
+            {
+                subset.push_back(large[idx]);
+            }
+            verify_intersection(subset, large);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("sorted_intersection: 64 bit integers and strings (merge)")
+    {
+        for(int i(0); i < 50; ++i)
+        {
+            verify_intersection(
+                      random_set<std::int64_t>(rand() % 300, 500)
+                    , random_set<std::int64_t>(rand() % 300, 500));
+        }
+
+        std::vector<std::string> const a{ "admin", "developer", "staff", "users" };
+        std::vector<std::string> const b{ "audio", "staff", "video" };
+        std::vector<std::string> const c{ "audio", "video" };
+        verify_intersection(a, b);
+        verify_intersection(a, c);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("sorted_intersection: spans and iterators")
+    {
+        std::vector<std::uint32_t> const lhs{ 1, 3, 5, 7, 9, 11, 13, 15, 17 };
+        std::uint32_t const rhs[] = { 2, 3, 4, 5, 6, 15, 16, 17 };
+
+        std::span<std::uint32_t const> const l(lhs);
+        std::span<std::uint32_t const> const r(rhs);
+        CATCH_REQUIRE(snapdev::sorted_intersection_count(l, r) == 4);
+        CATCH_REQUIRE_FALSE(snapdev::sorted_intersection_empty(l, r));
+
+        std::uint32_t out[4];
+        std::uint32_t * end(snapdev::sorted_intersection(lhs.begin(), lhs.end(), std::begin(rhs), std::end(rhs), out));
+        CATCH_REQUIRE(end == out + 4);
+        CATCH_REQUIRE(out[0] == 3);
+        CATCH_REQUIRE(out[1] == 5);
+        CATCH_REQUIRE(out[2] == 15);
+        CATCH_REQUIRE(out[3] == 17);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("sorted_intersection: custom comparator")
+    {
+        std::vector<std::uint32_t> const lhs{ 17, 15, 13, 11, 9, 7, 5, 3, 1 };
+        std::vector<std::uint32_t> const rhs{ 17, 16, 15, 6, 5, 4, 3, 2 };
+        std::vector<std::uint32_t> result;
+        snapdev::sorted_intersection(lhs, rhs, std::back_inserter(result), std::greater<std::uint32_t>());
+        CATCH_REQUIRE(result == std::vector<std::uint32_t>({ 17, 15, 5, 3 }));
+        CATCH_REQUIRE(snapdev::sorted_intersection_count(lhs, rhs, std::greater<>()) == 4);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("empty_set_intersection", "[set][container]")
+{
+    CATCH_START_SECTION("empty_set_intersection: std::set")
+    {
+        std::set<int> const a{ 1, 2, 3 };
+        std::set<int> const b{ 4, 5, 6 };
+        std::set<int> const c{ 3, 4 };
+        CATCH_REQUIRE(snapdev::empty_set_intersection(a, b));
+        CATCH_REQUIRE_FALSE(snapdev::empty_set_intersection(a, c));
+        CATCH_REQUIRE_FALSE(snapdev::empty_set_intersection(b, c));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("empty_set_intersection: sorted vectors")
+    {
+        std::vector<int> const a{ 1, 2, 3 };
+        std::vector<int> const b{ 4, 5, 6 };
+        std::vector<int> const c{ 3, 4 };
+        CATCH_REQUIRE(snapdev::empty_set_intersection(a, b));
+        CATCH_REQUIRE_FALSE(snapdev::empty_set_intersection(a, c));
+        CATCH_REQUIRE_FALSE(snapdev::empty_set_intersection(b, c));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,156 @@
+// Copyright (c) 2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/snapdev
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Verify the to_lower() and to_upper() functions.
+ *
+ * This file implements tests to verify that the vectorized versions of
+ * the to_lower() and to_upper() functions give the same results as a
+ * character by character conversion.
+ */
+
+// self
+//
+#include    <snapdev/to_lower.h>
+#include    <snapdev/to_upper.h>
+
+#include    "catch_main.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace
+{
+
+
+std::string slow_to_lower(std::string const & s)
+{
+    std::string result;
+    for(auto const c : s)
+    {
+        result += c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+    }
+    return result;
+}
+
+
+std::string slow_to_upper(std::string const & s)
+{
+    std::string result;
+    for(auto const c : s)
+    {
+        result += c >= 'a' && c <= 'z' ? static_cast<char>(c & ~0x20) : c;
+    }
+    return result;
+}
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("to_lower", "[string]")
+{
+    CATCH_START_SECTION("to_lower: all bytes")
+    {
+        std::string all;
+        for(int c(0); c < 256; ++c)
+        {
+            all += static_cast<char>(c);
+        }
+        CATCH_REQUIRE(snapdev::to_lower(all) == slow_to_lower(all));
+        CATCH_REQUIRE(snapdev::to_upper(all) == slow_to_upper(all));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("to_lower: strings of all sizes, all alignments")
+    {
+        for(std::size_t size(0); size < 100; ++size)
+        {
+            std::string const s(SNAP_CATCH2_NAMESPACE::random_bytes(size + 7));
+            for(std::size_t offset(0); offset < 7; ++offset)
+            {
+                std::string const sub(s.substr(offset, size));
+                std::string const expected(slow_to_lower(sub));
+                CATCH_REQUIRE(snapdev::to_lower(sub) == expected);
+
+                std::string in_place(sub);
+                CATCH_REQUIRE(&snapdev::to_lower_in_place(in_place) == &in_place);
+                CATCH_REQUIRE(in_place == expected);
+
+                char buffer[128];
+                CATCH_REQUIRE(snapdev::to_lower(sub.data(), sub.length(), buffer) == buffer + size);
+                CATCH_REQUIRE(std::string(buffer, size) == expected);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("to_lower: non-char strings use the generic version")
+    {
+        std::u32string s(U"HeLLo ÉTÉ World");
+        CATCH_REQUIRE(snapdev::to_lower(s) == U"hello ÉtÉ world");
+        snapdev::to_lower_in_place(s);
+        CATCH_REQUIRE(s == U"hello ÉtÉ world");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("to_upper", "[string]")
+{
+    CATCH_START_SECTION("to_upper: strings of all sizes, all alignments")
+    {
+        for(std::size_t size(0); size < 100; ++size)
+        {
+            std::string const s(SNAP_CATCH2_NAMESPACE::random_bytes(size + 7));
+            for(std::size_t offset(0); offset < 7; ++offset)
+            {
+                std::string const sub(s.substr(offset, size));
+                std::string const expected(slow_to_upper(sub));
+                CATCH_REQUIRE(snapdev::to_upper(sub) == expected);
+
+                std::string in_place(sub);
+                CATCH_REQUIRE(&snapdev::to_upper_in_place(in_place) == &in_place);
+                CATCH_REQUIRE(in_place == expected);
+
+                char buffer[128];
+                CATCH_REQUIRE(snapdev::to_upper(sub.data(), sub.length(), buffer) == buffer + size);
+                CATCH_REQUIRE(std::string(buffer, size) == expected);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("to_upper: non-char strings use the generic version")
+    {
+        std::u32string s(U"HeLLo été World");
+        CATCH_REQUIRE(snapdev::to_upper(s) == U"HELLO éTé WORLD");
+        snapdev::to_upper_in_place(s);
+        CATCH_REQUIRE(s == U"HELLO éTé WORLD");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et